@@ -0,0 +1,25 @@
+set(BENCHMARKFILES
+    ${CMAKE_CURRENT_LIST_DIR}/decoderBenchmark.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/filterBenchmark.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/captureBenchmark.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/simulatorBenchmark.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/pipelineBenchmark.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/allocationCounter.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/streamDecoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/commandWord.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/messageFilter.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/messageBatch.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/messageFormat.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/captureWriter.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/captureIndex.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/captureReader.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/parallelCaptureDecoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/device/simulatedBus.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/device/simulatedDevice.cpp)
+
+set(INCLUDEDIRS
+    ${CMAKE_CURRENT_LIST_DIR}
+    ${CMAKE_CURRENT_LIST_DIR}/../src/
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/
+    ${CMAKE_CURRENT_LIST_DIR}/../src/device/
+    ${CMAKE_CURRENT_LIST_DIR}/../deps/aim-driver/include/aim_mil_24.22)
@@ -0,0 +1,46 @@
+#include "allocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+
+/**
+ * @brief Counts one allocation and takes the memory from malloc.
+ */
+void *countedAllocate(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+/**
+ * @brief Counts one over-aligned allocation.
+ */
+void *countedAllocate(std::size_t size, std::align_val_t align) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  const std::size_t alignment = static_cast<std::size_t>(align);
+  // aligned_alloc needs the size to be a multiple of the alignment.
+  if (void *p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) return p;
+  throw std::bad_alloc();
+}
+} // namespace
+
+/**
+ * @brief Returns the number of allocations since the program started.
+ */
+uint64_t AllocationCounter::allocations() { return g_allocations.load(std::memory_order_relaxed); }
+
+void *operator new(std::size_t size) { return countedAllocate(size); }
+void *operator new[](std::size_t size) { return countedAllocate(size); }
+void *operator new(std::size_t size, std::align_val_t align) { return countedAllocate(size, align); }
+void *operator new[](std::size_t size, std::align_val_t align) { return countedAllocate(size, align); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
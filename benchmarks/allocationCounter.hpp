@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Counts heap allocations made anywhere in the benchmark binary.
+ *        allocationCounter.cpp replaces the global operator new, so a benchmark can report
+ *        allocations per message by reading the count before and after its timed loop.
+ */
+namespace AllocationCounter {
+uint64_t allocations();
+} // namespace AllocationCounter
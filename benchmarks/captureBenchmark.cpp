@@ -0,0 +1,77 @@
+#include "captureWriter.hpp"
+#include "parallelCaptureDecoder.hpp"
+#include "syntheticStream.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <thread>
+
+namespace {
+/**
+ * @brief Writes a synthetic dual-bus capture of about 1 GB once, in 16 KiB blocks, and returns its path.
+ */
+const std::string &capturePath() {
+  static const std::string path = [] {
+    const std::string file = "/tmp/captureBenchmark.bmc";
+    const auto words = SyntheticStream::generate(1000000);
+    CaptureWriter writer;
+    std::string error;
+    writer.open(file, CaptureFormat::FileHeader{}, error);
+    const size_t blockWords = 16 * 1024 / 4;
+    for (int copy = 0; copy < 12; ++copy) {
+      for (size_t pos = 0; pos < words.size(); pos += blockWords) {
+        const size_t count = std::min(blockWords, words.size() - pos);
+        // The writer drops blocks rather than wait for the disk; wait here so the file is complete.
+        while (!writer.append(&words[pos], static_cast<uint32_t>(count * 4), 0, 0, 0)) std::this_thread::yield();
+      }
+    }
+    writer.close();
+    return file;
+  }();
+  return path;
+}
+
+/**
+ * @brief Decodes the whole capture from the page cache with 1..N worker threads, keeping every message.
+ */
+void BM_ParallelCaptureDecode(benchmark::State &state) {
+  CaptureReader reader;
+  std::string error;
+  if (!reader.open(capturePath(), error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  ParallelCaptureDecoder::Options options;
+  options.threads = static_cast<unsigned>(state.range(0));
+  uint64_t bytes = 0, messages = 0;
+  for (auto _ : state) {
+    auto result = ParallelCaptureDecoder::decode(reader, options, [](const MessageTransaction &) { return true; },
+                                                 [](const MessageTransaction &t) { benchmark::DoNotOptimize(&t); });
+    bytes += result.bytes;
+    messages += result.messages;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+  state.counters["msgs/s"] = benchmark::Counter(static_cast<double>(messages), benchmark::Counter::kIsRate);
+}
+/**
+ * @brief Plans the parts of the whole capture: the serial step before any worker starts. The synthetic
+ *        stream writes the high timetag word only when it changes, about every 360000 messages.
+ */
+void BM_ParallelCapturePlan(benchmark::State &state) {
+  CaptureReader reader;
+  std::string error;
+  if (!reader.open(capturePath(), error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  size_t parts = 0;
+  for (auto _ : state) {
+    auto planned = ParallelCaptureDecoder::plan(ParallelCaptureDecoder::collectSpans(reader), ParallelCaptureDecoder::Options().partBytes);
+    parts = planned.size();
+    benchmark::DoNotOptimize(planned.data());
+  }
+  state.counters["parts"] = static_cast<double>(parts);
+}
+BENCHMARK(BM_ParallelCapturePlan)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ParallelCaptureDecode)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace
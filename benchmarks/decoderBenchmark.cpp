@@ -0,0 +1,31 @@
+#include "streamDecoder.hpp"
+#include "syntheticStream.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+
+namespace {
+constexpr size_t kChunkWords = 16 * 1024 / 4;
+
+/**
+ * @brief Decodes a 100%-loaded dual-bus stream in data-queue sized chunks.
+ */
+void BM_DecodeDualBusStream(benchmark::State &state) {
+  SyntheticStream::Mix mix;
+  mix.maxWordCount = static_cast<int>(state.range(0));
+  const auto words = SyntheticStream::generate(100000, mix);
+
+  Bm1553StreamDecoder decoder;
+  uint64_t messages = 0;
+  for (auto _ : state) {
+    decoder.reset();
+    for (size_t pos = 0; pos < words.size(); pos += kChunkWords) {
+      size_t count = std::min(kChunkWords, words.size() - pos);
+      decoder.feed(words.data() + pos, count, [&messages](const MessageTransaction &t) { benchmark::DoNotOptimize(&t); ++messages; });
+    }
+    if (decoder.flush()) ++messages;
+  }
+  state.counters["msgs/s"] = benchmark::Counter(static_cast<double>(messages), benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(words.size() * sizeof(AiUInt32)));
+}
+BENCHMARK(BM_DecodeDualBusStream)->Arg(4)->Arg(32);
+} // namespace
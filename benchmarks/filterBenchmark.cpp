@@ -0,0 +1,52 @@
+#include "messageFilter.hpp"
+#include "syntheticStream.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace {
+/**
+ * @brief Decodes a synthetic dual-bus stream once so the filter benchmarks measure filtering only.
+ */
+const std::vector<MessageTransaction> &decodedMessages() {
+  static const std::vector<MessageTransaction> messages = [] {
+    std::vector<MessageTransaction> out;
+    SyntheticStream::Mix mix;
+    mix.errorPerMille = 5;
+    const auto words = SyntheticStream::generate(100000, mix);
+    Bm1553StreamDecoder decoder;
+    decoder.feed(words.data(), words.size(), [&out](const MessageTransaction &t) { out.push_back(t); });
+    if (decoder.flush()) out.push_back(decoder.completed());
+    return out;
+  }();
+  return messages;
+}
+
+const char *const kExpressions[] = {
+    "bus=A rt=5 sa=3",
+    "bus=A rt=1 sa=1 || rt=2 sa=2 || rt=3 sa=3 || rt=4 dir=T || rt=5 sa=5-9 || bus=B rt=6 || rt=7 sa=1,3,5 || "
+    "rt=8 dir=R sa=10 || rt=9 sa=20-30 || bus=B rt=10-12",
+    "bus=A rt=1 sa=1 || rt=2 sa=2 || rt=3 sa=3 || rt=4 dir=T || rt=5 sa=5-9 || bus=B rt=6 || rt=7 sa=1,3,5 || "
+    "rt=8 dir=R sa=10 || rt=9 error || rt=10-12 data[0]&0xFF00=0x1200",
+};
+
+/**
+ * @brief Filters pre-decoded messages with 1 key-only clause, 10 key-only clauses, and 10 clauses of
+ *        which two need residual predicates.
+ */
+void BM_FilterAccept(benchmark::State &state) {
+  const auto &messages = decodedMessages();
+  MessageFilter filter;
+  std::string error;
+  if (!MessageFilter::compile(kExpressions[state.range(0)], filter, error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  uint64_t accepted = 0;
+  for (auto _ : state) {
+    for (const auto &trans : messages) accepted += filter.accepts(trans);
+  }
+  benchmark::DoNotOptimize(accepted);
+  state.counters["msgs/s"] = benchmark::Counter(static_cast<double>(state.iterations() * messages.size()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_FilterAccept)->Arg(0)->Arg(1)->Arg(2);
+} // namespace
@@ -0,0 +1,181 @@
+#include "activityBitmap.hpp"
+#include "allocationCounter.hpp"
+#include "busStatistics.hpp"
+#include "commandWord.hpp"
+#include "displayQueue.hpp"
+#include "messageFilter.hpp"
+#include "messageFormat.hpp"
+#include "syntheticStream.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr size_t kChunkWords = 16 * 1024 / 4;
+constexpr size_t kMessages = 20000;
+constexpr size_t kScreenRows = 40; // Rows the message list shows at once.
+
+/**
+ * @brief Message mixes: typical traffic, a transmit-heavy bus, and RT to RT transfers with many mode codes.
+ */
+SyntheticStream::Mix mixFor(int64_t index) {
+  SyntheticStream::Mix mix;
+  if (index == 1) { mix.bcToRtPercent = 5; mix.rtToBcPercent = 90; mix.rtToRtPercent = 0; }
+  if (index == 2) { mix.bcToRtPercent = 20; mix.rtToBcPercent = 20; mix.rtToRtPercent = 40; }
+  return mix;
+}
+const char *const kMixNames[] = {"typical", "transmit", "rtrt+modecodes"};
+
+// No filter, a key-only filter that rejects almost everything, and a wide filter with residual predicates.
+const char *const kFilters[] = {
+    "",
+    "bus=A rt=5 sa=3",
+    "rt=1-15 || rt=20 error || rt=21-30 data[0]&0xFF00=0x1200",
+};
+
+/**
+ * @brief The BM decode thread without the card: decodes data-queue sized chunks, counts each message in
+ *        the bus statistics, filters it, marks its Bus/RT/SA active and hands full batches to the display
+ *        queue, as BM::processAndRelayData and BM::acceptTransaction do. The UI side drains the queue and,
+ *        if asked, renders one screen of the newest rows, as the virtual message list does each UI frame.
+ */
+class MonitorPipeline {
+public:
+  MonitorPipeline(const MessageFilter &filter, bool format)
+      : m_filter(filter), m_format(format), m_pool(MessageBatchPool::create(1024, 64)), m_displayQueue(32),
+        m_pending(m_pool->acquire()) {}
+
+  /**
+   * @brief Runs one chunk through decoding and filtering, then lets the "UI" take what was queued.
+   */
+  void processChunk(const AiUInt32 *words, size_t count) {
+    m_decoder.feed(words, count, [this](const MessageTransaction &trans) { collect(trans); });
+    relayPendingBatch();
+    drainDisplayQueue();
+  }
+
+  /**
+   * @brief Flushes the message still in the decoder, as BM does when the stream goes idle.
+   */
+  void flush() {
+    if (m_decoder.flush()) collect(m_decoder.completed());
+    relayPendingBatch();
+    drainDisplayQueue();
+  }
+
+  void reset() { m_decoder.reset(); }
+  uint64_t decoded() const { return m_decoded; }
+  uint64_t displayed() const { return m_displayed; }
+  uint64_t rendered() const { return m_rendered; }
+
+private:
+  /**
+   * @brief Counts and filters a decoded message and adds it to the pending batch.
+   */
+  void collect(const MessageTransaction &trans) {
+    ++m_decoded;
+    m_statistics.record(trans);
+    if (!trans.cmd1Valid()) return;
+    const CommandWordDescriptor &cmd = describeCommandWord(trans.header.cmd1);
+    if (!m_filter.accepts(trans)) return;
+    if (!cmd.isModeCode()) m_activity.mark(trans.has(MSG_CMD1_BUS_B) ? 1 : 0, cmd.rt(), cmd.sa());
+    if (!m_pending.push(trans)) { relayPendingBatch(); m_pending.push(trans); }
+  }
+
+  void relayPendingBatch() {
+    if (m_pending.empty()) return;
+    m_displayQueue.push(std::move(m_pending));
+    m_pending = m_pool->acquire();
+  }
+
+  /**
+   * @brief Takes the queued batches like the UI frame timer, returning their storage to the pool.
+   *        Each drain stands for one UI frame.
+   */
+  void drainDisplayQueue() {
+    m_displayQueue.drain(m_batches);
+    for (const MessageBatch &batch : m_batches) m_displayed += batch.size();
+    if (m_format) renderScreen();
+    m_batches.clear();
+    ActivityBitmap::Snapshot snapshot;
+    m_activity.take(snapshot);
+  }
+
+  /**
+   * @brief Formats every cell of the newest kScreenRows messages, as the list scrolled to the end
+   *        asks for after new rows were appended (MessageListCtrl::OnGetItemText).
+   */
+  void renderScreen() {
+    size_t rows = 0;
+    for (auto batch = m_batches.rbegin(); batch != m_batches.rend() && rows < kScreenRows; ++batch) {
+      for (size_t i = batch->size(); i-- > 0 && rows < kScreenRows; ++rows) {
+        for (int column = 0; column < MessageFormat::COL_COUNT; ++column) {
+          std::string cell = MessageFormat::formatColumn((*batch)[i], static_cast<MessageFormat::Column>(column));
+          benchmark::DoNotOptimize(cell.data());
+        }
+      }
+    }
+    m_rendered += rows;
+  }
+
+  const MessageFilter &m_filter;
+  const bool m_format;
+  Bm1553StreamDecoder m_decoder;
+  ActivityBitmap m_activity;
+  BusStatistics m_statistics;
+  std::shared_ptr<MessageBatchPool> m_pool;
+  DisplayQueue m_displayQueue;
+  MessageBatch m_pending;
+  std::vector<MessageBatch> m_batches;
+  uint64_t m_decoded = 0;
+  uint64_t m_displayed = 0;
+  uint64_t m_rendered = 0;
+};
+
+/**
+ * @brief Runs the monitor path over a synthetic dual-bus stream.
+ *        Args: message mix, maximum word count, errors per mille, filter, render a screen of rows per UI frame (0/1).
+ *        Reports time and allocations per decoded message; the first pass is not timed so pools are warm.
+ */
+void BM_MonitorPipeline(benchmark::State &state) {
+  SyntheticStream::Mix mix = mixFor(state.range(0));
+  mix.maxWordCount = static_cast<int>(state.range(1));
+  mix.errorPerMille = static_cast<int>(state.range(2));
+  const auto words = SyntheticStream::generate(kMessages, mix);
+
+  MessageFilter filter;
+  std::string error;
+  const char *expression = kFilters[state.range(3)];
+  if (*expression && !MessageFilter::compile(expression, filter, error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  MonitorPipeline pipeline(filter, state.range(4) != 0);
+  auto runStream = [&] {
+    pipeline.reset();
+    for (size_t pos = 0; pos < words.size(); pos += kChunkWords) {
+      pipeline.processChunk(words.data() + pos, std::min(kChunkWords, words.size() - pos));
+    }
+    pipeline.flush();
+  };
+  runStream();
+
+  const uint64_t decodedBefore = pipeline.decoded(), displayedBefore = pipeline.displayed(), renderedBefore = pipeline.rendered();
+  const uint64_t allocationsBefore = AllocationCounter::allocations();
+  for (auto _ : state) runStream();
+  const double allocations = static_cast<double>(AllocationCounter::allocations() - allocationsBefore);
+  const double messages = static_cast<double>(pipeline.decoded() - decodedBefore);
+
+  state.SetLabel(std::string(kMixNames[state.range(0)]) + (*expression ? " filtered" : "") + (state.range(4) ? " formatted" : ""));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(words.size() * sizeof(AiUInt32)));
+  state.counters["time/msg"] = benchmark::Counter(messages, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["allocs/msg"] = messages > 0 ? allocations / messages : 0;
+  state.counters["shown%"] = messages > 0 ? 100.0 * static_cast<double>(pipeline.displayed() - displayedBefore) / messages : 0;
+  if (state.range(4)) state.counters["rows"] = static_cast<double>(pipeline.rendered() - renderedBefore) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_MonitorPipeline)->ArgNames({"mix", "wc", "err", "filter", "fmt"})
+    ->ArgsProduct({{0, 1, 2}, {4, 32}, {0, 20}, {0, 1, 2}, {0}});
+BENCHMARK(BM_MonitorPipeline)->ArgNames({"mix", "wc", "err", "filter", "fmt"})
+    ->ArgsProduct({{0, 1, 2}, {32}, {5}, {0}, {1}});
+} // namespace
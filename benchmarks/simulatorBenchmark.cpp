@@ -0,0 +1,42 @@
+#include "simulatedDevice.hpp"
+#include "streamDecoder.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace {
+/**
+ * @brief Drains the data queue of a free-running simulated board on a fully loaded bus and decodes it,
+ *        the path the BM polling loop takes when running on the simulator backend.
+ */
+void BM_SimulatedMonitorDrain(benchmark::State &state) {
+  SimulatorConfig config;
+  config.realTime = false;
+  config.fillPercent = 100;
+  config.fillErrorPerMille = static_cast<int>(state.range(0));
+  SimulatedDevice device(config);
+  AiUInt32 size = 0;
+  if (device.open(31, 1) != API_OK || device.bmIni(1) != API_OK ||
+      device.dataQueueOpen(API_DATA_QUEUE_ID_BM_REC_BIU1, &size) != API_OK ||
+      device.dataQueueControl(API_DATA_QUEUE_ID_BM_REC_BIU1, API_DATA_QUEUE_CTRL_MODE_START) != API_OK ||
+      device.bmStart(1) != API_OK) {
+    state.SkipWithError("cannot start the simulated monitor");
+    return;
+  }
+  std::vector<AiUInt32> words(64 * 1024 / 4);
+  Bm1553StreamDecoder decoder;
+  uint64_t bytes = 0, messages = 0;
+  for (auto _ : state) {
+    TY_API_DATA_QUEUE_READ read{API_DATA_QUEUE_ID_BM_REC_BIU1, words.data(), static_cast<AiUInt32>(words.size() * 4)};
+    TY_API_DATA_QUEUE_STATUS status{};
+    device.dataQueueRead(&read, &status);
+    decoder.feed(words.data(), status.bytes_transfered / 4, [&](const MessageTransaction &t) {
+      benchmark::DoNotOptimize(&t);
+      ++messages;
+    });
+    bytes += status.bytes_transfered;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+  state.counters["msgs/s"] = benchmark::Counter(static_cast<double>(messages), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SimulatedMonitorDrain)->Arg(0)->Arg(50);
+} // namespace
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "monitorWords.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Builds synthetic AIM BM monitor-word streams for benchmarking.
+ *        Messages are laid out back to back on both buses, i.e. the stream represents
+ *        100% utilization of bus A and bus B at the same time.
+ */
+namespace SyntheticStream {
+
+struct Mix {
+  int bcToRtPercent = 45;
+  int rtToBcPercent = 40;
+  int rtToRtPercent = 10; // Remainder are mode codes.
+  int maxWordCount = 32;
+  int errorPerMille = 0;
+};
+
+using MonitorWords::busWord;
+using MonitorWords::commandWord;
+using MonitorWords::timetagHighWord;
+using MonitorWords::timetagLowWord;
+
+/**
+ * @brief Generates a dual-bus stream with the requested message mix.
+ * @param messageCount Number of messages to generate (split evenly over both buses).
+ * @param mix Message type distribution, word counts and error density.
+ * @param seed Seed for the deterministic pseudo random generator.
+ * @return The raw monitor words, ready to feed to a decoder.
+ */
+inline std::vector<AiUInt32> generate(size_t messageCount, const Mix &mix = Mix(), unsigned seed = 1553) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> percent(0, 99), perMille(0, 999), rtDist(0, 30), saDist(1, 30), wcDist(1, mix.maxWordCount), dataDist(0, 0xFFFF);
+  std::vector<AiUInt32> words;
+  words.reserve(messageCount * (mix.maxWordCount / 2 + 6));
+
+  uint64_t tt = 0;
+  AiUInt32 lastHigh = 0xFFFFFFFF;
+  for (size_t i = 0; i < messageCount; ++i) {
+    char bus = (i % 2 == 0) ? 'A' : 'B';
+    int kind = percent(rng);
+    int rt = rtDist(rng), sa = saDist(rng), wc = wcDist(rng);
+    int dataWords = wc;
+
+    AiUInt32 high = timetagHighWord(tt);
+    if (high != lastHigh) { words.push_back(high); lastHigh = high; }
+    words.push_back(timetagLowWord(tt));
+
+    if (kind < mix.bcToRtPercent) {
+      words.push_back(busWord(bus, 0x0, commandWord(rt, 0, sa, wc)));
+      for (int d = 0; d < dataWords; ++d) words.push_back(busWord(bus, 0x2, static_cast<AiUInt16>(dataDist(rng))));
+      words.push_back(busWord(bus, 0x3, static_cast<AiUInt16>(rt << 11)));
+    } else if (kind < mix.bcToRtPercent + mix.rtToBcPercent) {
+      words.push_back(busWord(bus, 0x0, commandWord(rt, 1, sa, wc)));
+      words.push_back(busWord(bus, 0x3, static_cast<AiUInt16>(rt << 11)));
+      for (int d = 0; d < dataWords; ++d) words.push_back(busWord(bus, 0x2, static_cast<AiUInt16>(dataDist(rng))));
+    } else if (kind < mix.bcToRtPercent + mix.rtToBcPercent + mix.rtToRtPercent) {
+      int rt2 = (rt + 1) % 31;
+      words.push_back(busWord(bus, 0x0, commandWord(rt2, 0, sa, wc)));
+      words.push_back(busWord(bus, 0x1, commandWord(rt, 1, sa, wc)));
+      words.push_back(busWord(bus, 0x3, static_cast<AiUInt16>(rt << 11)));
+      for (int d = 0; d < dataWords; ++d) words.push_back(busWord(bus, 0x2, static_cast<AiUInt16>(dataDist(rng))));
+      words.push_back(busWord(bus, 0x3, static_cast<AiUInt16>(rt2 << 11)));
+    } else {
+      dataWords = 0;
+      words.push_back(busWord(bus, 0x0, commandWord(rt, 1, 0, 2)));
+      words.push_back(busWord(bus, 0x3, static_cast<AiUInt16>(rt << 11)));
+    }
+    if (mix.errorPerMille > 0 && perMille(rng) < mix.errorPerMille) {
+      words.push_back(MonitorWords::errorWord(0x0040));
+    }
+
+    // One word is 20 us on the wire; add response time and the minimum inter-message gap.
+    // Both buses run concurrently, so each bus contributes half of the elapsed time.
+    tt += static_cast<uint64_t>((dataWords + 2) * 20 + 12) / 2;
+  }
+  return words;
+}
+
+} // namespace SyntheticStream
@@ -0,0 +1,26 @@
+# Initialization
+cd `dirname $0`
+SCRIPTDIR=`pwd`
+cd -
+
+mkdir -p $SCRIPTDIR/../build/benchmarks/
+
+# Configure Project
+cmake \
+-DCMAKE_BUILD_TYPE:STRING=Release \
+-DCMAKE_CC_COMPILER:FILEPATH=/usr/bin/gcc \
+-DCMAKE_CXX_COMPILER:FILEPATH=/usr/bin/g++ \
+-S$SCRIPTDIR/../benchmarks/  \
+-B$SCRIPTDIR/../build/benchmarks/ \
+-G "Unix Makefiles"
+
+# Build
+cmake \
+--build $SCRIPTDIR/../build/benchmarks/ \
+--config Release \
+--target all \
+-j$((`nproc`+2)) --
+
+# Run benchmarks
+cd $SCRIPTDIR/../bin/
+./benchmarks "$@"
@@ -4,5 +4,10 @@ set(SOURCEFILES
     ${CMAKE_CURRENT_LIST_DIR}/ui/frameComponent.cpp
     ${CMAKE_CURRENT_LIST_DIR}/app.cpp
     ${CMAKE_CURRENT_LIST_DIR}/bc.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/bcBackend.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/aimDevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/hardwareDevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/simulatedBus.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/simulatedDevice.cpp
     ${CMAKE_CURRENT_LIST_DIR}/../logger.cpp
 )
\ No newline at end of file
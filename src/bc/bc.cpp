@@ -1,6 +1,5 @@
 // fileName: bc.cpp
 #include "bc.hpp"
-#include "frameComponent.hpp" 
 #include <cstring>
 #include <stdexcept>
 #include <thread>
@@ -16,45 +15,38 @@ BusController::~BusController() {
     shutdown();
 }
 
-AiReturn BusController::initialize(int deviceId, int streamId) {
+/**
+ * @brief Opens the given device and puts it in BC mode. The device is only used if the BC is not initialized yet.
+ */
+AiReturn BusController::initialize(std::unique_ptr<AimDevice> device, int deviceId, int streamId) {
     std::lock_guard<std::mutex> lock(m_apiMutex);
     if (m_isInitialized) {
         std::cout << "[BC] Zaten başlatılmış." << std::endl;
         return API_OK;
     }
+    if (!device) return API_ERR;
     std::cout << "[BC] Başlatılıyor... Cihaz ID: " << deviceId << std::endl;
     m_deviceId = deviceId;
     m_streamId = streamId;
 
-    if (ApiInit() < 1) {
-        std::cerr << "[BC] HATA: ApiInit başarısız, kart bulunamadı." << std::endl;
-        return API_ERR;
-    }
-    std::cout << "[BC] ApiInit başarılı." << std::endl;
-
-    TY_API_OPEN api_open_params;
-    memset(&api_open_params, 0, sizeof(api_open_params));
-    api_open_params.ul_Module = m_deviceId;
-    api_open_params.ul_Stream = m_streamId;
-    strncpy(api_open_params.ac_SrvName, "local", sizeof(api_open_params.ac_SrvName) - 1);
-    
-    AiReturn ret = ApiOpenEx(&api_open_params, &m_boardHandle);
-    if (ret != API_OK) { std::cerr << "[BC] HATA: ApiOpenEx başarısız." << std::endl; return ret; }
-    std::cout << "[BC] ApiOpenEx başarılı. Handle: " << m_boardHandle << std::endl;
+    m_device = std::move(device);
+    AiReturn ret = m_device->open(m_deviceId, m_streamId);
+    if (ret != API_OK) { std::cerr << "[BC] HATA: Cihaz açılamadı (" << m_device->backendName() << ")." << std::endl; m_device.reset(); return ret; }
+    std::cout << "[BC] Cihaz açıldı: " << m_device->backendName() << std::endl;
     
     TY_API_RESET_INFO reset_info;
     memset(&reset_info, 0, sizeof(reset_info));
-    ret = ApiCmdReset(m_boardHandle, m_biuId, API_RESET_ALL, &reset_info);
-    if (ret != API_OK) { std::cerr << "[BC] HATA: ApiCmdReset başarısız." << std::endl; return ret; }
+    ret = m_device->reset(m_biuId, API_RESET_ALL, &reset_info);
+    if (ret != API_OK) { std::cerr << "[BC] HATA: ApiCmdReset başarısız." << std::endl; m_device.reset(); return ret; }
     std::cout << "[BC] ApiCmdReset başarılı." << std::endl;
 
-    ret = ApiCmdCalCplCon(m_boardHandle, m_biuId, API_CAL_BUS_PRIMARY, API_CAL_CPL_TRANSFORM);
+    ret = m_device->calCplCon(m_biuId, API_CAL_BUS_PRIMARY, API_CAL_CPL_TRANSFORM);
     if (ret != API_OK) return ret;
-    ret = ApiCmdCalCplCon(m_boardHandle, m_biuId, API_CAL_BUS_SECONDARY, API_CAL_CPL_TRANSFORM);
+    ret = m_device->calCplCon(m_biuId, API_CAL_BUS_SECONDARY, API_CAL_CPL_TRANSFORM);
     if (ret != API_OK) return ret;
     std::cout << "[BC] Donanım kuplajı ayarlandı." << std::endl;
 
-    ret = ApiCmdBCIni(m_boardHandle, m_biuId, API_DIS, API_ENA, API_TBM_TRANSFER, API_BC_XFER_BUS_PRIMARY);
+    ret = m_device->bcIni(m_biuId, API_DIS, API_ENA, API_TBM_TRANSFER, API_BC_XFER_BUS_PRIMARY);
     if (ret != API_OK) return ret;
     std::cout << "[BC] BC modu başlatıldı." << std::endl;
 
@@ -66,45 +58,67 @@ void BusController::shutdown() {
     std::lock_guard<std::mutex> lock(m_apiMutex);
     if (!m_isInitialized) return;
     std::cout << "[BC] Kapatılıyor..." << std::endl;
-    if (m_boardHandle != 0) {
-        ApiCmdBCHalt(m_boardHandle, m_biuId);
-        ApiClose(m_boardHandle);
-        m_boardHandle = 0;
+    if (m_device) {
+        m_device->bcHalt(m_biuId);
+        m_device.reset();
     }
-    ApiExit();
+    m_scheduleRunning = false;
+    m_insertTransfers.clear();
+    m_sendPending = false;
     m_isInitialized = false;
 }
 
 bool BusController::isInitialized() const { return m_isInitialized; }
-const char* BusController::getAIMError(AiReturn ret) { return ApiGetErrorMessage(ret); }
 
-AiReturn BusController::defineFrameResources(FrameComponent* frame) {
+/**
+ * @brief Allocates and defines the transfer that sends a frame.
+ * @param ids Receives the ids the frame is sent with; the caller keeps them with the frame.
+ */
+AiReturn BusController::defineFrameResources(const FrameConfig& config, TransferIds& ids) {
     std::lock_guard<std::mutex> lock(m_apiMutex);
     // DÜZELTME: Tanımlı olmayan hata kodu API_ERR ile değiştirildi.
-    if (!frame) return API_ERR; 
-    if (frame->getAimTransferId() != 0) {
-        std::cout << "[BC::define] '" << frame->getFrameConfig().label << "' için kaynaklar zaten tanımlı." << std::endl;
-        return API_OK;
-    }
-    const FrameConfig& config = frame->getFrameConfig();
+    if (!m_isInitialized) return API_ERR;
     std::cout << "[BC::define] '" << config.label << "' için yeni kaynaklar tanımlanıyor..." << std::endl;
     
-    AiUInt16 xferId = m_nextTransferId++;
-    AiUInt16 hdrId = m_nextHeaderId++;
-    AiUInt16 bufId = m_nextBufferId++;
-    
-    frame->setAimIds(xferId, hdrId, bufId);
-    std::cout << "[BC::define] Atanan ID'ler -> XFER: " << xferId << ", HDR: " << hdrId << ", BUF: " << bufId << std::endl;
-    
+    ids = allocateTransferIds();
+    std::cout << "[BC::define] Atanan ID'ler -> XFER: " << ids.transferId << ", HDR: " << ids.headerId << ", BUF: " << ids.bufferId << std::endl;
+    AiReturn ret = defineTransfer(config, ids);
+    std::cout << "[BC::define] Kaynak tanımlama sonucu: " << ret << std::endl;
+    return ret;
+}
+
+/**
+ * @brief Forgets the insert transfer of a frame that was removed or edited (see insertTransferFor()).
+ */
+void BusController::releaseFrameResources(AiUInt16 transferId) {
+    std::lock_guard<std::mutex> lock(m_apiMutex);
+    m_insertTransfers.erase(transferId);
+}
+
+/**
+ * @brief Reserves the next free transfer, buffer header and buffer ids.
+ */
+BusController::TransferIds BusController::allocateTransferIds() {
+    TransferIds ids;
+    ids.transferId = static_cast<AiUInt16>(m_nextTransferId++);
+    ids.headerId = static_cast<AiUInt16>(m_nextHeaderId++);
+    ids.bufferId = static_cast<AiUInt16>(m_nextBufferId++);
+    return ids;
+}
+
+/**
+ * @brief Defines the buffer header and transfer descriptor that send a frame. The caller holds m_apiMutex.
+ */
+AiReturn BusController::defineTransfer(const FrameConfig& config, const TransferIds& ids) {
     TY_API_BC_BH_INFO bh_info;
     memset(&bh_info, 0, sizeof(bh_info));
-    AiReturn ret = ApiCmdBCBHDef(m_boardHandle, m_biuId, hdrId, bufId, 0, 0, API_QUEUE_SIZE_1, API_BQM_CYCLIC, 0, 0, 0, 0, &bh_info);
+    AiReturn ret = m_device->bcBHDef(m_biuId, ids.headerId, ids.bufferId, 0, 0, API_QUEUE_SIZE_1, API_BQM_CYCLIC, 0, 0, 0, 0, &bh_info);
     if (ret != API_OK) return ret;
 
     TY_API_BC_XFER xfer;
     memset(&xfer, 0, sizeof(xfer));
-    xfer.xid = xferId;
-    xfer.hid = hdrId;
+    xfer.xid = ids.transferId;
+    xfer.hid = ids.headerId;
     xfer.chn = (config.bus == 'A') ? API_BC_XFER_BUS_PRIMARY : API_BC_XFER_BUS_SECONDARY;
     xfer.tic = API_BC_TIC_NO_INT;
     xfer.hlt = API_BC_HLT_NO_HALT;
@@ -118,73 +132,324 @@ AiReturn BusController::defineFrameResources(FrameComponent* frame) {
     }
     
     AiUInt32 desc_addr;
-    ret = ApiCmdBCXferDef(m_boardHandle, m_biuId, &xfer, &desc_addr);
-    std::cout << "[BC::define] Kaynak tanımlama sonucu: " << ret << std::endl;
-    return ret;
+    return m_device->bcXferDef(m_biuId, &xfer, &desc_addr);
+}
+
+/**
+ * @brief Returns the transfer a frame is inserted into a running schedule with, defining it on first use.
+ *        It is a copy of the frame's own transfer with its own header and buffer: the frame may be in the
+ *        schedule too, and the completion count, status and data of an insert must not be the cyclic run's.
+ *        Frames get new transfer ids when edited, so a copy never goes stale; releaseFrameResources() drops it
+ *        once the frame is removed. The caller holds m_apiMutex.
+ */
+AiReturn BusController::insertTransferFor(const ScheduledFrame& frame, TransferIds& ids) {
+    const auto found = m_insertTransfers.find(frame.ids.transferId);
+    if (found != m_insertTransfers.end()) { ids = found->second; return API_OK; }
+    ids = allocateTransferIds();
+    AiReturn ret = defineTransfer(frame.config, ids);
+    if (ret != API_OK) return ret;
+    m_insertTransfers[frame.ids.transferId] = ids;
+    return API_OK;
 }
 
-AiReturn BusController::sendAcyclicFrame(const FrameComponent* frame, std::array<AiUInt16, BC_MAX_DATA_WORDS>& receivedData) {
+/**
+ * @brief Sends a frame once. While a schedule runs, the frame is inserted into it as an acyclic frame
+ *        (see insertAcyclicFrame()) and the schedule keeps running; otherwise a one-shot BC program sends it.
+ *        Returns as soon as the card accepted the send, without waiting for the transfer; the caller must then
+ *        call finishAcyclicFrame() with pending, off the UI thread. One send is pending at a time.
+ * @param pending Receives what finishAcyclicFrame() needs.
+ */
+AiReturn BusController::sendAcyclicFrame(const ScheduledFrame& frame, PendingSend& pending) {
+    const auto started = std::chrono::steady_clock::now();
     std::lock_guard<std::mutex> lock(m_apiMutex);
-    if (!m_isInitialized || !frame) return API_ERR;
-    if (frame->getAimTransferId() == 0) {
+    if (!m_isInitialized) return API_ERR;
+    if (frame.ids.transferId == 0) {
         std::cerr << "[BC::send] HATA: Çerçeve kaynakları tanımlanmamış!" << std::endl;
         // DÜZELTME: Tanımlı olmayan hata kodu API_ERR ile değiştirildi.
         return API_ERR; 
     }
+    if (m_sendPending) {
+        std::cerr << "[BC::send] HATA: Önceki gönderim henüz tamamlanmadı." << std::endl;
+        return API_ERR;
+    }
 
-    const FrameConfig& config = frame->getFrameConfig();
-    const AiUInt16 transferId = frame->getAimTransferId();
-    const AiUInt16 headerId = frame->getAimHeaderId();
-    const AiUInt16 bufferId = frame->getAimBufferId();
-    std::cout << "[BC::send] '"<< config.label <<"' gönderiliyor. Kullanılan ID'ler -> XFER: " << transferId << ", HDR: " << headerId << ", BUF: " << bufferId << std::endl;
-
-    AiReturn ret;
-    bool hasDataField = (config.mode == BcMode::BC_TO_RT || config.mode == BcMode::RT_TO_RT || config.mode == BcMode::MODE_CODE_WITH_DATA);
-    int wc_to_process = (config.wc == 0 && config.mode != BcMode::MODE_CODE_NO_DATA) ? 32 : config.wc;
-    if (config.mode == BcMode::MODE_CODE_WITH_DATA) wc_to_process = 1;
+    const FrameConfig& config = frame.config;
+    const bool inserted = m_scheduleRunning;
+    TransferIds ids = frame.ids;
+    if (inserted) {
+        AiReturn ret = insertTransferFor(frame, ids);
+        if (ret != API_OK) { std::cerr << "[BC::send] HATA: Ekleme transferi tanımlanamadı." << std::endl; return ret; }
+    }
+    const AiUInt16 transferId = ids.transferId;
+    TY_API_BC_XFER_DSP transferStatus;
+    memset(&transferStatus, 0, sizeof(transferStatus));
+    AiReturn ret = m_device->bcXferRead(m_biuId, transferId, API_DONT_MODIFY_STATUS_BITS, &transferStatus);
+    if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCXferRead başarısız." << std::endl; return ret; }
 
-    if (hasDataField && wc_to_process > 0) {
-        std::array<AiUInt16, BC_MAX_DATA_WORDS> dataWords;
-        for (int i = 0; i < wc_to_process; ++i) {
-            try { dataWords[i] = static_cast<AiUInt16>(std::stoul(config.data[i], nullptr, 16)); } catch(...) { dataWords[i] = 0; }
-        }
-        AiUInt16 outIndex; AiUInt32 outAddr;
-        ret = ApiCmdBufDef(m_boardHandle, m_biuId, API_BUF_BC_MSG, headerId, bufferId, wc_to_process, dataWords.data(), &outIndex, &outAddr);
+    if (inserted) {
+        ret = insertAcyclicFrame(config, ids);
+        if (ret != API_OK) return ret;
+    } else {
+        std::cout << "[BC::send] '"<< config.label <<"' gönderiliyor. Kullanılan ID'ler -> XFER: " << transferId << ", HDR: " << ids.headerId << ", BUF: " << ids.bufferId << std::endl;
+        ret = writeTransmitData(config, ids);
         if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBufDef başarısız." << std::endl; return ret; }
+
+        TY_API_BC_FRAME temp_minor_frame;
+        memset(&temp_minor_frame, 0, sizeof(temp_minor_frame));
+        temp_minor_frame.id = ONE_SHOT_MINOR_FRAME_ID;
+        temp_minor_frame.cnt = 1;
+        temp_minor_frame.instr[0] = API_BC_INSTR_TRANSFER;
+        temp_minor_frame.xid[0] = transferId;
+        ret = m_device->bcFrameDef(m_biuId, &temp_minor_frame);
+        if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCFrameDef başarısız." << std::endl; return ret; }
+        
+        TY_API_BC_MFRAME_EX temp_major_frame;
+        memset(&temp_major_frame, 0, sizeof(temp_major_frame));
+        temp_major_frame.cnt = 1;
+        temp_major_frame.fid[0] = temp_minor_frame.id;
+        ret = m_device->bcMFrameDefEx(m_biuId, &temp_major_frame);
+        if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCMFrameDefEx başarısız." << std::endl; return ret; }
+        
+        AiUInt32 major_addr, minor_addr[64];
+        ret = m_device->bcStart(m_biuId, API_BC_START_IMMEDIATELY, 1, 10.0f, 0, &major_addr, minor_addr);
+        if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCStart başarısız." << std::endl; return ret; }
+    }
+
+    pending.frame = frame;
+    pending.ids = ids;
+    pending.inserted = inserted;
+    pending.sentBefore = transferStatus.msg_cnt + transferStatus.err_cnt;
+    pending.errorsBefore = transferStatus.err_cnt;
+    pending.started = started;
+    m_sendPending = true;
+    return API_OK;
+}
+
+/**
+ * @brief Waits until the card reports the transfer of a send done (see waitForTransfer()), then reads the data
+ *        of RT to BC and RT to RT frames. An insert waits up to two minor frames, as it goes out at the end of
+ *        the current one; a one-shot program up to one. Must follow every successful sendAcyclicFrame().
+ * @param receivedData Receives the data of RT to BC and RT to RT frames.
+ * @param report If given, receives the transfer status and the round-trip time of the send.
+ */
+AiReturn BusController::finishAcyclicFrame(const PendingSend& pending, std::array<AiUInt16, BC_MAX_DATA_WORDS>& receivedData,
+                                           SendReport* report) {
+    std::unique_lock<std::mutex> lock(m_apiMutex);
+    if (!m_sendPending) return API_ERR;
+    // The next send is refused until this one is done; waitForTransfer() holds m_apiMutex again when it returns.
+    struct ClearPending { bool& pending; ~ClearPending() { pending = false; } } clearPending{m_sendPending};
+    if (!m_isInitialized) return API_ERR;
+
+    const FrameConfig& config = pending.frame.config;
+    TY_API_BC_XFER_DSP transferStatus;
+    memset(&transferStatus, 0, sizeof(transferStatus));
+    const auto timeout = std::chrono::milliseconds((pending.inserted ? 2 : 1) * BC_FRAME_TIME_MS);
+    AiReturn ret = waitForTransfer(lock, pending, timeout, transferStatus);
+    if (ret != API_OK) {
+        std::cerr << "[BC::send] HATA: '" << config.label << "' tamamlanmadı (zaman aşımı)." << std::endl;
+        // A schedule started meanwhile has replaced the one-shot program; leave it running.
+        if (!pending.inserted && m_isInitialized && !m_scheduleRunning) m_device->bcHalt(m_biuId);
+        return ret;
     }
-    
-    TY_API_BC_FRAME temp_minor_frame;
-    memset(&temp_minor_frame, 0, sizeof(temp_minor_frame));
-    temp_minor_frame.id = (AiUInt16)transferId; 
-    temp_minor_frame.cnt = 1;
-    temp_minor_frame.instr[0] = API_BC_INSTR_TRANSFER;
-    temp_minor_frame.xid[0] = transferId;
-    ret = ApiCmdBCFrameDef(m_boardHandle, m_biuId, &temp_minor_frame);
-    if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCFrameDef başarısız." << std::endl; return ret; }
-    
-    TY_API_BC_MFRAME_EX temp_major_frame;
-    memset(&temp_major_frame, 0, sizeof(temp_major_frame));
-    temp_major_frame.cnt = 1;
-    temp_major_frame.fid[0] = temp_minor_frame.id;
-    ret = ApiCmdBCMFrameDefEx(m_boardHandle, m_biuId, &temp_major_frame);
-    if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCMFrameDefEx başarısız." << std::endl; return ret; }
-    
-    AiUInt32 major_addr, minor_addr[64];
-    ret = ApiCmdBCStart(m_boardHandle, m_biuId, API_BC_START_IMMEDIATELY, 1, 10.0f, 0, &major_addr, minor_addr);
-    if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCStart başarısız." << std::endl; return ret; }
-    
-    std::this_thread::sleep_for(std::chrono::milliseconds(25)); 
 
-    bool expectsData = (config.mode == BcMode::RT_TO_BC || config.mode == BcMode::RT_TO_RT);
-    if (expectsData && wc_to_process > 0) {
+    int wc_to_process = dataWordCount(config);
+    if (receivesData(config) && wc_to_process > 0) {
         AiUInt16 outIndex; AiUInt32 outAddr;
-        ret = ApiCmdBufRead(m_boardHandle, m_biuId, API_BUF_BC_MSG, headerId, bufferId, wc_to_process, receivedData.data(), &outIndex, &outAddr);
+        ret = m_device->bufRead(m_biuId, API_BUF_BC_MSG, pending.ids.headerId, pending.ids.bufferId, wc_to_process, receivedData.data(), &outIndex, &outAddr);
         if (ret != API_OK) return ret;
     }
 
-    ret = ApiCmdBCHalt(m_boardHandle, m_biuId);
-    if (ret != API_OK) return ret;
+    if (!pending.inserted) {
+        ret = m_device->bcHalt(m_biuId);
+        if (ret != API_OK) return ret;
+    }
 
+    if (report) {
+        report->statusWord = transferStatus.st1;
+        report->reportWord = transferStatus.brw;
+        report->error = transferStatus.err_cnt != pending.errorsBefore;
+        report->roundTrip = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - pending.started);
+    }
     std::cout << "[BC::send] Gönderim başarıyla tamamlandı." << std::endl;
     return API_OK;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Waits until the card counts another execution of the transfer of a send, then returns its status.
+ *        Polls ApiCmdBCXferRead: first in a tight loop for SPIN_US, which covers a transfer started at once
+ *        (a 32-word transfer takes under 1 ms), then every POLL_SLEEP_US until the timeout, with m_apiMutex
+ *        released so the schedule's readers get in. Gives up if the BC is shut down or the schedule an insert
+ *        went into stops (or, for a one-shot program, a schedule replaces it).
+ * @param lock The held m_apiMutex.
+ * @return API_OK, API_ERR_TIMEOUT, API_ERR if given up, or the error of ApiCmdBCXferRead.
+ */
+AiReturn BusController::waitForTransfer(std::unique_lock<std::mutex>& lock, const PendingSend& pending,
+                                        std::chrono::microseconds timeout, TY_API_BC_XFER_DSP& status) {
+    const auto started = std::chrono::steady_clock::now();
+    while (true) {
+        AiReturn ret = m_device->bcXferRead(m_biuId, pending.ids.transferId, API_DONT_MODIFY_STATUS_BITS, &status);
+        if (ret != API_OK) return ret;
+        if (status.msg_cnt + status.err_cnt != pending.sentBefore) return API_OK;
+        const auto waited = std::chrono::steady_clock::now() - started;
+        if (waited >= timeout) return API_ERR_TIMEOUT;
+        if (waited < std::chrono::microseconds(SPIN_US)) { std::this_thread::yield(); continue; }
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::microseconds(POLL_SLEEP_US));
+        lock.lock();
+        if (!m_isInitialized || m_scheduleRunning != pending.inserted) return API_ERR;
+    }
+}
+
+/**
+ * @brief Inserts one transfer into the running schedule with ApiCmdBCAcycPrep/ApiCmdBCAcycSend. The card
+ *        sends it at the end of the current minor frame, so no cyclic transfer is dropped or redefined and
+ *        the BC is not halted. The caller holds m_apiMutex.
+ * @param ids The frame's insert transfer (see insertTransferFor()).
+ */
+AiReturn BusController::insertAcyclicFrame(const FrameConfig& config, const TransferIds& ids) {
+    AiReturn ret = writeTransmitData(config, ids);
+    if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBufDef başarısız." << std::endl; return ret; }
+
+    TY_API_BC_ACYC acyclic;
+    memset(&acyclic, 0, sizeof(acyclic));
+    acyclic.cnt = 1;
+    acyclic.instr[0] = API_BC_INSTR_TRANSFER;
+    acyclic.xid[0] = ids.transferId;
+    ret = m_device->bcAcycPrep(m_biuId, &acyclic);
+    if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCAcycPrep başarısız." << std::endl; return ret; }
+    ret = m_device->bcAcycSend(m_biuId, API_BC_ACYC_SEND_AT_END_OF_FRAME, 0, 0);
+    if (ret != API_OK) { std::cerr << "[BC::send] HATA: ApiCmdBCAcycSend başarısız." << std::endl; return ret; }
+
+    std::cout << "[BC::send] '" << config.label << "' döngüsel programa eklendi (alt çerçeve sonunda)." << std::endl;
+    return API_OK;
+}
+
+/**
+ * @brief Returns the number of data words a frame carries (0 for mode codes without data).
+ */
+int BusController::dataWordCount(const FrameConfig& config) {
+    if (config.mode == BcMode::MODE_CODE_NO_DATA) return 0;
+    if (config.mode == BcMode::MODE_CODE_WITH_DATA) return 1;
+    return config.wc == 0 ? 32 : config.wc;
+}
+
+/**
+ * @brief Returns whether the BC receives data words for a frame (RT to BC and RT to RT frames).
+ */
+bool BusController::receivesData(const FrameConfig& config) {
+    return config.mode == BcMode::RT_TO_BC || config.mode == BcMode::RT_TO_RT;
+}
+
+/**
+ * @brief Estimates the bus time of one transfer: 20 us per word, plus response time and inter-message gap.
+ */
+int BusController::estimatedTransferUs(const FrameConfig& config) {
+    int words = 2 + dataWordCount(config);         // Command and status words.
+    if (config.mode == BcMode::RT_TO_RT) words += 2; // Second command and second status word.
+    return words * 20 + 20;
+}
+
+/**
+ * @brief Writes the data words the BC sends for a frame into its message buffer. Frames that only
+ *        receive data have nothing to write.
+ */
+AiReturn BusController::writeTransmitData(const FrameConfig& config, const TransferIds& ids) {
+    bool hasDataField = (config.mode == BcMode::BC_TO_RT || config.mode == BcMode::RT_TO_RT || config.mode == BcMode::MODE_CODE_WITH_DATA);
+    int wordCount = dataWordCount(config);
+    if (!hasDataField || wordCount == 0) return API_OK;
+    // The payload was parsed and validated when the frame was created or edited.
+    std::array<AiUInt16, BC_MAX_DATA_WORDS> dataWords = config.payload;
+    AiUInt16 outIndex; AiUInt32 outAddr;
+    return m_device->bufDef(m_biuId, API_BUF_BC_MSG, ids.headerId, ids.bufferId, wordCount, dataWords.data(), &outIndex, &outAddr);
+}
+
+/**
+ * @brief Compiles the frames into one major frame and starts it once; from then on the card does all timing.
+ *        Transfers are packed in order into minor frames of BC_FRAME_TIME_MS, starting a new minor frame when
+ *        the estimated bus time of the next transfer would overrun the current one (or it is full), so every
+ *        frame is sent once per major frame.
+ * @param frames The frames to send, with their resources already defined.
+ * @param repeat If true the major frame repeats until stopCyclicSchedule(); otherwise it runs once.
+ */
+AiReturn BusController::startCyclicSchedule(const std::vector<ScheduledFrame>& frames, bool repeat) {
+    std::lock_guard<std::mutex> lock(m_apiMutex);
+    if (!m_isInitialized || frames.empty()) return API_ERR;
+    if (m_scheduleRunning) m_device->bcHalt(m_biuId);
+    m_scheduleRunning = false;
+
+    const int frameBudgetUs = static_cast<int>(BC_FRAME_TIME_MS) * 1000;
+    std::vector<TY_API_BC_FRAME> minorFrames;
+    int usedUs = 0;
+    for (const ScheduledFrame& frame : frames) {
+        if (frame.ids.transferId == 0) {
+            std::cerr << "[BC::schedule] HATA: '" << frame.config.label << "' için kaynaklar tanımlanmamış!" << std::endl;
+            return API_ERR;
+        }
+        AiReturn ret = writeTransmitData(frame.config, frame.ids);
+        if (ret != API_OK) { std::cerr << "[BC::schedule] HATA: ApiCmdBufDef başarısız." << std::endl; return ret; }
+
+        int transferUs = estimatedTransferUs(frame.config);
+        if (minorFrames.empty() || usedUs + transferUs > frameBudgetUs || minorFrames.back().cnt >= MAX_API_BC_XFRAME) {
+            if (static_cast<int>(minorFrames.size()) >= MAX_API_BC_MFRAME_ID) {
+                std::cerr << "[BC::schedule] HATA: Çerçeveler " << MAX_API_BC_MFRAME_ID << " alt çerçeveye sığmıyor." << std::endl;
+                return API_ERR;
+            }
+            TY_API_BC_FRAME minor;
+            memset(&minor, 0, sizeof(minor));
+            minor.id = static_cast<AiUInt8>(minorFrames.size() + 1);
+            minorFrames.push_back(minor);
+            usedUs = 0;
+        }
+        TY_API_BC_FRAME& minor = minorFrames.back();
+        minor.instr[minor.cnt] = API_BC_INSTR_TRANSFER;
+        minor.xid[minor.cnt] = frame.ids.transferId;
+        ++minor.cnt;
+        usedUs += transferUs;
+    }
+
+    TY_API_BC_MFRAME_EX major;
+    memset(&major, 0, sizeof(major));
+    for (TY_API_BC_FRAME& minor : minorFrames) {
+        AiReturn ret = m_device->bcFrameDef(m_biuId, &minor);
+        if (ret != API_OK) { std::cerr << "[BC::schedule] HATA: ApiCmdBCFrameDef başarısız." << std::endl; return ret; }
+        major.fid[major.cnt++] = minor.id;
+    }
+    AiReturn ret = m_device->bcMFrameDefEx(m_biuId, &major);
+    if (ret != API_OK) { std::cerr << "[BC::schedule] HATA: ApiCmdBCMFrameDefEx başarısız." << std::endl; return ret; }
+
+    // A count of 0 runs the major frame cyclically until halted.
+    AiUInt32 majorAddr;
+    std::array<AiUInt32, MAX_API_BC_MFRAME_EX> minorAddr;
+    ret = m_device->bcStart(m_biuId, API_BC_START_IMMEDIATELY, repeat ? 0 : 1, static_cast<AiFloat>(BC_FRAME_TIME_MS), 0, &majorAddr, minorAddr.data());
+    if (ret != API_OK) { std::cerr << "[BC::schedule] HATA: ApiCmdBCStart başarısız." << std::endl; return ret; }
+
+    m_scheduleMinorFrames = static_cast<int>(minorFrames.size());
+    m_scheduleRunning = true;
+    std::cout << "[BC::schedule] " << frames.size() << " çerçeve, " << minorFrames.size() << " alt çerçeve x " << BC_FRAME_TIME_MS
+              << " ms, " << (repeat ? "döngüsel" : "tek sefer") << " başlatıldı." << std::endl;
+    return API_OK;
+}
+
+/**
+ * @brief Halts the BC schedule started by startCyclicSchedule().
+ */
+AiReturn BusController::stopCyclicSchedule() {
+    std::lock_guard<std::mutex> lock(m_apiMutex);
+    if (!m_isInitialized || !m_scheduleRunning) return API_OK;
+    m_scheduleRunning = false;
+    std::cout << "[BC::schedule] Durduruldu." << std::endl;
+    return m_device->bcHalt(m_biuId);
+}
+
+/**
+ * @brief Reads the data a frame last received (RT to BC and RT to RT frames) while the schedule runs.
+ *        Only uses the copy in frame, so the sending thread may call it while the UI edits the frame.
+ */
+AiReturn BusController::readReceivedData(const ScheduledFrame& frame, std::array<AiUInt16, BC_MAX_DATA_WORDS>& receivedData) {
+    std::lock_guard<std::mutex> lock(m_apiMutex);
+    if (!m_isInitialized || frame.ids.transferId == 0) return API_ERR;
+    int wordCount = dataWordCount(frame.config);
+    if (!receivesData(frame.config) || wordCount == 0) return API_OK;
+    AiUInt16 outIndex; AiUInt32 outAddr;
+    return m_device->bufRead(m_biuId, API_BUF_BC_MSG, frame.ids.headerId, frame.ids.bufferId, wordCount, receivedData.data(), &outIndex, &outAddr);
+}
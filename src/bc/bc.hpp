@@ -4,33 +4,97 @@
 #include "common.hpp"
 #include "AiOs.h"
 #include "Api1553.h"
+#include "aimDevice.hpp"
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
 #include <mutex>
-
-class FrameComponent; // Forward declaration
+#include <string>
+#include <vector>
 
 class BusController {
 public:
     static BusController& getInstance();
+    // The application uses getInstance(); tests construct their own on a SimulatedDevice.
+    BusController() = default;
+    ~BusController();
     BusController(const BusController&) = delete;
     void operator=(const BusController&) = delete;
 
     AiReturn initialize(int deviceId, int streamId = 1);
+    AiReturn initialize(std::unique_ptr<AimDevice> device, int deviceId, int streamId = 1);
     void shutdown();
     bool isInitialized() const;
     
-    AiReturn defineFrameResources(FrameComponent* frame);
-    AiReturn sendAcyclicFrame(const FrameComponent* frame, std::array<AiUInt16, BC_MAX_DATA_WORDS>& receivedData);
-    
+    // What the card reported for one sendAcyclicFrame() call (see finishAcyclicFrame()).
+    struct SendReport {
+        AiUInt16 statusWord = 0;                 // First status word of the transfer.
+        AiUInt16 reportWord = 0;                 // Buffer report word of the transfer.
+        bool error = false;                      // The card counted a transfer error (e.g. no response).
+        std::chrono::microseconds roundTrip{0};  // From sendAcyclicFrame() until the response data was read.
+    };
+
+    // The transfer, buffer header and buffer that send a frame.
+    struct TransferIds {
+        AiUInt16 transferId = 0;
+        AiUInt16 headerId = 0;
+        AiUInt16 bufferId = 0;
+    };
+
+    // A frame as the BC sends it: copies of its configuration and ids, taken on the UI thread.
+    struct ScheduledFrame {
+        FrameConfig config;
+        TransferIds ids;
+    };
+
+    // A send the card has accepted; finishAcyclicFrame() waits for it.
+    struct PendingSend {
+        ScheduledFrame frame;
+        TransferIds ids;            // The transfer that goes out: the frame's own, or its insert transfer.
+        bool inserted = false;      // Inserted into the running schedule rather than sent by a one-shot program.
+        AiUInt32 sentBefore = 0;    // Message plus error count of the transfer before the send.
+        AiUInt32 errorsBefore = 0;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    AiReturn defineFrameResources(const FrameConfig& config, TransferIds& ids);
+    void releaseFrameResources(AiUInt16 transferId);
+    AiReturn sendAcyclicFrame(const ScheduledFrame& frame, PendingSend& pending);
+    AiReturn finishAcyclicFrame(const PendingSend& pending, std::array<AiUInt16, BC_MAX_DATA_WORDS>& receivedData, SendReport* report = nullptr);
+
+    // Hardware-timed schedule: all frames compiled into one major frame that the card runs on its own.
+    AiReturn startCyclicSchedule(const std::vector<ScheduledFrame>& frames, bool repeat);
+    AiReturn stopCyclicSchedule();
+    bool isScheduleRunning() const { return m_scheduleRunning; }
+    int scheduleMinorFrames() const { return m_scheduleMinorFrames; }
+    AiReturn readReceivedData(const ScheduledFrame& frame, std::array<AiUInt16, BC_MAX_DATA_WORDS>& receivedData);
+    static bool receivesData(const FrameConfig& config);
+
     static const char* getAIMError(AiReturn ret);
 
 private:
-    BusController() = default;
-    ~BusController();
-
     std::mutex m_apiMutex;
+    static std::string loadDeviceBackend();
+    static int dataWordCount(const FrameConfig& config);
+    static int estimatedTransferUs(const FrameConfig& config);
+
+    TransferIds allocateTransferIds();
+    AiReturn defineTransfer(const FrameConfig& config, const TransferIds& ids);
+    AiReturn insertTransferFor(const ScheduledFrame& frame, TransferIds& ids);
+    AiReturn writeTransmitData(const FrameConfig& config, const TransferIds& ids);
+    AiReturn insertAcyclicFrame(const FrameConfig& config, const TransferIds& ids);
+    AiReturn waitForTransfer(std::unique_lock<std::mutex>& lock, const PendingSend& pending, std::chrono::microseconds timeout,
+                             TY_API_BC_XFER_DSP& status);
+
+    static constexpr int SPIN_US = 200;        // Completion polling: busy phase, then sleeps of POLL_SLEEP_US.
+    static constexpr int POLL_SLEEP_US = 100;
+    // Minor frame of the one-shot Send Once program; startCyclicSchedule() redefines the minor frames anyway.
+    static constexpr AiUInt8 ONE_SHOT_MINOR_FRAME_ID = 1;
+
     std::atomic<bool> m_isInitialized{false};
-    AiUInt32 m_boardHandle = 0;
+    std::unique_ptr<AimDevice> m_device;
     int m_deviceId = 0;
     int m_streamId = 0;
     const int m_biuId = 0;
@@ -38,4 +102,9 @@ private:
     AiUInt32 m_nextTransferId = 1;
     AiUInt32 m_nextHeaderId = 1;
     AiUInt32 m_nextBufferId = 1;
+
+    std::atomic<bool> m_scheduleRunning{false};
+    int m_scheduleMinorFrames = 0;
+    std::map<AiUInt16, TransferIds> m_insertTransfers; // Insert transfer by the frame's own transfer id.
+    bool m_sendPending = false;                        // Between sendAcyclicFrame() and finishAcyclicFrame().
 };
\ No newline at end of file
@@ -0,0 +1,36 @@
+// fileName: bcBackend.cpp
+// The parts of BusController bound to the AIM library and config.json; bc.cpp only talks to an AimDevice,
+// so the tests can run it on a SimulatedDevice.
+#include "bc.hpp"
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Opens the device backend selected in config.json (see loadDeviceBackend()) and puts it in BC mode.
+ */
+AiReturn BusController::initialize(int deviceId, int streamId) {
+    if (m_isInitialized) {
+        std::cout << "[BC] Zaten başlatılmış." << std::endl;
+        return API_OK;
+    }
+    return initialize(AimDevice::create(loadDeviceBackend(), Common::getConfigPath()), deviceId, streamId);
+}
+
+/**
+ * @brief Reads the device backend ("aim" or "simulator") from the Bus_Controller section of config.json.
+ */
+std::string BusController::loadDeviceBackend() {
+    std::ifstream ifs(Common::getConfigPath());
+    if (!ifs.is_open()) return AimDevice::HARDWARE;
+    try {
+        nlohmann::json configJson;
+        ifs >> configJson;
+        if (configJson.contains("Bus_Controller")) return configJson["Bus_Controller"].value("Device_Backend", std::string(AimDevice::HARDWARE));
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "[BC] HATA: config.json okunamadı: " << e.what() << std::endl;
+    }
+    return AimDevice::HARDWARE;
+}
+
+const char* BusController::getAIMError(AiReturn ret) { return ApiGetErrorMessage(ret); }
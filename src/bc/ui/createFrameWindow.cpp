@@ -50,7 +50,8 @@ void FrameCreationFrame::createAndLayoutControls() {
     m_labelTextCtrl->SetHint("Set frame label");
 
     for (int i = 0; i < BC_MAX_DATA_WORDS; ++i) {
-        auto *data = new wxTextCtrl(this, wxID_ANY, "0000", wxDefaultPosition, wxSize(70, -1));
+        auto *data = new wxTextCtrl(this, wxID_ANY, "0000", wxDefaultPosition, wxSize(70, -1), 0, wxTextValidator(wxFILTER_XDIGITS));
+        data->SetMaxLength(4);
         m_dataTextCtrls.push_back(data);
         dataGridSizer->Add(data, 0, wxEXPAND);
     }
@@ -109,9 +110,28 @@ void FrameCreationFrame::populateFieldsFromConfig(const FrameConfig& config) {
     }
 }
 
-FrameConfig FrameCreationFrame::buildConfigFromFields() {
+/**
+ * @brief Builds the frame from the fields and parses its data words into the payload, once, here.
+ *        The words the frame sends (the enabled fields) must be valid hex; the others are reset to 0000.
+ * @return False, after telling the user, if a data word the frame sends is not valid.
+ */
+bool FrameCreationFrame::buildConfigFromFields(FrameConfig& config) {
     std::array<std::string, BC_MAX_DATA_WORDS> data;
-    for (size_t i = 0; i < data.size(); ++i) { data.at(i) = m_dataTextCtrls.at(i)->GetValue().ToStdString(); }
+    std::array<uint16_t, BC_MAX_DATA_WORDS> payload{};
+    for (size_t i = 0; i < data.size(); ++i) {
+        wxTextCtrl* field = m_dataTextCtrls.at(i);
+        const std::string text = field->GetValue().Trim(true).Trim(false).ToStdString();
+        if (!Common::parseDataWord(text, payload.at(i))) {
+            if (field->IsEnabled()) {
+                wxMessageBox(wxString::Format("Data word %zu ('%s') is not a hex number of 1-4 digits.", i + 1, text), "Invalid Data", wxOK | wxICON_ERROR, this);
+                field->SetFocus();
+                field->SelectAll();
+                return false;
+            }
+            payload.at(i) = 0;
+        }
+        data.at(i) = Common::formatDataWord(payload.at(i));
+    }
     std::string label = m_labelTextCtrl->GetValue().ToStdString();
     if (label.empty()) { label = "Untitled Frame"; }
     long rt, sa, rt2, sa2, wc;
@@ -120,12 +140,14 @@ FrameConfig FrameCreationFrame::buildConfigFromFields() {
     m_rt2Combo->GetValue().ToLong(&rt2);
     m_sa2Combo->GetValue().ToLong(&sa2);
     m_wcCombo->GetValue().ToLong(&wc);
-    return { label, m_busCombo->GetValue().ToStdString()[0], (int)rt, (int)sa, (int)rt2, (int)sa2, (int)wc, static_cast<BcMode>(m_modeCombo->GetSelection()), data };
+    config = { label, m_busCombo->GetValue().ToStdString()[0], (int)rt, (int)sa, (int)rt2, (int)sa2, (int)wc, static_cast<BcMode>(m_modeCombo->GetSelection()), data, payload };
+    return true;
 }
 
 void FrameCreationFrame::onSave(wxCommandEvent &) {
-    FrameConfig config = buildConfigFromFields();
-    if (m_editingFrame) { m_parentFrame->updateFrame(m_editingFrame, config); } 
+    FrameConfig config;
+    if (!buildConfigFromFields(config)) return;
+    if (m_editingFrame) { if (!m_parentFrame->updateFrame(m_editingFrame, config)) return; } // Kept open while sending.
     else { m_parentFrame->addFrameToList(config); }
     Close(true);
 }
@@ -4,6 +4,7 @@
 #include "common.hpp"
 #include <wx/wx.h>
 #include <wx/combobox.h>
+#include <wx/valtext.h>
 #include <vector>
 
 class BusControllerFrame;
@@ -22,7 +23,7 @@ private:
   void onRandomize(wxCommandEvent &event);
   void onClose(wxCommandEvent &event);
   void populateFieldsFromConfig(const FrameConfig &config);
-  FrameConfig buildConfigFromFields();
+  bool buildConfigFromFields(FrameConfig &config);
   void updateControlStates();
 
   BusControllerFrame *m_parentFrame;
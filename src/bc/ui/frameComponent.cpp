@@ -4,11 +4,10 @@
 #include "createFrameWindow.hpp"
 #include "bc.hpp"
 #include <sstream>
-#include <iomanip>
 #include <iostream>
 
 FrameComponent::FrameComponent(wxWindow *parent, const FrameConfig &config)
-    : wxPanel(parent, wxID_ANY), m_config(config), m_aimTransferId(0), m_aimHeaderId(0), m_aimBufferId(0) {
+    : wxPanel(parent, wxID_ANY), m_config(config) {
     
     m_mainWindow = dynamic_cast<BusControllerFrame *>(parent->GetParent());
     auto *mainSizer = new wxBoxSizer(wxHORIZONTAL);
@@ -49,12 +48,6 @@ FrameComponent::FrameComponent(wxWindow *parent, const FrameConfig &config)
     updateValues(config);
 }
 
-void FrameComponent::setAimIds(AiUInt16 xferId, AiUInt16 hdrId, AiUInt16 bufId) {
-    m_aimTransferId = xferId;
-    m_aimHeaderId = hdrId;
-    m_aimBufferId = bufId;
-}
-
 void FrameComponent::updateValues(const FrameConfig &config) {
     m_config = config;
     std::stringstream ss;
@@ -88,21 +81,23 @@ void FrameComponent::updateValues(const FrameConfig &config) {
     if (m_mainWindow) m_mainWindow->updateListLayout();
 }
 
-void FrameComponent::updateDataUI(const std::array<AiUInt16, BC_MAX_DATA_WORDS>& newData) {
-    wxTheApp->CallAfter([this, newData]{
-        FrameConfig newConfig = m_config;
-        std::array<std::string, BC_MAX_DATA_WORDS> new_str_data;
-        int count = (m_config.wc == 0) ? 32 : m_config.wc;
-        for(int i = 0; i < count; ++i) {
-            std::stringstream ss;
-            ss << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << newData.at(i);
-            new_str_data.at(i) = ss.str();
-        }
-        newConfig.data = new_str_data;
-        updateValues(newConfig);
-    });
+/**
+ * @brief Shows the data words this frame received (RT to BC and RT to RT frames). Runs on the UI thread and
+ *        only rewrites the data labels, so neither the summary nor the list layout is rebuilt.
+ */
+void FrameComponent::showReceivedData(const std::array<AiUInt16, BC_MAX_DATA_WORDS>& newData) {
+    int count = (m_config.wc == 0) ? 32 : m_config.wc;
+    for(int i = 0; i < count; ++i) {
+        m_config.payload[i] = newData[i];
+        m_config.data[i] = Common::formatDataWord(newData[i]);
+        m_dataLabels[i]->SetLabel(m_config.data[i]);
+    }
 }
 
+/**
+ * @brief Starts sending this frame once. Returns as soon as the card accepted it; the main window waits for
+ *        the transfer off the UI thread and shows the result (see BusControllerFrame::finishSendOnce()).
+ */
 void FrameComponent::sendFrame() {
     std::cout << "[UI] FrameComponent::sendFrame çağrıldı. Label: " << m_config.label << std::endl;
     if (!m_mainWindow) { std::cerr << "[UI] HATA: Ana pencere bulunamadı!" << std::endl; return; }
@@ -114,19 +109,14 @@ void FrameComponent::sendFrame() {
             return;
         }
     }
-    wxTheApp->CallAfter([this]{ m_mainWindow->setStatusText("Sending: " + m_config.label); });
-    std::array<AiUInt16, BC_MAX_DATA_WORDS> received_data;
-    AiReturn status = bc.sendAcyclicFrame(this, received_data);
+    BusController::PendingSend pending;
+    AiReturn status = bc.sendAcyclicFrame(getScheduledFrame(), pending);
     if (status != API_OK) {
-        std::string errMsg = "Error sending frame '" + m_config.label + "': " + std::string(bc.getAIMError(status));
-        wxTheApp->CallAfter([this, errMsg]{ m_mainWindow->setStatusText(errMsg); });
-    } else {
-        std::string logMsg = "Sent frame '" + m_config.label + "' successfully.";
-        wxTheApp->CallAfter([this, logMsg]{ m_mainWindow->setStatusText(logMsg); });
-        if (m_config.mode == BcMode::RT_TO_BC || m_config.mode == BcMode::RT_TO_RT) {
-            updateDataUI(received_data);
-        }
+        m_mainWindow->setStatusText("Error sending frame '" + m_config.label + "': " + std::string(bc.getAIMError(status)));
+        return;
     }
+    m_mainWindow->setStatusText("Sending: " + m_config.label);
+    m_mainWindow->finishSendOnce(pending);
 }
 
 bool FrameComponent::isActive() const { return m_activateToggle->GetValue(); }
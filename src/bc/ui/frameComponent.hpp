@@ -1,7 +1,7 @@
 // fileName: frameComponent.hpp
 #pragma once
 #include "common.hpp"
-#include "AiOs.h"
+#include "bc.hpp"
 #include <wx/wx.h>
 #include <wx/tglbtn.h>
 #include <array>
@@ -15,12 +15,11 @@ public:
   void sendFrame();
   bool isActive() const;
   const FrameConfig &getFrameConfig() const { return m_config; }
-  void updateDataUI(const std::array<AiUInt16, BC_MAX_DATA_WORDS> &newData);
+  void showReceivedData(const std::array<AiUInt16, BC_MAX_DATA_WORDS> &newData);
 
-  void setAimIds(AiUInt16 xferId, AiUInt16 hdrId, AiUInt16 bufId);
-  AiUInt16 getAimTransferId() const { return m_aimTransferId; }
-  AiUInt16 getAimHeaderId() const { return m_aimHeaderId; }
-  AiUInt16 getAimBufferId() const { return m_aimBufferId; }
+  void setAimIds(const BusController::TransferIds &ids) { m_aimIds = ids; }
+  AiUInt16 getAimTransferId() const { return m_aimIds.transferId; }
+  BusController::ScheduledFrame getScheduledFrame() const { return {m_config, m_aimIds}; }
 
 private:
   void onSend(wxCommandEvent &event);
@@ -34,7 +33,5 @@ private:
   wxToggleButton *m_activateToggle{};
   FrameConfig m_config;
 
-  AiUInt16 m_aimTransferId = 0;
-  AiUInt16 m_aimHeaderId = 0;
-  AiUInt16 m_aimBufferId = 0;
+  BusController::TransferIds m_aimIds;
 };
\ No newline at end of file
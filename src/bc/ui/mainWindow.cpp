@@ -4,6 +4,7 @@
 #include "bc.hpp"
 #include <iostream>
 #include <algorithm> 
+#include <chrono>
 
 BusControllerFrame::BusControllerFrame()
     : wxFrame(nullptr, wxID_ANY, "AIM MIL-STD-1553 Bus Controller", wxDefaultPosition, wxSize(800, 600)) {
@@ -60,6 +61,7 @@ BusControllerFrame::BusControllerFrame()
 
 BusControllerFrame::~BusControllerFrame() {
   stopSendingThread();
+  if (m_sendOnceThread.joinable()) m_sendOnceThread.join();
 }
 
 // ... addFrameToList, updateFrame, removeFrame, onAddFrameClicked, onClearFramesClicked, onRepeatToggle aynı kalacak ...
@@ -75,28 +77,41 @@ void BusControllerFrame::addFrameToList(FrameConfig config) {
         }
     }
     
-    auto *component = new FrameComponent(m_scrolledWindow, config);
-    AiReturn ret = bc.defineFrameResources(component);
+    BusController::TransferIds ids;
+    AiReturn ret = bc.defineFrameResources(config, ids);
     if (ret != API_OK) {
         wxMessageBox("Failed to define frame resources on AIM device: " + wxString(BusController::getAIMError(ret)), "Error", wxOK | wxICON_ERROR);
-        component->Destroy(); 
         return;
     }
     
+    auto *component = new FrameComponent(m_scrolledWindow, config);
+    component->setAimIds(ids);
+
     m_frameComponents.push_back(component);
     m_scrolledSizer->Add(component, 0, wxEXPAND | wxALL, 5);
     updateListLayout();
 }
 
-void BusControllerFrame::updateFrame(FrameComponent* oldFrame, const FrameConfig& newConfig) {
+bool BusControllerFrame::updateFrame(FrameComponent* oldFrame, const FrameConfig& newConfig) {
+    // The sending thread holds pointers to the listed frames; they may only change while it is stopped.
+    if (m_isSending) {
+        wxMessageBox("Please stop sending frames before editing a frame.", "Warning", wxOK | wxICON_WARNING);
+        return false;
+    }
     std::cout << "[UI] Çerçeve güncelleniyor: " << newConfig.label << std::endl;
     removeFrame(oldFrame);
     addFrameToList(newConfig);
+    return true;
 }
 
 void BusControllerFrame::removeFrame(FrameComponent* frame) {
     if (!frame) return;
+    if (m_isSending) {
+        wxMessageBox("Please stop sending frames before removing a frame.", "Warning", wxOK | wxICON_WARNING);
+        return;
+    }
     std::cout << "[UI] Çerçeve listeden kaldırılıyor: " << frame->getFrameConfig().label << std::endl;
+    BusController::getInstance().releaseFrameResources(frame->getAimTransferId());
     
     m_scrolledSizer->Detach(frame);
     m_frameComponents.erase(std::remove(m_frameComponents.begin(), m_frameComponents.end(), frame), m_frameComponents.end());
@@ -173,18 +188,28 @@ void BusControllerFrame::stopSendingThread() {
   });
 }
 
+/**
+ * @brief Sends the active frames as one hardware-timed BC schedule.
+ *        All active frames are compiled into a single major frame of BC_FRAME_TIME_MS minor frames and started
+ *        once; the card does the timing, cyclically while Repeat is on, otherwise for one major frame. This thread
+ *        only reads back the data received by RT to BC and RT to RT frames once per minor frame, and halts the BC on stop.
+ *        It works on copies of the active frames taken on the UI thread and never touches a FrameComponent.
+ */
 void BusControllerFrame::sendActiveFramesLoop() {
-    // Aktif çerçeveleri UI thread'inden güvenli bir şekilde al
-    auto promise_ptr = std::make_shared<std::promise<std::vector<FrameComponent*>>>();
-    std::future<std::vector<FrameComponent*>> future = promise_ptr->get_future();
+    // Aktif çerçeveleri ve tekrar modunu UI thread'inden güvenli bir şekilde al
+    using Selection = std::pair<std::vector<BusController::ScheduledFrame>, bool>;
+    auto promise_ptr = std::make_shared<std::promise<Selection>>();
+    std::future<Selection> future = promise_ptr->get_future();
     wxTheApp->CallAfter([this, promise_ptr]() {
-        std::vector<FrameComponent*> activeFrames;
+        std::vector<BusController::ScheduledFrame> activeFrames;
         for (auto* frame : m_frameComponents) {
-            if (frame && frame->isActive()) { activeFrames.push_back(frame); }
+            if (frame && frame->isActive()) { activeFrames.push_back(frame->getScheduledFrame()); }
         }
-        promise_ptr->set_value(activeFrames);
+        promise_ptr->set_value(Selection(activeFrames, m_repeatToggle->GetValue()));
     });
-    std::vector<FrameComponent*> activeFrames = future.get();
+    Selection selection = future.get();
+    const std::vector<BusController::ScheduledFrame>& activeFrames = selection.first;
+    const bool repeat = selection.second;
     
     auto& bc = BusController::getInstance();
     if (!bc.isInitialized()) {
@@ -206,21 +231,37 @@ void BusControllerFrame::sendActiveFramesLoop() {
         });
         return;
     }
-    
-    // Ana gönderim döngüsü
-    do {
-        for (FrameComponent* frame : activeFrames) {
-            if (!m_isSending) break; // Her çerçeve öncesi durdurma sinyalini kontrol et
-            frame->sendFrame();
-            std::this_thread::sleep_for(std::chrono::milliseconds(20));
-        }
-        if (!m_isSending) break; // Döngü tekrar etmeden önce son bir kez daha kontrol et
-        
-        // Tekrar modu aktifse, bir sonraki döngü için bekle
-        if (m_repeatToggle->GetValue()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(BC_FRAME_TIME_MS));
+
+    AiReturn ret = bc.startCyclicSchedule(activeFrames, repeat);
+    if (ret != API_OK) {
+        wxTheApp->CallAfter([this, ret] {
+            setStatusText("Error starting BC schedule: " + wxString(BusController::getAIMError(ret)));
+            stopSendingThread();
+        });
+        return;
+    }
+    const int minorFrames = bc.scheduleMinorFrames();
+    wxString status = wxString::Format("Sending %zu frames in %d x %u ms minor frames%s.", activeFrames.size(), minorFrames,
+                                       BC_FRAME_TIME_MS, repeat ? ", repeating" : " once");
+    wxTheApp->CallAfter([this, status] { setStatusText(status); });
+
+    // The card runs the schedule; only read back received data here, once per minor frame, and hand it
+    // to the UI thread in one update.
+    const auto majorFrameTime = std::chrono::milliseconds(static_cast<long>(minorFrames) * BC_FRAME_TIME_MS);
+    const auto started = std::chrono::steady_clock::now();
+    while (m_isSending) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(BC_FRAME_TIME_MS));
+        std::vector<ReceivedData> received;
+        for (const BusController::ScheduledFrame& frame : activeFrames) {
+            if (!BusController::receivesData(frame.config)) continue;
+            ReceivedData data(frame.ids.transferId, {});
+            if (bc.readReceivedData(frame, data.second) == API_OK) received.push_back(data);
         }
-    } while (m_isSending && m_repeatToggle->GetValue());
+        if (!received.empty()) wxTheApp->CallAfter([this, received] { showReceivedData(received); });
+        // A single run ends after one major frame; allow one more minor frame for the last transfers.
+        if (!repeat && std::chrono::steady_clock::now() - started >= majorFrameTime + std::chrono::milliseconds(BC_FRAME_TIME_MS)) break;
+    }
+    bc.stopCyclicSchedule();
 
     // DÜZELTME (ANA ÇÖZÜM): Thread işini bitirince, kendi kendini durdurmaya çalışmak yerine
     // durdurma ve temizleme işini ana GUI thread'ine havale et.
@@ -231,6 +272,47 @@ void BusControllerFrame::sendActiveFramesLoop() {
     });
 }
 
+/**
+ * @brief Shows the data the sending thread read back in one poll on the frames that received it. Frames
+ *        removed or edited since the schedule started no longer carry the transfer id and are skipped.
+ */
+void BusControllerFrame::showReceivedData(const std::vector<ReceivedData> &received) {
+    for (const ReceivedData& data : received) {
+        for (FrameComponent* frame : m_frameComponents) {
+            if (frame->getAimTransferId() == data.first) { frame->showReceivedData(data.second); break; }
+        }
+    }
+}
+
+/**
+ * @brief Waits on a worker thread for the transfer of a Send Once the card accepted, then shows the result.
+ *        BusController keeps one send pending at a time, so the previous worker has finished its wait.
+ */
+void BusControllerFrame::finishSendOnce(const BusController::PendingSend &pending) {
+    if (m_sendOnceThread.joinable()) m_sendOnceThread.join();
+    m_sendOnceThread = std::thread([this, pending] {
+        std::array<AiUInt16, BC_MAX_DATA_WORDS> receivedData{};
+        BusController::SendReport report;
+        AiReturn status = BusController::getInstance().finishAcyclicFrame(pending, receivedData, &report);
+        wxTheApp->CallAfter([this, pending, status, report, receivedData] { showSendResult(pending, status, report, receivedData); });
+    });
+}
+
+/**
+ * @brief Shows the outcome of a Send Once, and the data received on the frame if it is still listed.
+ */
+void BusControllerFrame::showSendResult(const BusController::PendingSend &pending, AiReturn status, const BusController::SendReport &report,
+                                        const std::array<AiUInt16, BC_MAX_DATA_WORDS> &receivedData) {
+    const std::string& label = pending.frame.config.label;
+    if (status != API_OK) {
+        setStatusText("Error sending frame '" + label + "': " + std::string(BusController::getAIMError(status)));
+        return;
+    }
+    setStatusText(wxString::Format("Sent frame '%s' in %.2f ms, status 0x%04X%s.", label, report.roundTrip.count() / 1000.0,
+                                   report.statusWord, report.error ? ", transfer error" : ""));
+    if (BusController::receivesData(pending.frame.config)) showReceivedData({ReceivedData(pending.frame.ids.transferId, receivedData)});
+}
+
 // ... updateListLayout, setStatusText, getDeviceId, onExit, onCloseFrame aynı kalacak ...
 void BusControllerFrame::updateListLayout() {
   m_scrolledSizer->Layout();
@@ -251,6 +333,7 @@ void BusControllerFrame::onExit(wxCommandEvent &) { Close(true); }
 
 void BusControllerFrame::onCloseFrame(wxCloseEvent &) {
   stopSendingThread();
+  if (m_sendOnceThread.joinable()) m_sendOnceThread.join();
   BusController::getInstance().shutdown();
   Destroy();
 }
\ No newline at end of file
@@ -2,11 +2,14 @@
 #pragma once
 
 #include "common.hpp"
+#include "bc.hpp"
 #include <wx/wx.h>
 #include <wx/tglbtn.h>
 #include <wx/scrolwin.h>
 #include <thread>
 #include <atomic>
+#include <array>
+#include <utility>
 #include <vector>
 #include <future>
 #include <memory>
@@ -20,11 +23,12 @@ public:
 
   void addFrameToList(FrameConfig config); // Değişiklik yapılabilmesi için by-value
   void removeFrame(FrameComponent* frame);
-  void updateFrame(FrameComponent* oldFrame, const FrameConfig& newConfig);
+  bool updateFrame(FrameComponent* oldFrame, const FrameConfig& newConfig);
   
   void setStatusText(const wxString &status);
   int getDeviceId();
   void updateListLayout();
+  void finishSendOnce(const BusController::PendingSend &pending);
 
 private:
   void onAddFrameClicked(wxCommandEvent &event);
@@ -34,7 +38,13 @@ private:
   void onExit(wxCommandEvent &event);
   void onCloseFrame(wxCloseEvent &event);
 
+  // Data words received by one frame, by the frame's transfer id.
+  using ReceivedData = std::pair<AiUInt16, std::array<AiUInt16, BC_MAX_DATA_WORDS>>;
+
   void sendActiveFramesLoop();
+  void showReceivedData(const std::vector<ReceivedData> &received);
+  void showSendResult(const BusController::PendingSend &pending, AiReturn status, const BusController::SendReport &report,
+                      const std::array<AiUInt16, BC_MAX_DATA_WORDS> &receivedData);
   void startSendingThread();
   void stopSendingThread();
 
@@ -45,6 +55,7 @@ private:
   wxBoxSizer *m_scrolledSizer;
 
   std::thread m_sendThread;
+  std::thread m_sendOnceThread;  // Waits for the transfer of a Send Once.
   std::atomic<bool> m_isSending{false};
   std::vector<FrameComponent*> m_frameComponents;
 };
\ No newline at end of file
@@ -1,7 +1,22 @@
 set(SOURCEFILES
     ${CMAKE_CURRENT_LIST_DIR}/bm.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/streamDecoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/commandWord.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/messageFilter.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/messageBatch.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/messageFormat.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/captureWriter.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/captureIndex.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/captureReader.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/parallelCaptureDecoder.cpp
     ${CMAKE_CURRENT_LIST_DIR}/ui/mainWindow.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/ui/messageListCtrl.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/ui/statisticsListCtrl.cpp
     ${CMAKE_CURRENT_LIST_DIR}/app.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/aimDevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/hardwareDevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/simulatedBus.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/simulatedDevice.cpp
     ${CMAKE_CURRENT_LIST_DIR}/../logger.cpp
 
 )
\ No newline at end of file
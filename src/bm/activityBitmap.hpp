@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Lock-free 2 x 32 x 32 bitmap of Bus/RT/SA activity.
+ *        The decode thread marks bits as messages pass the filter; the UI periodically
+ *        takes the whole bitmap and applies only the items that changed. This replaces a
+ *        UI event per message with at most one update per item per UI refresh.
+ *        mark() must only be called from one thread; take() may run on any thread.
+ */
+class ActivityBitmap {
+public:
+    static constexpr int BITS = 2 * 32 * 32;
+    static constexpr int WORDS = BITS / 64;
+    using Snapshot = std::array<uint64_t, WORDS>;
+
+    static int bitIndex(int busIdx, int rt, int sa) { return (busIdx << 10) | (rt << 5) | sa; }
+
+    /**
+     * @brief Marks a Bus/RT/SA as active. Marks of an already pending bit are counted as suppressed.
+     */
+    void mark(int busIdx, int rt, int sa) {
+        const int bit = bitIndex(busIdx, rt, sa);
+        std::atomic<uint64_t>& word = m_words[bit >> 6];
+        const uint64_t mask = uint64_t(1) << (bit & 63);
+        // Single writer: plain load/store on the counters avoids a locked instruction per message.
+        m_marks.store(m_marks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (word.load(std::memory_order_relaxed) & mask) {
+            m_suppressed.store(m_suppressed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        word.fetch_or(mask, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Atomically takes all pending bits, leaving the bitmap empty.
+     * @param out Receives the pending bits.
+     * @return True if any bit was set.
+     */
+    bool take(Snapshot& out) {
+        bool any = false;
+        for (int i = 0; i < WORDS; ++i) {
+            out[i] = m_words[i].load(std::memory_order_relaxed) ? m_words[i].exchange(0, std::memory_order_relaxed) : 0;
+            any = any || out[i] != 0;
+        }
+        return any;
+    }
+
+    void clear() { for (auto& w : m_words) w.store(0, std::memory_order_relaxed); }
+    uint64_t marks() const { return m_marks.load(std::memory_order_relaxed); }
+    uint64_t suppressed() const { return m_suppressed.load(std::memory_order_relaxed); }
+    void resetCounters() { m_marks.store(0); m_suppressed.store(0); }
+
+private:
+    std::array<std::atomic<uint64_t>, WORDS> m_words{};
+    std::atomic<uint64_t> m_marks{0};
+    std::atomic<uint64_t> m_suppressed{0};
+};
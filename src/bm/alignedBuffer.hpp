@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+/**
+ * @brief Fixed-capacity byte buffer aligned to a page boundary, so DMA targets and word
+ *        access never straddle a page or a cache line more than necessary.
+ *        Move-only; reallocate() discards the contents.
+ */
+class AlignedBuffer {
+public:
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t capacity) { reallocate(capacity); }
+
+    /**
+     * @brief Replaces the storage with a new page-aligned block of at least the given size.
+     */
+    void reallocate(size_t capacity) {
+        size_t rounded = (capacity + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+        m_data.reset(rounded ? static_cast<unsigned char*>(::operator new(rounded, std::align_val_t(PAGE_SIZE))) : nullptr);
+        m_capacity = rounded;
+    }
+
+    unsigned char* data() { return m_data.get(); }
+    const unsigned char* data() const { return m_data.get(); }
+    size_t capacity() const { return m_capacity; }
+
+private:
+    struct Deleter {
+        void operator()(unsigned char* p) const { ::operator delete(p, std::align_val_t(PAGE_SIZE)); }
+    };
+    std::unique_ptr<unsigned char, Deleter> m_data;
+    size_t m_capacity = 0;
+};
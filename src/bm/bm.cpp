@@ -1,9 +1,13 @@
 #include "bm.hpp"
+#include "commandWord.hpp"
+#include "common.hpp"
+#include "captureIndex.hpp"
 #include <stdio.h>
 #include <cstring>
 #include <chrono>
-#include <cinttypes>
-#include <sstream>
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
 
 /**
  * @def AIM_CHECK_BM_ERROR
@@ -23,28 +27,6 @@
         return retVal; \
     }
 
-/**
- * @brief Resets the internal state of a MessageTransaction struct.
- *        Called to prepare the struct for assembling the nexta message from the data stream.
- */
-void BM::MessageTransaction::clear() {
-    full_timetag = 0; last_timetag_l_data = 0; last_timetag_h_data = 0;
-    cmd1 = 0; bus1 = 0; cmd1_valid = false;
-    cmd2 = 0; bus2 = 0; cmd2_valid = false;
-    stat1 = 0; stat1_bus = 0; stat1_valid = false;
-    stat2 = 0; stat2_bus = 0; stat2_valid = false;
-    data_words.clear();
-    error_word = 0; error_valid = false;
-}
-
-/**
- * @brief Checks if the transaction object is empty.
- * @return True if no valid command, error, or data has been added, false otherwise.
- */
-bool BM::MessageTransaction::isEmpty() const {
-    return !cmd1_valid && !error_valid && full_timetag == 0 && data_words.empty();
-}
-
 /**
  * @brief Converts an AIM API error code into a human-readable string.
  * @param errorCode The AiReturn value from an API call.
@@ -67,66 +49,148 @@ BM& BM::getInstance() {
 
 /**
  * @brief Constructor for the Bus Monitor (BM) singleton.
- *        Initializes member variables and resizes the data reception buffer.
+ *        Initializes member variables, preallocates a page-aligned buffer for every slot of the raw data ring and
+ *        takes the first message batch from the pool.
  *        Private to enforce the singleton pattern.
  */
-BM::BM() : m_ulModHandle(0), m_monitoringActive(false), m_shutdownRequested(false),
+BM::BM() : m_monitoringActive(false), m_acquisitionDone(false), m_shutdownRequested(false),
            m_dataLoggingEnabled(false), 
-           m_guiUpdateMessagesCb(nullptr), m_guiUpdateTreeItemCb(nullptr),
-           m_filterEnabled(false), m_filterBus(0), m_filterRt(-1), m_filterSa(-1),
-           m_filterMc(-1),
-           m_dataQueueId(0)
+           m_filter(std::make_shared<const MessageFilter>()), m_filterGeneration(0),
+           m_decodeFilter(m_filter), m_decodeFilterGeneration(0),
+           m_cardFilterGeneration(0), m_cardFilterActive(false),
+           m_dataQueueId(0), m_minReadBytes(DEFAULT_MIN_READ_BYTES), m_maxReadBytes(DEFAULT_MAX_READ_BYTES), m_rawRing(RX_RING_SLOTS), m_dataQueueBytes(0), m_dataQueueBytesPerSec(0),
+           m_batchPool(MessageBatchPool::create(MESSAGE_BATCH_CAPACITY, MESSAGE_BATCH_POOL_SIZE)),
+           m_displayQueue(DISPLAY_QUEUE_MAX_BATCHES)
 {
-    m_rxDataBuffer.resize(RX_BUFFER_CHUNK_SIZE);
+    m_pendingBatch = m_batchPool->acquire();
+    for (auto& chunk : m_rawRing.slots()) { chunk.data.reallocate(m_maxReadBytes); }
 }
 
 /**
  * @brief Destructor for the Bus Monitor (BM) singleton.
- *        Ensures that monitoring is stopped, the board is shut down, and the
- *        AIM API is properly exited to release all resources.
+ *        Ensures that monitoring is stopped and the board is shut down; closing the last
+ *        hardware device also exits the AIM API library.
  */
 BM::~BM() {
     if (isMonitoring()) { stop(); }
     shutdownBoard(); 
-    ApiExit();
 }
 
 /**
- * @brief Initializes the AIM hardware board and resets it to a known state.
- *        This function performs the initial handshake with the API library and the hardware,
- *        making it ready for configuration.
- * @param config UI-provided configuration containing device and stream identifiers.
+ * @brief Opens the board on the configured device backend (AIM hardware or the simulator) and resets
+ *        it to a known state, making it ready for configuration.
+ * @param config UI-provided configuration containing the backend, device and stream identifiers.
  * @return API_OK on success, or an AIM error code on failure.
  */
 AiReturn BM::initializeBoard(const ConfigBmUi& config) {
-    AiReturn ret = API_OK; static bool apiLibraryInitialized = false;
-    if (!apiLibraryInitialized) { ret = ApiInit(); if (ret <= 0) return ret < 0 ? (AiReturn)ret : API_ERR_NAK; apiLibraryInitialized = true; }
-    TY_API_OPEN xApiOpen; memset(&xApiOpen, 0, sizeof(xApiOpen)); xApiOpen.ul_Module = config.ulDevice; xApiOpen.ul_Stream = config.ulStream; strcpy(xApiOpen.ac_SrvName, "local"); 
-    ret = ApiOpenEx(&xApiOpen, &m_ulModHandle); if (ret != API_OK) { m_ulModHandle = 0; return ret; }
+    AiReturn ret = API_OK;
+    if (!m_device || config.deviceBackend != m_device->backendName()) m_device = AimDevice::create(config.deviceBackend, Common::getConfigPath());
+    ret = m_device->open(config.ulDevice, config.ulStream); if (ret != API_OK) return ret;
     TY_API_RESET_INFO xApiResetInfo; memset(&xApiResetInfo, 0, sizeof(xApiResetInfo));
-    ret = ApiCmdReset(m_ulModHandle, (AiUInt8)config.ulStream, API_RESET_ALL, &xApiResetInfo);
-    if (ret != API_OK) { ApiClose(m_ulModHandle); m_ulModHandle = 0; return ret; }
+    ret = m_device->reset((AiUInt8)config.ulStream, API_RESET_ALL, &xApiResetInfo);
+    if (ret != API_OK) { m_device->close(); return ret; }
+    TY_API_BOARD_INFO xBoardInfo; memset(&xBoardInfo, 0, sizeof(xBoardInfo));
+    if (m_device->getBoardInfo(&xBoardInfo) == API_OK) { m_boardSerial = xBoardInfo.ul_SerialNumber; m_boardType = xBoardInfo.ul_DeviceType; }
+    Logger::info(std::string("BM device backend: ") + m_device->backendName());
     return API_OK;
 }
 
 /**
  * @brief Closes the handle to the AIM board, releasing it for other applications.
  */
-void BM::shutdownBoard() { if (m_ulModHandle != 0) { ApiClose(m_ulModHandle); m_ulModHandle = 0; } }
+void BM::shutdownBoard() { if (m_device) m_device->close(); }
 
 /**
  * @brief Configures the board specifically for Bus Monitor (BM) operations.
- *        Sets coupling, initializes the BM core, and sets the capture mode to continuous recording.
+ *        Sets coupling, initializes the BM core and programs the capture mode (see programCardFilter()):
+ *        API_BM_CAPMODE_FILTER with per-RT ApiCmdBMFilterIni masks when card filtering is active,
+ *        otherwise continuous recording.
  * @param config UI-provided configuration specifying the coupling mode.
  * @return API_OK on success, or an AIM error code on failure.
  */
 AiReturn BM::configureBusMonitor(const ConfigBmUi& config) {
     AiReturn ret = API_OK;
-    ret = ApiCmdCalCplCon(m_ulModHandle, (AiUInt8)config.ulStream, API_CAL_BUS_PRIMARY, config.ulCoupling); AIM_CHECK_BM_ERROR(ret, "configureBusMonitor/ApiCmdCalCplCon Primary", this);
-    ret = ApiCmdCalCplCon(m_ulModHandle, (AiUInt8)config.ulStream, API_CAL_BUS_SECONDARY, config.ulCoupling); AIM_CHECK_BM_ERROR(ret, "configureBusMonitor/ApiCmdCalCplCon Secondary", this);
-    ret = ApiCmdBMIni(m_ulModHandle, (AiUInt8)config.ulStream); AIM_CHECK_BM_ERROR(ret, "configureBusMonitor/ApiCmdBMIni", this);
-    TY_API_BM_CAP_SETUP bmCapSetup; memset(&bmCapSetup, 0, sizeof(bmCapSetup)); bmCapSetup.cap_mode = API_BM_CAPMODE_RECORDING; 
-    ret = ApiCmdBMCapMode(m_ulModHandle, (AiUInt8)config.ulStream, &bmCapSetup); AIM_CHECK_BM_ERROR(ret, "configureBusMonitor/ApiCmdBMCapMode", this);
+    ret = m_device->calCplCon((AiUInt8)config.ulStream, API_CAL_BUS_PRIMARY, config.ulCoupling); AIM_CHECK_BM_ERROR(ret, "configureBusMonitor/ApiCmdCalCplCon Primary", this);
+    ret = m_device->calCplCon((AiUInt8)config.ulStream, API_CAL_BUS_SECONDARY, config.ulCoupling); AIM_CHECK_BM_ERROR(ret, "configureBusMonitor/ApiCmdCalCplCon Secondary", this);
+    ret = m_device->bmIni((AiUInt8)config.ulStream); AIM_CHECK_BM_ERROR(ret, "configureBusMonitor/ApiCmdBMIni", this);
+    m_cardFilterGeneration = m_filterGeneration.load(std::memory_order_acquire);
+    m_cardHaltedForFilter = false;
+    return programCardFilter(*std::atomic_load(&m_filter));
+}
+
+/**
+ * @brief Selects the BM capture mode for a filter. If card filtering is enabled and the filter
+ *        narrows the RT/SA selection, only matching messages are captured by the card
+ *        (API_BM_CAPMODE_FILTER), which cuts DMA and host decoding in proportion. Otherwise
+ *        everything is recorded. The host filter is applied to captured messages in both cases.
+ *        The monitor must not be running.
+ * @param filter The filter to derive the card selection from.
+ * @return API_OK on success, or an AIM error code on failure.
+ */
+AiReturn BM::programCardFilter(const MessageFilter& filter) {
+    AiReturn ret = API_OK;
+    MessageFilter::CardFilter card;
+    bool useCardFilter = m_currentConfig.cardFiltering && filter.cardFilter(card);
+    TY_API_BM_CAP_SETUP bmCapSetup; memset(&bmCapSetup, 0, sizeof(bmCapSetup)); bmCapSetup.cap_mode = useCardFilter ? API_BM_CAPMODE_FILTER : API_BM_CAPMODE_RECORDING;
+    ret = m_device->bmCapMode((AiUInt8)m_currentConfig.ulStream, &bmCapSetup); AIM_CHECK_BM_ERROR(ret, "programCardFilter/ApiCmdBMCapMode", this);
+    if (useCardFilter) { ret = programFilterMasks(card); if (ret != API_OK) return ret; }
+    m_cardFilterActive.store(useCardFilter);
+    Logger::info(useCardFilter ? "BM card filtering enabled for filter: " + filter.expression() : std::string("BM card filtering off, recording all messages"));
+    return API_OK;
+}
+
+/**
+ * @brief Writes the per-RT subaddress and mode code masks of API_BM_CAPMODE_FILTER with ApiCmdBMFilterIni.
+ *        The card takes new masks while the monitor runs; only the capture mode needs a halt.
+ * @param card The masks, one entry per RT.
+ * @return API_OK on success, or an AIM error code on failure.
+ */
+AiReturn BM::programFilterMasks(const MessageFilter::CardFilter& card) {
+    AiReturn ret = API_OK;
+    for (AiUInt8 rt = 0; rt < card.size(); ++rt) {
+        ret = m_device->bmFilterIni((AiUInt8)m_currentConfig.ulStream, rt, card[rt].rxSa, card[rt].txSa, card[rt].rxMc, card[rt].txMc); AIM_CHECK_BM_ERROR(ret, "programFilterMasks/ApiCmdBMFilterIni", this);
+    }
+    return API_OK;
+}
+
+/**
+ * @brief Called on the acquisition thread: reprograms the card when the UI published a new filter.
+ *        While the capture mode stays the same, only the masks are rewritten and the monitor keeps running.
+ *        Switching between filtered and full recording needs the monitor halted: the queue is drained first,
+ *        so everything captured before the halt is delivered, then the mode is switched and the monitor restarted.
+ *        The traffic missed in between is reported as a GAP_RECONFIGURE gap before the next chunk.
+ *        Keeping all card access on this thread avoids API calls racing with ApiCmdDataQueueRead.
+ * @param queueEmpty True if the previous data-queue read left nothing queued on the card.
+ * @param pendingGapReason Receives GAP_RECONFIGURE when the monitor is restarted.
+ * @return API_OK, or the AIM error of a failed halt or restart, which ends acquisition.
+ */
+AiReturn BM::updateCardFilter(bool queueEmpty, AiUInt8& pendingGapReason) {
+    AiReturn ret = API_OK;
+    if (!m_cardHaltedForFilter) {
+        uint64_t generation = m_filterGeneration.load(std::memory_order_acquire);
+        if (generation == m_cardFilterGeneration) return API_OK;
+        m_cardFilterGeneration = generation;
+        std::shared_ptr<const MessageFilter> filter = std::atomic_load(&m_filter);
+        MessageFilter::CardFilter card;
+        bool wanted = m_currentConfig.cardFiltering && filter->cardFilter(card);
+        if (wanted == m_cardFilterActive.load()) {
+            if (!wanted) return API_OK;
+            if (programFilterMasks(card) != API_OK) { Logger::warn("BM card filter masks could not be updated; host filtering continues."); return API_OK; }
+            Logger::info("BM card filter updated for filter: " + filter->expression());
+            return API_OK;
+        }
+        ret = m_device->bmHalt((AiUInt8)m_currentConfig.ulStream); AIM_CHECK_BM_ERROR(ret, "updateCardFilter/ApiCmdBMHalt", this);
+        m_cardHaltedForFilter = true;
+        return API_OK;
+    }
+    if (!queueEmpty) return API_OK;
+    m_cardFilterGeneration = m_filterGeneration.load(std::memory_order_acquire);
+    if (programCardFilter(*std::atomic_load(&m_filter)) != API_OK) { Logger::warn("BM card filter could not be programmed; host filtering continues."); }
+    ret = m_device->bmStart((AiUInt8)m_currentConfig.ulStream); AIM_CHECK_BM_ERROR(ret, "updateCardFilter/ApiCmdBMStart", this);
+    m_cardHaltedForFilter = false;
+    pendingGapReason |= GAP_RECONFIGURE;
+    m_lossGaps.fetch_add(1, std::memory_order_relaxed);
+    Logger::warn("BM data loss: monitor halted to switch capture mode, traffic during the switch was not recorded");
     return API_OK;
 }
 
@@ -139,43 +203,169 @@ AiReturn BM::openDataQueue() {
     AiReturn ret = API_OK;
     m_dataQueueId = (m_currentConfig.ulStream == 1) ? API_DATA_QUEUE_ID_BM_REC_BIU1 : API_DATA_QUEUE_ID_BM_REC_BIU2;
     AiUInt32 queueSizeOnCard = 0;
-    ret = ApiCmdDataQueueOpen(m_ulModHandle, m_dataQueueId, &queueSizeOnCard); AIM_CHECK_BM_ERROR(ret, "openDataQueue/ApiCmdDataQueueOpen", this);
+    ret = m_device->dataQueueOpen(m_dataQueueId, &queueSizeOnCard); AIM_CHECK_BM_ERROR(ret, "openDataQueue/ApiCmdDataQueueOpen", this);
     if (queueSizeOnCard == 0) return API_ERR_NAK;
-    ret = ApiCmdDataQueueControl(m_ulModHandle, m_dataQueueId, API_DATA_QUEUE_CTRL_MODE_START); AIM_CHECK_BM_ERROR(ret, "openDataQueue/ApiCmdDataQueueControl START", this);
+    ret = m_device->dataQueueControl(m_dataQueueId, API_DATA_QUEUE_CTRL_MODE_START); AIM_CHECK_BM_ERROR(ret, "openDataQueue/ApiCmdDataQueueControl START", this);
     return API_OK;
 }
 
 /**
  * @brief Stops and closes the hardware data queue.
  */
-void BM::closeDataQueue() { if (m_ulModHandle != 0 && m_dataQueueId != 0) { ApiCmdDataQueueControl(m_ulModHandle, m_dataQueueId, API_DATA_QUEUE_CTRL_MODE_STOP); ApiCmdDataQueueClose(m_ulModHandle, m_dataQueueId); m_dataQueueId = 0; } }
+void BM::closeDataQueue() { if (boardOpen() && m_dataQueueId != 0) { m_device->dataQueueControl(m_dataQueueId, API_DATA_QUEUE_CTRL_MODE_STOP); m_device->dataQueueClose(m_dataQueueId); m_dataQueueId = 0; } }
+
+/**
+ * @brief Applies the configured data-queue read size bounds, rounded to powers of two in [4 KiB, 1 MiB].
+ *        The ring slots are reallocated only when the maximum changes; the threads are not running here.
+ * @param config The configuration from the user interface; zero bounds select the defaults.
+ */
+void BM::configureReadSizes(const ConfigBmUi& config) {
+    auto normalize = [](AiUInt32 bytes, AiUInt32 fallback) {
+        if (bytes == 0) bytes = fallback;
+        AiUInt32 rounded = AlignedBuffer::PAGE_SIZE;
+        while (rounded < bytes && rounded < READ_BYTES_LIMIT) rounded <<= 1;
+        return rounded;
+    };
+    AiUInt32 maxBytes = normalize(config.maxReadBytes, DEFAULT_MAX_READ_BYTES);
+    m_minReadBytes = std::min(normalize(config.minReadBytes, DEFAULT_MIN_READ_BYTES), maxBytes);
+    if (maxBytes != m_maxReadBytes) {
+        m_maxReadBytes = maxBytes;
+        for (auto& chunk : m_rawRing.slots()) { chunk.data.reallocate(m_maxReadBytes); }
+    }
+    Logger::info("BM data queue reads: " + std::to_string(m_minReadBytes) + " to " + std::to_string(m_maxReadBytes) + " bytes");
+}
+
+/**
+ * @brief Chooses the size of the next data-queue read from the card's backlog.
+ *        A small backlog gets a small read, so data is handed to the decoder as soon as it arrives;
+ *        a growing backlog gets larger reads, so the queue is drained with fewer calls.
+ * @param bytesInQueue The backlog reported by the previous read.
+ * @param minBytes The smallest read, a power of two.
+ * @param maxBytes The largest read, a power of two.
+ * @return The read size in bytes, a power of two in [minBytes, maxBytes].
+ */
+AiUInt32 BM::readSizeFor(AiUInt32 bytesInQueue, AiUInt32 minBytes, AiUInt32 maxBytes) {
+    AiUInt32 size = minBytes;
+    while (size < bytesInQueue && size < maxBytes) size <<= 1;
+    return size;
+}
 
 /**
  * @brief Public entry point to start the entire monitoring process.
- *        Orchestrates board initialization, configuration, and starts the dedicated monitoring thread.
+ *        Orchestrates board initialization, configuration, and starts the acquisition and decode threads.
  * @param config The complete configuration from the user interface.
  * @return API_OK if monitoring started successfully, otherwise an error code.
  */
 AiReturn BM::start(const ConfigBmUi& config) {
     if (m_monitoringActive.load()) return API_OK;
     m_currentConfig = config; m_shutdownRequested.store(false);
+    configureReadSizes(config);
     AiReturn ret = initializeBoard(m_currentConfig); if (ret != API_OK) return ret;
     ret = configureBusMonitor(m_currentConfig); if (ret != API_OK) { shutdownBoard(); return ret; }
     ret = openDataQueue(); if (ret != API_OK) { shutdownBoard(); return ret; }
-    ret = ApiCmdBMStart(m_ulModHandle, (AiUInt8)m_currentConfig.ulStream);
-    if (ret != API_OK) { closeDataQueue(); shutdownBoard(); return ret; }
-    m_monitoringActive.store(true); m_monitorThread = std::thread(&BM::monitorThreadFunc, this);
+    installInterrupts();
+    ret = m_device->bmStart((AiUInt8)m_currentConfig.ulStream);
+    if (ret != API_OK) { removeInterrupts(); closeDataQueue(); shutdownBoard(); return ret; }
+    resetPipeline();
+    if (m_dataLoggingEnabled.load()) openCapture();
+    m_monitoringActive.store(true);
+    m_decodeThread = std::thread(&BM::decodeThreadFunc, this);
+    m_acquisitionThread = std::thread(&BM::acquisitionThreadFunc, this);
     return API_OK;
 }
 
+/**
+ * @brief Clears the per-run counters and the state of the ring, decoder, activity and display queue
+ *        before the threads of a new run are started.
+ */
+void BM::resetPipeline() {
+    m_latency.reset(); m_latencyBase.reset(); m_interrupts.store(0); m_acquisitionWaits.store(0); m_wakePending = false;
+    m_rawRing.reset(); m_decoder.reset(); m_activity.clear(); m_activity.resetCounters(); m_statistics.reset(); m_displayQueue.reset(); m_dataQueueBytes.store(0); m_dataQueueBytesPerSec.store(0); m_dataQueueReads.store(0); m_largestRead.store(0); m_ringStallNs.store(0); m_acquisitionDone.store(false); m_acquisitionError.store(API_OK); m_replayEpoch.store(0); m_decodeEpoch.store(0);
+}
+
+/**
+ * @brief Starts replaying a capture file through the decode, filter and display pipeline, without a card.
+ *        Playback starts in real time at the beginning of the capture; see setReplaySpeed(), pauseReplay()
+ *        and seekReplay(). It ends with stop(), like monitoring; at the end of the file the replay waits
+ *        for a seek or stop. Nothing is recorded while replaying.
+ * @param capturePath The capture file (see CaptureFormat).
+ * @param error Receives the reason if the capture cannot be opened or the monitor is running.
+ * @return True if the replay started.
+ */
+bool BM::startReplay(const std::string& capturePath, std::string& error) {
+    if (m_monitoringActive.load()) { error = "the Bus Monitor is already running"; return false; }
+    if (!m_replayReader.open(capturePath, error)) return false;
+    const CaptureFormat::FileHeader& header = m_replayReader.header();
+    m_currentConfig = ConfigBmUi{}; m_currentConfig.ulDevice = header.device; m_currentConfig.ulStream = header.stream; m_currentConfig.ulCoupling = static_cast<AiUInt8>(header.coupling);
+    m_shutdownRequested.store(false);
+    configureReadSizes(m_currentConfig);
+    resetPipeline();
+    m_replayPath = capturePath;
+    m_replayPaused.store(false); m_replayAtEnd.store(false); m_replaySeekable.store(false); m_replaySeekNs.store(-1);
+    m_replayPositionNs.store(0); m_replayDurationNs.store(0);
+    m_replaying.store(true);
+    Logger::info("BM replay started: " + capturePath + ((header.flags & CaptureFormat::FLAG_CARD_FILTER) ? " (recorded with card filtering)" : ""));
+    m_monitoringActive.store(true);
+    m_decodeThread = std::thread(&BM::decodeThreadFunc, this);
+    m_acquisitionThread = std::thread(&BM::replayThreadFunc, this);
+    return true;
+}
+
+/**
+ * @brief Returns true from startReplay() until stop(), including while paused or at the end of the file.
+ */
+bool BM::isReplaying() const { return m_replaying.load(); }
+
+/**
+ * @brief Sets the replay speed: 1 is real time, N is N times faster, 0 replays as fast as the pipeline allows.
+ */
+void BM::setReplaySpeed(double speed) { m_replaySpeed.store(speed > 0 ? speed : 0.0); }
+
+/**
+ * @brief Pauses or resumes the replay. Messages already read from the file are still decoded and displayed.
+ */
+void BM::pauseReplay(bool pause) { m_replayPaused.store(pause); }
+
+/**
+ * @brief Moves the replay to a time in the capture, using the capture index. Playback continues from the
+ *        start of the index entry holding that time, so up to one entry before it is replayed again.
+ *        Messages still in the pipeline from the old position are discarded once the seek is made; batches
+ *        from the new position carry the next replay seek epoch (see BmPipelineStats::replaySeekEpoch).
+ *        Ignored while the index is not loaded (see BmPipelineStats::replaySeekable).
+ * @param offsetNs The time from the start of the capture.
+ */
+void BM::seekReplay(uint64_t offsetNs) { m_replaySeekNs.store(static_cast<int64_t>(offsetNs)); }
+
 /**
  * @brief Public entry point to stop the monitoring process.
- *        Signals the monitoring thread to terminate, joins it, and de-initializes hardware resources.
+ *        Signals the acquisition thread to terminate, lets the decode thread drain the ring,
+ *        joins both, and de-initializes hardware resources.
  */
 void BM::stop() {
-    m_shutdownRequested.store(true); if (m_monitorThread.joinable()) { m_monitorThread.join(); }
-    if (m_ulModHandle != 0) { ApiCmdBMHalt(m_ulModHandle, (AiUInt8)m_currentConfig.ulStream); closeDataQueue(); }
+    m_shutdownRequested.store(true);
+    m_wakeCv.notify_one();
+    if (m_acquisitionThread.joinable()) { m_acquisitionThread.join(); }
+    if (m_decodeThread.joinable()) { m_decodeThread.join(); }
+    closeCapture();
+    if (m_replaying.load()) { m_replayReader.close(); m_replaying.store(false); Logger::info("BM replay stopped: " + m_replayPath); }
+    if (boardOpen()) { m_device->bmHalt((AiUInt8)m_currentConfig.ulStream); removeInterrupts(); closeDataQueue(); }
     shutdownBoard(); m_monitoringActive.store(false); 
+    BmPipelineStats stats = getPipelineStats();
+    Logger::info("BM data queue: " + std::to_string(stats.dataQueueBytes) + " bytes in " + std::to_string(stats.dataQueueReads) +
+                 " reads (largest " + std::to_string(stats.largestReadBytes) + " bytes)" + (stats.cardFilterActive ? " with card filtering" : "") +
+                 "; lifetime data loss: " + std::to_string(stats.lossGaps) + " gaps, " + std::to_string(stats.lostBytes) + " bytes");
+    Logger::info("BM acquisition: " + std::to_string(stats.acquisitionWaits) + " waits, " + std::to_string(stats.interrupts) +
+                 " interrupts; card-to-decoder latency (relative to the fastest delivery in " +
+                 std::to_string(OffsetWindowMin::WINDOW_SECONDS) + " s windows) p50 " + std::to_string(stats.latencyP50Us) + " us, p99 " +
+                 std::to_string(stats.latencyP99Us) + " us over " + std::to_string(stats.latencySamples) + " samples");
+    Logger::info("BM raw ring: capacity " + std::to_string(stats.ringCapacity) + " chunks, high-water mark " +
+                 std::to_string(stats.ringHighWaterMark) + ", full " + std::to_string(stats.ringFullEpisodes) +
+                 " times, acquisition stalled " + std::to_string(stats.ringStallMs) + " ms");
+    Logger::info("BM tree activity: " + std::to_string(stats.activityMarks) + " marks, " +
+                 std::to_string(stats.activitySuppressed) + " redundant UI updates suppressed");
+    Logger::info("BM display queue: " + std::to_string(stats.displayQueuedMessages) + " messages queued, " +
+                 std::to_string(stats.displayDroppedMessages) + " dropped in " + std::to_string(stats.displayDroppedBatches) +
+                 " batches, high-water mark " + std::to_string(stats.displayHighWaterMark) + " batches");
 }
 
 /**
@@ -185,259 +375,575 @@ void BM::stop() {
 bool BM::isMonitoring() const { return m_monitoringActive.load(); }
 
 /**
- * @brief Registers a callback function for updating the UI message display.
- * @param cb A std::function to be called with formatted message strings.
+ * @brief Reports why the acquisition thread ended on its own. The run stays active, and the board open,
+ *        until stop() is called, so the caller can tell a card failure from a normal stop.
+ * @return API_OK while acquisition is running or after a normal stop, otherwise the AIM error that ended it.
+ */
+AiReturn BM::acquisitionError() const { return m_acquisitionError.load(); }
+
+/**
+ * @brief Takes the message batches queued for display since the previous call.
+ *        Called by the UI once per refresh frame; the decode thread never waits for it.
+ * @param out Receives the batches, oldest first.
+ * @return The number of batches taken.
+ */
+size_t BM::takeDisplayBatches(std::vector<MessageBatch>& out) { return m_displayQueue.drain(out); }
+
+/**
+ * @brief Takes the Bus/RT/SA activity accumulated since the previous call.
+ *        Called periodically by the UI to refresh its tree view in one pass.
+ * @param out Receives one bit per Bus/RT/SA that carried an accepted message.
+ * @return True if any item was active.
  */
-void BM::setUpdateMessagesCallback(UpdateMessagesCallback cb) { m_guiUpdateMessagesCb = cb; }
+bool BM::takeActivity(ActivityBitmap::Snapshot& out) { return m_activity.take(out); }
 
 /**
- * @brief Registers a callback function for updating the UI tree view.
- * @param cb A std::function to be called with active bus/RT/SA information.
+ * @brief Copies the per Bus/RT/SA counters of the current run, one row per terminal that has been seen.
+ *        Safe to call from the UI while the decode thread keeps counting.
+ * @param out Receives the rows; its capacity is reused.
  */
-void BM::setUpdateTreeItemCallback(UpdateTreeItemCallback cb) { m_guiUpdateTreeItemCb = cb; }
+void BM::getStatistics(std::vector<BusStatistics::Row>& out) const { m_statistics.snapshot(out); }
 
 /**
- * @brief The main function for the dedicated monitoring thread.
- *        Continuously polls the data queue for new monitor data and triggers processing.
- *        This loop is the heart of the real-time data acquisition.
+ * @brief The main function for the dedicated acquisition thread.
+ *        Only drains the card's data queue into preallocated slots of the raw ring so the
+ *        on-card queue never waits behind decoding or formatting. If the ring is full the
+ *        read is postponed (counted once per full-ring episode, and the time stalled), leaving the data buffered on the card.
+ *        Reads back to back while the card reports queued data; when the queue is empty it sleeps
+ *        until the BM interrupt fires or an exponentially growing backoff (ACQ_BACKOFF_MIN..MAX) expires.
+ *        Overflow/error bits in the queue status and any shortfall against the driver's byte total are
+ *        counted as data loss and attached to the next chunk, where the decode thread inserts a gap marker.
+ *        A new filter is applied to the card between reads (see updateCardFilter()).
  */
-void BM::monitorThreadFunc() {
+void BM::acquisitionThreadFunc() {
     TY_API_DATA_QUEUE_READ queueReadParams; TY_API_DATA_QUEUE_STATUS queueStatus; AiReturn ret;
+    auto rateStart = std::chrono::steady_clock::now(); uint64_t rateStartBytes = 0;
+    auto backoff = ACQ_BACKOFF_MIN;
+    AiUInt32 bytesInQueue = 0;
+    // Loss accounting: the driver's running byte total is compared with what this thread received.
+    bool driverBaseValid = false; uint64_t driverBase = 0, lostByCount = 0;
+    AiUInt32 pendingLostBytes = 0; AiUInt8 pendingGapReason = 0, lastStatusReason = 0;
+    bool stalled = false; std::chrono::steady_clock::time_point stallStart;
     while (!m_shutdownRequested.load()) {
-        if (m_ulModHandle == 0) break;
+        if (!boardOpen()) { m_acquisitionError.store(API_ERR_NAK); break; }
+        updateQueueRate(rateStart, rateStartBytes);
+        RawChunk* chunk = m_rawRing.beginWrite();
+        if (!chunk) {
+            if (!stalled) { stalled = true; stallStart = std::chrono::steady_clock::now(); }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        if (stalled) {
+            stalled = false;
+            m_ringStallNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - stallStart).count(), std::memory_order_relaxed);
+        }
         memset(&queueReadParams, 0, sizeof(queueReadParams));
-        queueReadParams.id = m_dataQueueId; queueReadParams.buffer = m_rxDataBuffer.data(); queueReadParams.bytes_to_read = RX_BUFFER_CHUNK_SIZE;
+        queueReadParams.id = m_dataQueueId; queueReadParams.buffer = chunk->data.data();
+        queueReadParams.bytes_to_read = readSizeFor(bytesInQueue, m_minReadBytes, m_maxReadBytes);
         memset(&queueStatus, 0, sizeof(queueStatus));
-        ret = ApiCmdDataQueueRead(m_ulModHandle, &queueReadParams, &queueStatus);
-        if (ret == API_ERR_TIMEOUT) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); continue; }
-        if (ret != API_OK) break;
-        if (queueStatus.bytes_transfered > 0) { processAndRelayData(m_rxDataBuffer.data(), queueStatus.bytes_transfered); } 
-        else { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }
+        ret = m_device->dataQueueRead(&queueReadParams, &queueStatus);
+        if (ret != API_OK && ret != API_ERR_TIMEOUT) {
+            Logger::error("BM acquisition stopped: ApiCmdDataQueueRead failed: " + getAIMApiErrorMessage(ret));
+            m_acquisitionError.store(ret);
+            break;
+        }
+        bytesInQueue = (ret == API_OK) ? queueStatus.bytes_in_queue : 0;
+        if (ret == API_OK) {
+            // Status bits may stay set after an overflow; only a newly raised bit starts a new gap.
+            AiUInt8 statusReason = gapReasonFor(queueStatus.status);
+            AiUInt8 reason = statusReason & static_cast<AiUInt8>(~lastStatusReason);
+            lastStatusReason = statusReason;
+            uint64_t received = m_dataQueueBytes.load(std::memory_order_relaxed) + queueStatus.bytes_transfered;
+            uint64_t lostNow = 0;
+            // The first read sets the baseline; a driver total that falls behind it (e.g. a restarted queue) re-bases.
+            uint64_t total = queueStatus.total_bytes_transfered;
+            if (total >= received) {
+                if (!driverBaseValid || total < driverBase + received) { driverBase = total - received; driverBaseValid = true; lostByCount = 0; }
+                uint64_t lost = total - driverBase - received;
+                if (lost > lostByCount) { lostNow = lost - lostByCount; lostByCount = lost; reason |= GAP_BYTE_COUNT; }
+            }
+            if (reason != 0) {
+                m_lossGaps.fetch_add(1, std::memory_order_relaxed);
+                m_lostBytes.fetch_add(lostNow, std::memory_order_relaxed);
+                pendingLostBytes += static_cast<AiUInt32>(lostNow); pendingGapReason |= reason;
+                char statusHex[16]; snprintf(statusHex, sizeof(statusHex), "0x%08X", queueStatus.status);
+                Logger::warn(std::string("BM data loss: data queue status ") + statusHex + ", " + std::to_string(lostNow) + " bytes missing");
+            }
+        }
+        if (ret == API_OK && queueStatus.bytes_transfered > 0) {
+            chunk->bytes = queueStatus.bytes_transfered;
+            chunk->lostBytesBefore = pendingLostBytes; chunk->gapReasonBefore = pendingGapReason;
+            chunk->cardFiltered = m_cardFilterActive.load();
+            chunk->epoch = 0;
+            chunk->hostTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            pendingLostBytes = 0; pendingGapReason = 0;
+            m_rawRing.commitWrite();
+            m_dataQueueBytes.fetch_add(queueStatus.bytes_transfered, std::memory_order_relaxed);
+            m_dataQueueReads.fetch_add(1, std::memory_order_relaxed);
+            if (queueStatus.bytes_transfered > m_largestRead.load(std::memory_order_relaxed)) m_largestRead.store(queueStatus.bytes_transfered, std::memory_order_relaxed);
+        }
+        // After this read, so a halted monitor is restarted only once the queue is known to be drained.
+        AiReturn filterRet = updateCardFilter(bytesInQueue == 0, pendingGapReason);
+        if (filterRet != API_OK) {
+            Logger::error("BM acquisition stopped: switching the capture mode failed: " + getAIMApiErrorMessage(filterRet));
+            m_acquisitionError.store(filterRet);
+            break;
+        }
+        // More data already waiting on the card: read it right away. Otherwise wait for the BM
+        // interrupt or the backoff delay, which grows while the queue stays empty.
+        if (bytesInQueue > 0) { backoff = ACQ_BACKOFF_MIN; continue; }
+        if (ret == API_OK && queueStatus.bytes_transfered > 0) backoff = ACQ_BACKOFF_MIN;
+        else backoff = std::min(backoff * 2, ACQ_BACKOFF_MAX);
+        waitForData(backoff);
     }
-    m_monitoringActive.store(false); 
+    m_acquisitionDone.store(true);
 }
 
 /**
- * @brief Formats a completed message transaction into a human-readable string for the UI.
- *        This function is responsible for creating the final output format, including Time,
- *        Bus, Type, and Data Word sections. It also applies filtering and triggers UI tree updates.
- * @param trans The fully assembled message transaction to be processed.
- * @param outString The output string to which the formatted message will be appended.
- */
-void BM::formatAndRelayTransaction(const MessageTransaction& trans, std::string& outString) {
-    if (!trans.cmd1_valid) return;
-
-    // Apply filtering criteria before any expensive formatting.
-    { 
-        std::lock_guard<std::mutex> lock(m_filterMutex);
-        if (m_filterEnabled.load()) {
-            bool passed = true;
-            char bus_to_check = toupper(m_filterBus.load());
-            int rt_to_check = m_filterRt.load();
-            int sa_to_check = m_filterSa.load();
-            int mc_to_check = m_filterMc.load();
-
-            if (bus_to_check != 0 && toupper(trans.bus1) != bus_to_check) passed = false;
-            if (passed && rt_to_check != -1 && rt_to_check != ((trans.cmd1 >> 11) & 0x1F)) passed = false;
-
-            AiUInt8 sa_or_mc = (trans.cmd1 >> 5) & 0x1F;
-            bool is_mode_code = (sa_or_mc == 0 || sa_or_mc == 31);
-
-            if (passed && sa_to_check != -1) { // Eğer SA filtresi varsa
-                if (is_mode_code || sa_or_mc != sa_to_check) passed = false;
-            } else if (passed && mc_to_check != -1) { // Eğer MC filtresi varsa
-                AiUInt8 wc_field = trans.cmd1 & 0x1F;
-                if (!is_mode_code || wc_field != mc_to_check) passed = false;
-            }
-            
-            if (!passed) return;
+ * @brief Updates the data queue byte rate once a second.
+ * @param since Start of the current measurement interval; moved on when the rate is updated.
+ * @param bytesSince The byte counter at the start of the interval.
+ */
+void BM::updateQueueRate(std::chrono::steady_clock::time_point& since, uint64_t& bytesSince) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - since < std::chrono::seconds(1)) return;
+    uint64_t bytes = m_dataQueueBytes.load(std::memory_order_relaxed);
+    double seconds = std::chrono::duration<double>(now - since).count();
+    m_dataQueueBytesPerSec.store(static_cast<uint64_t>((bytes - bytesSince) / seconds), std::memory_order_relaxed);
+    since = now; bytesSince = bytes;
+}
+
+/**
+ * @brief The main function of the replay thread, which takes the place of the acquisition thread.
+ *        Loads (or first builds) the capture index for seeking, then hands the capture's blocks to the
+ *        raw ring at the times given by their host timestamps, scaled by the replay speed. Pause, seek
+ *        and speed requests are picked up between blocks and while waiting for the next one.
+ */
+void BM::replayThreadFunc() {
+    const CaptureReader& reader = m_replayReader;
+    const uint64_t startNs = reader.header().startHostTimeNs;
+    CaptureIndex index; std::string error;
+    if (index.load(m_replayPath, error) && !index.entries().empty()) {
+        // The capture ends with the last block of the last entry.
+        uint64_t endNs = startNs;
+        const CaptureFormat::IndexEntry& last = index.entries().back();
+        reader.forEachBlock(last.fileOffset, last.endOffset, [&endNs](uint64_t, const CaptureFormat::BlockHeader& block, const AiUInt32*, size_t) { endNs = std::max(endNs, block.hostTimeNs); });
+        m_replayDurationNs.store(endNs - startNs);
+        m_replaySeekable.store(true);
+    } else if (!error.empty()) {
+        Logger::warn("BM replay cannot seek: " + error);
+    }
+
+    ReplayClock clock;
+    CaptureFormat::BlockHeader block;
+    uint64_t offset = reader.firstBlockOffset(), captureTimeNs = startNs, rateStartBytes = 0;
+    auto rateStart = std::chrono::steady_clock::now();
+    bool rebase = true, resync = false;
+    uint32_t epoch = 0;
+    Bm1553StreamDecoder::ResumePoint resume;
+    while (!m_shutdownRequested.load()) {
+        updateQueueRate(rateStart, rateStartBytes);
+        int64_t seekNs = m_replaySeekNs.exchange(-1);
+        if (seekNs >= 0 && !index.entries().empty()) {
+            // Continue from the last entry starting at or before the requested time.
+            const std::vector<CaptureFormat::IndexEntry>& entries = index.entries();
+            auto next = std::upper_bound(entries.begin(), entries.end(), startNs + static_cast<uint64_t>(seekNs),
+                                         [](uint64_t timeNs, const CaptureFormat::IndexEntry& entry) { return timeNs < entry.firstHostTimeNs; });
+            const CaptureFormat::IndexEntry& entry = (next == entries.begin()) ? *next : *(next - 1);
+            offset = entry.fileOffset; captureTimeNs = entry.firstHostTimeNs;
+            resume.timetag = entry.resumeTimetag; resume.timetagHigh = entry.timetagHigh; resume.timetagHighValid = entry.timetagHighValid != 0;
+            resync = true; rebase = true;
+            epoch = m_replayEpoch.fetch_add(1, std::memory_order_release) + 1;
+            m_replayAtEnd.store(false);
+            m_replayPositionNs.store(captureTimeNs - startNs);
         }
-    } 
-
-    // Signal the UI to update its tree view for the active terminal.
-    if (m_guiUpdateTreeItemCb) {
-        AiUInt8 rtAddr1 = (trans.cmd1 >> 11) & 0x1F;
-        AiUInt8 sa_mc1  = (trans.cmd1 >> 5) & 0x1F;
-        if (!(sa_mc1 == 0 || sa_mc1 == 31)) {
-            m_guiUpdateTreeItemCb(trans.bus1, rtAddr1, sa_mc1, true);
+        if (clock.speed() != m_replaySpeed.load()) { clock.setSpeed(m_replaySpeed.load()); rebase = true; }
+        const AiUInt32* words = m_replayAtEnd.load() ? nullptr : reader.blockAt(offset, block);
+        if (m_replayPaused.load() || !words) {
+            // A damaged block ends the replay like the end of the file; a seek starts it again.
+            if (!words && !m_replayAtEnd.exchange(true)) Logger::info("BM replay reached the end of " + m_replayPath);
+            rebase = true;
+            std::this_thread::sleep_for(REPLAY_POLL);
+            continue;
         }
+        auto now = ReplayClock::Clock::now();
+        if (rebase) { clock.rebase(captureTimeNs, now); rebase = false; }
+        auto delay = clock.delayUntil(block.hostTimeNs, now);
+        if (delay > ReplayClock::Clock::duration::zero()) {
+            std::this_thread::sleep_for(std::min<ReplayClock::Clock::duration>(delay, REPLAY_POLL));
+            continue;
+        }
+        if (!replayBlock(block, words, resync, resume, epoch)) break;
+        captureTimeNs = std::max(captureTimeNs, block.hostTimeNs);
+        m_replayPositionNs.store(captureTimeNs - startNs);
+        offset += sizeof(block) + block.payloadBytes;
     }
+    m_acquisitionDone.store(true);
+}
 
-    // Use a stringstream for efficient string building.
-    std::stringstream ss;
-    char tempBuf[256];
-
-    // Format timestamp.
-    if (trans.full_timetag != 0) {
-        uint64_t total_us = trans.full_timetag * 1;
-        snprintf(tempBuf, sizeof(tempBuf), "Time: %010" PRIu64 "us\n", total_us);
-        ss << tempBuf;
-    } else {
-        ss << "Time: <no timestamp>\n";
-    }
+/**
+ * @brief Copies one capture block into raw ring slots, split to the slot size if needed, and waits for
+ *        free slots when the decoder falls behind. The block's gap and a pending seek resync go with its first slot.
+ * @return False if stop was requested before the whole block was handed over.
+ */
+bool BM::replayBlock(const CaptureFormat::BlockHeader& block, const AiUInt32* words, bool& resync, const Bm1553StreamDecoder::ResumePoint& resume, uint32_t epoch) {
+    const unsigned char* payload = reinterpret_cast<const unsigned char*>(words);
+    AiUInt32 done = 0;
+    do {
+        RawChunk* chunk = m_rawRing.beginWrite();
+        if (!chunk) {
+            if (m_shutdownRequested.load()) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        const AiUInt32 bytes = std::min(block.payloadBytes - done, m_maxReadBytes);
+        memcpy(chunk->data.data(), payload + done, bytes);
+        chunk->bytes = bytes;
+        chunk->lostBytesBefore = done == 0 ? block.lostBytesBefore : 0; chunk->gapReasonBefore = done == 0 ? block.gapReason : 0;
+        chunk->cardFiltered = (block.flags & CaptureFormat::BLOCK_FLAG_CARD_FILTER) != 0;
+        chunk->hostTimeNs = block.hostTimeNs;
+        chunk->resync = resync; chunk->resume = resume; resync = false;
+        chunk->epoch = epoch;
+        m_rawRing.commitWrite();
+        m_dataQueueBytes.fetch_add(bytes, std::memory_order_relaxed);
+        m_dataQueueReads.fetch_add(1, std::memory_order_relaxed);
+        if (bytes > m_largestRead.load(std::memory_order_relaxed)) m_largestRead.store(bytes, std::memory_order_relaxed);
+        done += bytes;
+    } while (done < block.payloadBytes);
+    return true;
+}
 
-    // Decode command word to create a summary line.
-    AiUInt8 rt = (trans.cmd1 >> 11) & 0x1F;
-    AiUInt8 tr = (trans.cmd1 >> 10) & 0x01;
-    AiUInt8 sa = (trans.cmd1 >> 5) & 0x1F;
-    AiUInt8 wc_field = trans.cmd1 & 0x1F;
-
-    ss << "Bus: " << trans.bus1 << " Type: ";
-    if (trans.cmd2_valid) { AiUInt8 rt2 = (trans.cmd2 >> 11) & 0x1F; ss << "RT " << (int)rt << " to RT " << (int)rt2; } 
-    else if (tr == 0) { ss << "BC to RT " << (int)rt; } 
-    else { ss << "RT " << (int)rt << " to BC"; }
-
-    if (sa == 0 || sa == 31) { snprintf(tempBuf, sizeof(tempBuf), " MC: %d (Op %d)", (int)sa, (int)wc_field); } 
-    else { snprintf(tempBuf, sizeof(tempBuf), " SA: %d WC: %d", (int)sa, (int)wc_field); }
-    ss << tempBuf;
-
-    if (!trans.stat1_valid) ss << " (No Response)";
-    ss << "\n";
-
-    // Determine the expected number of data words and format them,
-    // using placeholders if the actual data is missing.
-    int words_to_display = 0;
-    bool is_mode_code = (sa == 0 || sa == 31);
-    bool mc_has_data = (is_mode_code && ((tr == 1 && wc_field == 17) || (tr == 0 && wc_field == 16)));
-    
-    if (!is_mode_code || mc_has_data) {
-        words_to_display = (wc_field == 0) ? 32 : wc_field;
-        if (is_mode_code) words_to_display = 1;
+/**
+ * @brief Blocks the acquisition thread until the BM interrupt fires, stop is requested, or the timeout expires.
+ * @param timeout The maximum time to wait.
+ */
+void BM::waitForData(std::chrono::microseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wakeCv.wait_for(lock, timeout, [this] { return m_wakePending || m_shutdownRequested.load(); });
+    m_wakePending = false;
+    m_acquisitionWaits.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief BM interrupt handler installed with ApiInstIntHandler; runs on the driver's interrupt thread.
+ *        Only wakes the acquisition thread, which does the actual reading.
+ */
+void AI_CALL_CONV BM::bmInterruptHandler(AiUInt32, AiUInt8, AiUInt8, TY_API_INTR_LOGLIST_ENTRY*) {
+    BM& bm = BM::getInstance();
+    bm.m_interrupts.fetch_add(1, std::memory_order_relaxed);
+    { std::lock_guard<std::mutex> lock(bm.m_wakeMutex); bm.m_wakePending = true; }
+    bm.m_wakeCv.notify_one();
+}
+
+/**
+ * @brief Enables the BM half-buffer-full interrupt and installs the wakeup handler.
+ *        If the board or driver does not support it, acquisition relies on the adaptive backoff alone.
+ */
+void BM::installInterrupts() {
+    m_interruptsInstalled = false;
+    if (!m_currentConfig.useInterrupts) return;
+    AiReturn ret = m_device->installInterruptHandler((AiUInt8)m_currentConfig.ulStream, API_INT_BM, &BM::bmInterruptHandler);
+    if (ret == API_OK) ret = m_device->bmIntrMode((AiUInt8)m_currentConfig.ulStream, API_BM_MODE_HFI_INT, API_BM_NO_STROBE, 0);
+    if (ret != API_OK) {
+        m_device->deleteInterruptHandler((AiUInt8)m_currentConfig.ulStream, API_INT_BM);
+        Logger::warn("BM interrupts unavailable (" + getAIMApiErrorMessage(ret) + "), using polling with adaptive backoff.");
+        return;
     }
+    m_interruptsInstalled = true;
+}
 
-    if (words_to_display > 0) {
-        ss << "Data: ";
-        for (int i = 0; i < words_to_display; ++i) {
-            if (i < trans.data_words.size()) {
-                snprintf(tempBuf, sizeof(tempBuf), "%04X ", trans.data_words[i]);
-                ss << tempBuf;
-            } else {
-                ss << "0000 ";
-            }
-            
-            // Wrap data words every 8 words for readability.
-            if ((i + 1) % 8 == 0 && (i + 1) < words_to_display) {
-                ss << "\n      ";
-            }
+/**
+ * @brief Disables the BM interrupt and removes the handler, if installed.
+ */
+void BM::removeInterrupts() {
+    if (!m_interruptsInstalled || !boardOpen()) return;
+    m_device->bmIntrMode((AiUInt8)m_currentConfig.ulStream, API_BM_MODE_NO_INT, API_BM_NO_STROBE, 0);
+    m_device->deleteInterruptHandler((AiUInt8)m_currentConfig.ulStream, API_INT_BM);
+    m_interruptsInstalled = false;
+}
+
+/**
+ * @brief The main function for the dedicated decode thread.
+ *        Consumes raw chunks from the ring, hands them to the capture file if one is open, decodes and
+ *        relays them, and returns the slots to the acquisition thread. Keeps draining until acquisition has stopped and the ring is empty.
+ *        A message left open by an idle bus or by stopping is flushed explicitly.
+ */
+void BM::decodeThreadFunc() {
+    int idleMs = 0;
+    while (true) {
+        RawChunk* chunk = m_rawRing.beginRead();
+        if (!chunk) {
+            if (m_acquisitionDone.load()) break;
+            // Once the bus has been quiet for a while the pending message cannot grow any more.
+            if (m_decoder.hasPending() && ++idleMs >= DECODER_IDLE_FLUSH_MS) { processAndRelayData(nullptr, 0); idleMs = 0; }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
         }
-        ss << "\n";
+        idleMs = 0;
+        // Chunks still queued from before a seek belong to the old position and are not shown.
+        if (chunk->epoch != m_replayEpoch.load(std::memory_order_acquire)) { chunk->resync = false; m_rawRing.commitRead(); continue; }
+        m_decodeEpoch.store(chunk->epoch, std::memory_order_release);
+        // After a seek the message in progress belongs to the old position and is dropped.
+        if (chunk->resync) { m_decoder.resume(chunk->resume); chunk->resync = false; }
+        if (chunk->gapReasonBefore != 0) relayGap(chunk->lostBytesBefore, chunk->gapReasonBefore);
+        if (m_capture.isOpen()) m_capture.append(chunk->data.data(), chunk->bytes, chunk->hostTimeNs, chunk->lostBytesBefore, chunk->gapReasonBefore,
+                                              chunk->cardFiltered ? CaptureFormat::BLOCK_FLAG_CARD_FILTER : 0);
+        processAndRelayData(chunk->data.data(), chunk->bytes);
+        m_rawRing.commitRead();
+        // Replayed timetags are old; the card-to-decoder latency only means something live.
+        if (!m_replaying.load(std::memory_order_relaxed)) recordDeliveryLatency();
+    }
+    processAndRelayData(nullptr, 0);
+}
+
+/**
+ * @brief Samples the card-to-decoder latency of the newest decoded message.
+ *        Card and host clocks are not synchronized, so the latency is measured against the smallest
+ *        host-minus-card offset of the last OffsetWindowMin::WINDOW_SECONDS, i.e. relative to the fastest
+ *        recent delivery; the window keeps clock drift from accumulating over a long run.
+ */
+void BM::recordDeliveryLatency() {
+    uint64_t timetag = m_decoder.lastTimetag();
+    if (timetag == 0) return;
+    int64_t hostUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t offset = hostUs - static_cast<int64_t>(timetagMicroseconds(timetag));
+    m_latency.record(static_cast<uint64_t>(offset - m_latencyBase.update(hostUs, offset)));
+}
+
+/**
+ * @brief Decides whether a decoded message goes to the UI.
+ *        Applies the filtering criteria and marks the Bus/RT/SA of accepted messages as active.
+ *        No text is produced here; formatting happens in the UI for the rows it displays.
+ * @param trans The fully assembled message transaction to be processed.
+ * @return True if the message passed the filter.
+ */
+bool BM::acceptTransaction(const MessageTransaction& trans) {
+    if (!trans.cmd1Valid()) return false;
+    const CommandWordDescriptor& cmd = describeCommandWord(trans.header.cmd1);
+
+    // Apply filtering criteria. The snapshot is only re-read after the UI published a new one,
+    // so the common path is a single atomic load and never waits for the UI.
+    uint64_t generation = m_filterGeneration.load(std::memory_order_acquire);
+    if (generation != m_decodeFilterGeneration) {
+        m_decodeFilter = std::atomic_load(&m_filter);
+        m_decodeFilterGeneration = generation;
     }
+    if (!m_decodeFilter->accepts(trans)) return false;
 
-    ss << "----------------------------------------\n";
-    outString += ss.str();
+    // Record the activity; the UI picks it up on its own refresh timer.
+    if (!cmd.isModeCode()) {
+        m_activity.mark(trans.has(MSG_CMD1_BUS_B) ? 1 : 0, cmd.rt(), cmd.sa());
+    }
+    return true;
 }
 
 /**
  * @brief Processes a raw chunk of data from the hardware queue.
- *        This function implements a state machine that iterates through the raw monitor words,
- *        assembles them into logical MessageTransaction objects, and dispatches them for formatting.
- * @param buffer Pointer to the raw data buffer.
+ *        Feeds the monitor words to the resumable stream decoder, counts every transaction in the
+ *        bus statistics and collects the accepted ones into the pending message batch. A message cut off at the end of the chunk stays in the decoder
+ *        until its remaining words arrive with the next chunk.
+ * @param buffer Pointer to the raw data buffer, or nullptr to flush the pending transaction.
  * @param bytesRead The number of bytes read into the buffer.
  */
 void BM::processAndRelayData(const unsigned char* buffer, AiUInt32 bytesRead) {
-    MessageTransaction currentTransaction;
-    std::string allMessagesForUi;
-    static uint64_t last_full_timetag = 0;
-    AiUInt32 numMonitorWords = bytesRead / 4;
-    const AiUInt32* pMonitorWords = reinterpret_cast<const AiUInt32*>(buffer);
-
-    for (AiUInt32 i = 0; i < numMonitorWords; ++i) {
-        AiUInt32 monitorWord = pMonitorWords[i];
-        AiUInt8 type = (monitorWord >> 28) & 0x0F;
-        AiUInt32 entryData = monitorWord & 0x07FFFFFF;
-        AiUInt16 busWord = entryData & 0xFFFF;
-        
-        // A new transaction is typically demarcated by a timetag, error, or command word.
-        // When one is encountered, the previously assembled transaction is finalized and processed.
-        bool isNewMessageStart = (type == 0x1 || type == 0x2 || type == 0x3 || type == 0x8 || type == 0xC);
-
-        if (isNewMessageStart && !currentTransaction.isEmpty()) {
-            if (currentTransaction.full_timetag == 0) currentTransaction.full_timetag = last_full_timetag;
-            formatAndRelayTransaction(currentTransaction, allMessagesForUi);
-            currentTransaction.clear();
-        }
-
-        switch (type) {
-            case 0x1: currentTransaction.error_valid = true; currentTransaction.error_word = entryData; break;
-            case 0x2:
-                currentTransaction.last_timetag_l_data = entryData & 0x03FFFFFF;
-                if(currentTransaction.last_timetag_h_data != 0) {
-                   currentTransaction.full_timetag = ((uint64_t)currentTransaction.last_timetag_h_data << 26) | currentTransaction.last_timetag_l_data;
-                   last_full_timetag = currentTransaction.full_timetag;
-                }
-                break;
-            case 0x3:
-                currentTransaction.last_timetag_h_data = entryData & 0x000FFFFF;
-                if(currentTransaction.last_timetag_l_data != 0) {
-                   currentTransaction.full_timetag = ((uint64_t)currentTransaction.last_timetag_h_data << 26) | currentTransaction.last_timetag_l_data;
-                   last_full_timetag = currentTransaction.full_timetag;
-                }
-                break;
-            case 0x8: case 0x9: case 0xA: case 0xB: case 0xC: case 0xD: case 0xE: case 0xF: {
-                char bus = (type <= 0xB) ? 'A' : 'B';
-                switch(type & 0x3) {
-                    case 0x0: currentTransaction.cmd1 = busWord; currentTransaction.bus1 = bus; currentTransaction.cmd1_valid = true; break;
-                    case 0x1: currentTransaction.cmd2 = busWord; currentTransaction.bus2 = bus; currentTransaction.cmd2_valid = true; break;
-                    case 0x2: currentTransaction.data_words.push_back(busWord); break;
-                    case 0x3:
-                        if (!currentTransaction.stat1_valid) {
-                           currentTransaction.stat1 = busWord; currentTransaction.stat1_bus = bus; currentTransaction.stat1_valid = true;
-                        } else {
-                           currentTransaction.stat2 = busWord; currentTransaction.stat2_bus = bus; currentTransaction.stat2_valid = true;
-                        }
-                        break;
-                }
-                break;
-            }
-            default: break; // Ignore unused or reserved types.
-        }
+    auto collect = [this](const MessageTransaction& trans) {
+        m_statistics.record(trans);
+        if (!acceptTransaction(trans)) return;
+        if (!m_pendingBatch.push(trans)) { relayPendingBatch(); m_pendingBatch.push(trans); }
+    };
+    if (buffer) {
+        m_decoder.feed(reinterpret_cast<const AiUInt32*>(buffer), bytesRead / 4, collect);
+    } else if (m_decoder.flush()) {
+        collect(m_decoder.completed());
     }
+    relayPendingBatch();
+}
 
-    // Process any remaining transaction at the end of the buffer.
-    if (!currentTransaction.isEmpty()) {
-        if (currentTransaction.full_timetag == 0) currentTransaction.full_timetag = last_full_timetag;
-        formatAndRelayTransaction(currentTransaction, allMessagesForUi);
-    }
-    
-    // Relay the complete chunk of formatted messages to the UI.
-    if (m_guiUpdateMessagesCb && !allMessagesForUi.empty()) {
-        m_guiUpdateMessagesCb(allMessagesForUi);
-    }
+/**
+ * @brief Maps the overflow and error bits of a data-queue status to GapReason bits.
+ */
+AiUInt8 BM::gapReasonFor(AiUInt32 queueStatus) {
+    AiUInt8 reason = 0;
+    if (queueStatus & API_DATA_QUEUE_STATUS_LOC_OVERFLOW) reason |= GAP_LOCAL_OVERFLOW;
+    if (queueStatus & API_DATA_QUEUE_STATUS_REM_OVERFLOW) reason |= GAP_REMOTE_OVERFLOW;
+    if (queueStatus & API_DATA_QUEUE_STATUS_LOC_BUF_ERR) reason |= GAP_LOCAL_BUF_ERR;
+    if (queueStatus & API_DATA_QUEUE_STATUS_REM_BUF_ERR) reason |= GAP_REMOTE_BUF_ERR;
+    if (queueStatus & API_DATA_QUEUE_STATUS_ASP_OVERFLOW) reason |= GAP_ASP_OVERFLOW;
+    return reason;
+}
 
-    if (m_dataLoggingEnabled.load()) {
-        Logger::info("\n---\n" + allMessagesForUi);
-    }
+/**
+ * @brief Inserts a gap marker into the decoded stream where data was lost.
+ *        The message in progress is flushed first, since its remaining words may be among the lost data.
+ *        Gap markers bypass the filter so a filtered view still shows that the trace is incomplete.
+ * @param lostBytes The number of bytes known to be lost, or 0 if only the status flags reported it.
+ * @param reason GapReason bits.
+ */
+void BM::relayGap(AiUInt32 lostBytes, AiUInt8 reason) {
+    processAndRelayData(nullptr, 0);
+    MessageTransaction gap = MessageTransaction::makeGap(m_decoder.lastTimetag(), lostBytes, reason);
+    if (!m_pendingBatch.push(gap)) { relayPendingBatch(); m_pendingBatch.push(gap); }
+    relayPendingBatch();
+}
+
+/**
+ * @brief Hands the pending batch of accepted messages to the display queue, then starts a new batch
+ *        from the pool. If the UI has fallen behind, the display queue drops its oldest batch instead
+ *        of holding up decoding.
+ */
+void BM::relayPendingBatch() {
+    if (m_pendingBatch.empty()) return;
+    m_pendingBatch.setEpoch(m_decodeEpoch.load(std::memory_order_relaxed));
+    m_displayQueue.push(std::move(m_pendingBatch));
+    m_pendingBatch = m_batchPool->acquire();
 }
 
 /**
- * @brief Sets the state for enabling or disabling data logging to a file.
+ * @brief Enables or disables recording of the raw monitor words to a binary capture file.
+ *        While monitoring, the capture is opened or closed right away; otherwise on the next start.
  */
 void BM::enableDataLogging(bool enable) {
     m_dataLoggingEnabled.store(enable);
+    if (!isMonitoring() || m_replaying.load()) return;
+    if (enable) openCapture(); else closeCapture();
+}
+
+/**
+ * @brief Opens a new capture file next to the executable, named after the local start time,
+ *        with its index sidecar (<capture>.idx). The name has millisecond resolution and gets a
+ *        numeric suffix if a capture or index of that name exists, so a restart never replaces a capture.
+ *        The capture holds every word the card delivered, before host filtering, so it can be
+ *        re-filtered when it is read back. With card filtering the card itself drops the excluded
+ *        messages; such blocks carry BLOCK_FLAG_CARD_FILTER and the header FLAG_CARD_FILTER.
+ */
+void BM::openCapture() {
+    if (m_capture.isOpen()) return;
+    auto now = std::chrono::system_clock::now();
+    std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    char stamp[32]; std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&seconds));
+    char millis[8]; snprintf(millis, sizeof(millis), "_%03d", static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000));
+    const std::string base = Common::getExecutableDirectory() + "capture_" + stamp + millis;
+    std::string path = base + ".bmc";
+    std::error_code ec;
+    for (int suffix = 2; std::filesystem::exists(path, ec) || std::filesystem::exists(CaptureIndex::pathFor(path), ec); ++suffix) {
+        path = base + "_" + std::to_string(suffix) + ".bmc";
+    }
+
+    CaptureFormat::FileHeader header; memset(&header, 0, sizeof(header));
+    header.device = m_currentConfig.ulDevice; header.stream = m_currentConfig.ulStream; header.coupling = m_currentConfig.ulCoupling;
+    header.boardSerial = m_boardSerial; header.boardType = m_boardType;
+    header.flags = m_cardFilterActive.load() ? CaptureFormat::FLAG_CARD_FILTER : 0;
+    header.startHostTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    std::shared_ptr<const MessageFilter> filter = std::atomic_load(&m_filter);
+    if (filter->isEnabled()) strncpy(header.filterExpression, filter->expression().c_str(), sizeof(header.filterExpression) - 1);
+
+    std::string error;
+    if (!m_capture.open(path, header, error)) { Logger::error("BM capture not started: " + error); return; }
+    Logger::info("BM capture started: " + path);
+    if (!m_capture.indexError().empty()) Logger::warn("BM capture " + m_capture.indexError() + "; it is rebuilt when the capture is opened.");
+}
+
+/**
+ * @brief Closes the capture file, if open, after everything captured so far has been written.
+ */
+void BM::closeCapture() {
+    if (!m_capture.isOpen()) return;
+    m_capture.close();
+    Logger::info("BM capture closed: " + m_capture.path() + ", " + std::to_string(m_capture.bytesWritten()) + " bytes in " +
+                 std::to_string(m_capture.blocksCaptured()) + " blocks, " + std::to_string(m_capture.droppedBlocks()) + " blocks (" +
+                 std::to_string(m_capture.droppedBytes()) + " bytes) dropped, " + std::to_string(m_capture.writeErrors()) + " write errors");
+    if (m_capture.droppedBlocks() > 0 || m_capture.writeErrors() > 0) Logger::warn("BM capture is incomplete; the disk could not keep up.");
 }
 /**
  * @brief Enables or disables message filtering.
  * @param enable True to enable filtering, false to disable.
  */
-void BM::enableFilter(bool enable) { std::lock_guard<std::mutex> lock(m_filterMutex); m_filterEnabled.store(enable); }
+void BM::enableFilter(bool enable) { std::lock_guard<std::mutex> lock(m_filterMutex); publishFilter(m_filter->withEnabled(enable)); }
 
 /**
  * @brief Checks if message filtering is currently enabled.
  * @return True if filtering is enabled.
  */
-bool BM::isFilterEnabled() const { return m_filterEnabled.load(); }
+bool BM::isFilterEnabled() const { return std::atomic_load(&m_filter)->isEnabled(); }
 
 /**
- * @brief Sets the criteria for message filtering.
- *        -1 for rt/sa or 0 for bus means 'any'.
+ * @brief Sets the criteria for message filtering to a single Bus/RT/SA-or-MC selection.
+ *        -1 for rt/sa/mc or 0 for bus means 'any'. Does not change whether filtering is enabled.
  * @param bus The bus to filter ('A' or 'B').
  * @param rt The remote terminal address to filter (0-30).
  * @param sa The subaddress to filter (0-30).
+ * @param mc The mode code to filter, used when no subaddress is given.
  */
  void BM::setFilterCriteria(char bus, int rt, int sa, int mc) {
+    MessageFilter filter; std::string error;
+    MessageFilter::compile(MessageFilter::criteriaExpression(bus, rt, sa, mc), filter, error);
+    std::lock_guard<std::mutex> lock(m_filterMutex);
+    publishFilter(filter.withEnabled(m_filter->isEnabled()));
+}
+
+/**
+ * @brief Compiles a filter expression (see MessageFilter) and enables it.
+ *        Compilation happens on the caller's thread; the decode thread only sees the finished filter.
+ * @param expression The filter expression.
+ * @param error Receives the syntax error if the expression is invalid.
+ * @return True if the filter was applied; false leaves the current filter unchanged.
+ */
+bool BM::setFilterExpression(const std::string& expression, std::string& error) {
+    MessageFilter filter;
+    if (!MessageFilter::compile(expression, filter, error)) return false;
     std::lock_guard<std::mutex> lock(m_filterMutex);
-    m_filterBus.store(bus);
-    m_filterRt.store(rt);
-    m_filterSa.store(sa);
-    m_filterMc.store(mc); 
-}
\ No newline at end of file
+    publishFilter(filter);
+    return true;
+}
+
+/**
+ * @brief Replaces the active filter with a new immutable snapshot.
+ *        The caller must hold m_filterMutex, which only serializes writers; the decode thread
+ *        picks the new snapshot up on its next message and releases the old one.
+ * @param filter The complete new filter.
+ */
+void BM::publishFilter(const MessageFilter& filter) {
+    std::atomic_store(&m_filter, std::shared_ptr<const MessageFilter>(std::make_shared<const MessageFilter>(filter)));
+    m_filterGeneration.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Returns the current capture pipeline counters.
+ * @return A snapshot of the data queue, raw ring, tree activity and display queue counters.
+ */
+BmPipelineStats BM::getPipelineStats() const {
+    BmPipelineStats stats;
+    stats.ringCapacity = m_rawRing.capacity();
+    stats.ringHighWaterMark = m_rawRing.highWaterMark();
+    stats.ringFullEpisodes = m_rawRing.fullEpisodes();
+    stats.ringStallMs = m_ringStallNs.load(std::memory_order_relaxed) / 1000000;
+    stats.activityMarks = m_activity.marks();
+    stats.activitySuppressed = m_activity.suppressed();
+    stats.displayQueuedMessages = m_displayQueue.queuedMessages();
+    stats.displayDroppedMessages = m_displayQueue.droppedMessages();
+    stats.displayDroppedBatches = m_displayQueue.droppedBatches();
+    stats.displayHighWaterMark = m_displayQueue.highWaterMark();
+    stats.dataQueueBytes = m_dataQueueBytes.load(std::memory_order_relaxed);
+    stats.dataQueueBytesPerSec = m_dataQueueBytesPerSec.load(std::memory_order_relaxed);
+    stats.cardFilterActive = m_cardFilterActive.load();
+    stats.dataQueueReads = m_dataQueueReads.load(std::memory_order_relaxed);
+    stats.largestReadBytes = m_largestRead.load(std::memory_order_relaxed);
+    stats.lossGaps = m_lossGaps.load(std::memory_order_relaxed);
+    stats.lostBytes = m_lostBytes.load(std::memory_order_relaxed);
+    stats.captureActive = m_capture.isOpen();
+    stats.captureBytesWritten = m_capture.bytesWritten();
+    stats.captureDroppedBytes = m_capture.droppedBytes();
+    stats.replayActive = m_replaying.load();
+    stats.replayPaused = m_replayPaused.load();
+    stats.replayAtEnd = m_replayAtEnd.load();
+    stats.replaySeekable = m_replaySeekable.load();
+    stats.replayPositionNs = m_replayPositionNs.load();
+    stats.replaySeekEpoch = m_decodeEpoch.load(std::memory_order_acquire);
+    stats.replayDurationNs = m_replayDurationNs.load();
+    stats.interrupts = m_interrupts.load(std::memory_order_relaxed);
+    stats.acquisitionWaits = m_acquisitionWaits.load(std::memory_order_relaxed);
+    stats.latencySamples = m_latency.count();
+    stats.latencyP50Us = m_latency.percentile(50);
+    stats.latencyP99Us = m_latency.percentile(99);
+    return stats;
+}
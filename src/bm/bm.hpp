@@ -8,15 +8,74 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
 #include "logger.hpp"
+#include "spscRing.hpp"
+#include "streamDecoder.hpp"
+#include "messageBatch.hpp"
+#include "activityBitmap.hpp"
+#include "busStatistics.hpp"
+#include "alignedBuffer.hpp"
+#include "displayQueue.hpp"
+#include "messageFilter.hpp"
+#include "latencyHistogram.hpp"
+#include "captureWriter.hpp"
+#include "captureReader.hpp"
+#include "replayClock.hpp"
+#include "aimDevice.hpp"
+#include <memory>
 
 typedef struct ConfigBmUi
 {
   AiUInt32 ulDevice;
   AiUInt32 ulStream;
   AiUInt8  ulCoupling;
+  bool     cardFiltering;
+  bool     useInterrupts;
+  AiUInt32 minReadBytes;
+  AiUInt32 maxReadBytes;
+  std::string deviceBackend;  // AimDevice::HARDWARE or AimDevice::SIMULATOR
 } ConfigBmUi;
 
+/**
+ * @brief Snapshot of the BM capture pipeline counters, used to size buffers and spot overload.
+ */
+struct BmPipelineStats {
+  size_t ringCapacity = 0;
+  size_t ringHighWaterMark = 0;
+  size_t ringFullEpisodes = 0;
+  uint64_t ringStallMs = 0;      // Time the acquisition thread waited for a free slot.
+  uint64_t activityMarks = 0;
+  uint64_t activitySuppressed = 0;
+  uint64_t displayQueuedMessages = 0;
+  uint64_t displayDroppedMessages = 0;
+  uint64_t displayDroppedBatches = 0;
+  size_t displayHighWaterMark = 0;
+  uint64_t dataQueueBytes = 0;
+  uint64_t dataQueueBytesPerSec = 0;
+  bool cardFilterActive = false;
+  uint64_t interrupts = 0;
+  uint64_t acquisitionWaits = 0;
+  uint64_t latencySamples = 0;
+  uint64_t latencyP50Us = 0;
+  uint64_t latencyP99Us = 0;
+  uint64_t dataQueueReads = 0;
+  AiUInt32 largestReadBytes = 0;
+  uint64_t lossGaps = 0;
+  uint64_t lostBytes = 0;
+  bool captureActive = false;
+  uint64_t captureBytesWritten = 0;
+  uint64_t captureDroppedBytes = 0;
+  bool replayActive = false;
+  bool replayPaused = false;
+  bool replayAtEnd = false;
+  bool replaySeekable = false;
+  uint64_t replayPositionNs = 0;  // Capture time of the last replayed block, from the start of the capture.
+  uint64_t replayDurationNs = 0;  // 0 until the capture index has been loaded.
+  uint32_t replaySeekEpoch = 0;   // Seeks the decoder has reached; MessageBatch::epoch() of the batches it now produces.
+};
+
 class BM {
 public:
     static BM& getInstance();
@@ -24,71 +83,169 @@ public:
     BM(const BM&) = delete;
     BM& operator=(const BM&) = delete;
 
-    using UpdateMessagesCallback = std::function<void(const std::string& formattedMessages)>;
-    using UpdateTreeItemCallback = std::function<void(char bus, int rt, int sa, bool isActive)>;
-
     AiReturn start(const ConfigBmUi& config);
     void stop();
     bool isMonitoring() const;
+    AiReturn acquisitionError() const;
 
-    void setUpdateMessagesCallback(UpdateMessagesCallback cb);
-    void setUpdateTreeItemCallback(UpdateTreeItemCallback cb);
+    size_t takeDisplayBatches(std::vector<MessageBatch>& out);
+    bool takeActivity(ActivityBitmap::Snapshot& out);
+    void getStatistics(std::vector<BusStatistics::Row>& out) const;
 
     void enableFilter(bool enable);
     bool isFilterEnabled() const;
     void setFilterCriteria(char bus, int rt, int sa, int mc = -1);
+    bool setFilterExpression(const std::string& expression, std::string& error);
     void enableDataLogging(bool enable);
 
+    bool startReplay(const std::string& capturePath, std::string& error);
+    bool isReplaying() const;
+    void setReplaySpeed(double speed);
+    void pauseReplay(bool pause);
+    void seekReplay(uint64_t offsetNs);
+
+    BmPipelineStats getPipelineStats() const;
+
 private:
     BM();
     ~BM();
 
-    struct MessageTransaction {
-        uint64_t full_timetag = 0;
-        AiUInt32 last_timetag_l_data = 0;
-        AiUInt32 last_timetag_h_data = 0;
-        AiUInt16 cmd1 = 0; char bus1 = 0; bool cmd1_valid = false;
-        AiUInt16 cmd2 = 0; char bus2 = 0; bool cmd2_valid = false;
-        AiUInt16 stat1 = 0; char stat1_bus = 0; bool stat1_valid = false;
-        AiUInt16 stat2 = 0; char stat2_bus = 0; bool stat2_valid = false;
-        std::vector<AiUInt16> data_words;
-        AiUInt32 error_word = 0; bool error_valid = false;
-
-        void clear();
-        bool isEmpty() const;
+    bool acceptTransaction(const MessageTransaction& trans);
+
+    /**
+     * @brief One raw chunk of monitor words handed from the acquisition thread to the decode thread.
+     */
+    struct RawChunk {
+        AlignedBuffer data;
+        AiUInt32 bytes = 0;
+        AiUInt32 lostBytesBefore = 0; // Data lost before this chunk was read (see GapReason).
+        AiUInt8 gapReasonBefore = 0;
+        bool cardFiltered = false;    // The card filter was active when the chunk was read.
+        uint64_t hostTimeNs = 0;      // Host wall clock when the read returned, for the capture file.
+        bool resync = false;          // Replay seek: the decoder restarts from resume before this chunk.
+        uint32_t epoch = 0;           // Replay seeks done before this chunk was read; older chunks are discarded.
+        Bm1553StreamDecoder::ResumePoint resume;
     };
-    
-    void formatAndRelayTransaction(const MessageTransaction& trans, std::string& outString);
 
-    void monitorThreadFunc();
+    static AiUInt8 gapReasonFor(AiUInt32 queueStatus);
+    void relayGap(AiUInt32 lostBytes, AiUInt8 reason);
+
+    static AiUInt32 readSizeFor(AiUInt32 bytesInQueue, AiUInt32 minBytes, AiUInt32 maxBytes);
+
+    void resetPipeline();
+    void updateQueueRate(std::chrono::steady_clock::time_point& since, uint64_t& bytesSince);
+    void acquisitionThreadFunc();
+    void replayThreadFunc();
+    bool replayBlock(const CaptureFormat::BlockHeader& block, const AiUInt32* words, bool& resync, const Bm1553StreamDecoder::ResumePoint& resume, uint32_t epoch);
+    void waitForData(std::chrono::microseconds timeout);
+    void installInterrupts();
+    void removeInterrupts();
+    static void AI_CALL_CONV bmInterruptHandler(AiUInt32 module, AiUInt8 biu, AiUInt8 type, TY_API_INTR_LOGLIST_ENTRY* info);
+    void recordDeliveryLatency();
+    void decodeThreadFunc();
     void processAndRelayData(const unsigned char* buffer, AiUInt32 bytesRead);
+    void relayPendingBatch();
     AiReturn initializeBoard(const ConfigBmUi& config);
     void shutdownBoard();
     AiReturn configureBusMonitor(const ConfigBmUi& config);
+    void configureReadSizes(const ConfigBmUi& config);
+    AiReturn programCardFilter(const MessageFilter& filter);
+    AiReturn programFilterMasks(const MessageFilter::CardFilter& card);
+    AiReturn updateCardFilter(bool queueEmpty, AiUInt8& pendingGapReason);
     AiReturn openDataQueue();
     void closeDataQueue();
+    void openCapture();
+    void closeCapture();
+
+    bool boardOpen() const { return m_device && m_device->isOpen(); }
 
-    AiUInt32 m_ulModHandle;
+    std::unique_ptr<AimDevice> m_device;
     ConfigBmUi m_currentConfig;
 
-    std::thread m_monitorThread;
+    std::thread m_acquisitionThread;
+    std::thread m_decodeThread;
     std::atomic<bool> m_monitoringActive;
+    std::atomic<bool> m_acquisitionDone;
+    // Set by the acquisition thread when a card error ends it; the run stays active until stop().
+    std::atomic<AiReturn> m_acquisitionError{API_OK};
     std::atomic<bool> m_shutdownRequested;
     std::atomic<bool> m_dataLoggingEnabled; 
-
-    UpdateMessagesCallback m_guiUpdateMessagesCb;
-    UpdateTreeItemCallback m_guiUpdateTreeItemCb;
-
-    std::atomic<bool> m_filterEnabled;
-    std::atomic<char> m_filterBus;
-    std::atomic<int>  m_filterRt;
-    std::atomic<int>  m_filterSa;
-    std::atomic<int>  m_filterMc;
-    std::mutex        m_filterMutex;
+    // Raw monitor words are recorded to a binary capture file while data logging is enabled.
+    CaptureWriter m_capture;
+    AiUInt32 m_boardSerial = 0;
+    AiUInt32 m_boardType = 0;
+
+    // Offline replay: a capture file takes the place of the card; the replay thread feeds its blocks
+    // into the raw ring in place of the acquisition thread, so decoding, filtering and display are unchanged.
+    CaptureReader m_replayReader;
+    std::string m_replayPath;
+    std::atomic<bool> m_replaying{false};
+    std::atomic<bool> m_replayPaused{false};
+    std::atomic<bool> m_replayAtEnd{false};
+    std::atomic<bool> m_replaySeekable{false};
+    std::atomic<double> m_replaySpeed{1.0};
+    std::atomic<int64_t> m_replaySeekNs{-1};
+    std::atomic<uint64_t> m_replayPositionNs{0};
+    std::atomic<uint64_t> m_replayDurationNs{0};
+    // Bumped by the replay thread on each seek; the decode thread drops chunks read before the latest seek
+    // and publishes the epoch it decodes, which the UI uses to tell the old position's batches from the new.
+    std::atomic<uint32_t> m_replayEpoch{0};
+    std::atomic<uint32_t> m_decodeEpoch{0};
+    const std::chrono::milliseconds REPLAY_POLL{10};
+
+    ActivityBitmap m_activity;
+    // Per Bus/RT/SA counters of every decoded message, before host filtering (but after card filtering,
+    // see m_cardFilterActive); reset by each start.
+    BusStatistics m_statistics;
+
+    // Filter publication: writers (UI) replace the snapshot under m_filterMutex and bump the
+    // generation; the decode thread only re-reads the shared pointer when the generation changes.
+    void publishFilter(const MessageFilter& filter);
+    std::shared_ptr<const MessageFilter> m_filter;
+    std::atomic<uint64_t> m_filterGeneration;
+    std::mutex m_filterMutex;
+    std::shared_ptr<const MessageFilter> m_decodeFilter;
+    uint64_t m_decodeFilterGeneration;
+    uint64_t m_cardFilterGeneration;
+    bool m_cardHaltedForFilter = false; // Acquisition thread: halted for a capture mode switch, draining the queue.
+    std::atomic<bool> m_cardFilterActive;
 
     AiUInt32 m_dataQueueId;
-    std::vector<unsigned char> m_rxDataBuffer;
-    const AiUInt32 RX_BUFFER_CHUNK_SIZE = 16 * 1024;
+    // Each read is sized from the card's backlog between these bounds (Bus_Monitor.Min/Max_Read_Bytes).
+    static constexpr AiUInt32 DEFAULT_MIN_READ_BYTES = 4 * 1024;
+    static constexpr AiUInt32 DEFAULT_MAX_READ_BYTES = 64 * 1024;
+    static constexpr AiUInt32 READ_BYTES_LIMIT = 1024 * 1024;
+    AiUInt32 m_minReadBytes;
+    AiUInt32 m_maxReadBytes;
+    std::atomic<uint64_t> m_dataQueueReads{0};
+    std::atomic<AiUInt32> m_largestRead{0};
+    std::atomic<uint64_t> m_ringStallNs{0}; // Acquisition time spent waiting for a free raw ring slot.
+    // Lifetime loss counters; not reset by start() so a loss is never hidden by a restart.
+    std::atomic<uint64_t> m_lossGaps{0};
+    std::atomic<uint64_t> m_lostBytes{0};
+    const size_t RX_RING_SLOTS = 128;
+    SpscRing<RawChunk> m_rawRing;
+    std::atomic<uint64_t> m_dataQueueBytes;
+    std::atomic<uint64_t> m_dataQueueBytesPerSec;
+    Bm1553StreamDecoder m_decoder;
+    const size_t MESSAGE_BATCH_CAPACITY = 1024;
+    const size_t MESSAGE_BATCH_POOL_SIZE = 64;
+    std::shared_ptr<MessageBatchPool> m_batchPool;
+    MessageBatch m_pendingBatch;
+    const size_t DISPLAY_QUEUE_MAX_BATCHES = 32;
+    DisplayQueue m_displayQueue;
+    const int DECODER_IDLE_FLUSH_MS = 20;
+
+    const std::chrono::microseconds ACQ_BACKOFF_MIN{500};
+    const std::chrono::microseconds ACQ_BACKOFF_MAX{16000};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    bool m_wakePending = false;
+    bool m_interruptsInstalled = false;
+    std::atomic<uint64_t> m_interrupts{0};
+    std::atomic<uint64_t> m_acquisitionWaits{0};
+    LatencyHistogram m_latency;
+    OffsetWindowMin m_latencyBase;
 };
 
 std::string getAIMApiErrorMessage(AiReturn errorCode);
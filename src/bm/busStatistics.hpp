@@ -0,0 +1,136 @@
+#pragma once
+
+#include "commandWord.hpp"
+#include "streamDecoder.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Live per-terminal counters, one entry per [bus][rt][sa][transmit/receive].
+ *        The decode thread records every decoded message, before host filtering. Entries are
+ *        cache-line sized and laid out flat, so recording touches one line and needs no lock.
+ *        Each entry is guarded by its own sequence counter (a seqlock): readers retry an entry
+ *        the writer changed while it was copied, so every copied entry is self-consistent.
+ *        record() and reset() must only be called from one thread; snapshot() may run on any thread.
+ */
+class BusStatistics {
+public:
+    static constexpr int ENTRIES = 2 * 32 * 32 * 2;
+
+    static int entryIndex(int busIdx, int rt, int sa, bool transmit) { return (busIdx << 11) | (rt << 6) | (sa << 1) | (transmit ? 1 : 0); }
+
+    /**
+     * @brief The counters of one entry as copied by snapshot(). Rates are left to the reader, from two snapshots.
+     */
+    struct Counters {
+        uint64_t messages = 0;
+        uint64_t noResponses = 0;
+        uint64_t errorWords = 0;
+        uint64_t wordCountMismatches = 0;
+        uint64_t lastTimetag = 0;     // Full BM timetag of the last message.
+    };
+
+    struct Row {
+        int index = 0;                // entryIndex() of the terminal.
+        Counters counters;
+        int busIdx() const { return index >> 11; }
+        int rt() const { return (index >> 6) & 0x1F; }
+        int sa() const { return (index >> 1) & 0x1F; }
+        bool transmit() const { return (index & 1) != 0; }
+    };
+
+    /**
+     * @brief Counts a decoded message. RT to RT transfers count for both terminals; gap markers are ignored.
+     *        A message whose data source responded but whose data word count differs from the command word
+     *        (or overflowed) counts as a word count mismatch.
+     */
+    void record(const MessageTransaction& trans) {
+        if (trans.isGap() || !trans.cmd1Valid()) return;
+        const CommandWordDescriptor& cmd = describeCommandWord(trans.header.cmd1);
+        const int busIdx = trans.has(MSG_CMD1_BUS_B) ? 1 : 0;
+        const bool rtToRt = trans.cmd2Valid();
+        // The data comes from the BC unless an RT transmits it after its status word (stat1).
+        const bool dataSent = (rtToRt || cmd.isTransmit()) ? trans.stat1Valid() : true;
+        const bool mismatch = trans.has(MSG_DATA_OVERFLOW) || (dataSent && trans.dataCount() != cmd.dataWords);
+        // The receiving RT of an RT to RT transfer answers last (stat2).
+        const bool noResponse = rtToRt ? !trans.stat2Valid() : !trans.stat1Valid();
+        update(entryIndex(busIdx, cmd.rt(), cmd.sa(), cmd.isTransmit()), trans, noResponse, mismatch);
+        if (rtToRt) {
+            const CommandWordDescriptor& transmitter = describeCommandWord(trans.header.cmd2);
+            update(entryIndex(busIdx, transmitter.rt(), transmitter.sa(), true), trans, !trans.stat1Valid(), mismatch);
+        }
+    }
+
+    /**
+     * @brief Copies every entry that has seen a message to out (cleared first), in entryIndex() order.
+     *        Reuses the capacity of out, so a reader polling with the same vector does not allocate.
+     */
+    void snapshot(std::vector<Row>& out) const {
+        out.clear();
+        for (int i = 0; i < ENTRIES; ++i) {
+            const Entry& entry = m_entries[i];
+            if (entry.messages.load(std::memory_order_relaxed) == 0) continue;
+            Row row;
+            row.index = i;
+            uint32_t before, after;
+            do {
+                before = entry.sequence.load(std::memory_order_acquire);
+                if (before & 1) { after = before + 1; continue; }
+                row.counters.messages = entry.messages.load(std::memory_order_relaxed);
+                row.counters.noResponses = entry.noResponses.load(std::memory_order_relaxed);
+                row.counters.errorWords = entry.errorWords.load(std::memory_order_relaxed);
+                row.counters.wordCountMismatches = entry.wordCountMismatches.load(std::memory_order_relaxed);
+                row.counters.lastTimetag = entry.lastTimetag.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = entry.sequence.load(std::memory_order_relaxed);
+            } while (before != after);
+            out.push_back(row);
+        }
+    }
+
+    /**
+     * @brief Clears all counters. Only call from the writer thread or while it is stopped.
+     */
+    void reset() {
+        for (Entry& entry : m_entries) {
+            const uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+            entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            entry.messages.store(0, std::memory_order_relaxed); entry.noResponses.store(0, std::memory_order_relaxed);
+            entry.errorWords.store(0, std::memory_order_relaxed); entry.wordCountMismatches.store(0, std::memory_order_relaxed);
+            entry.lastTimetag.store(0, std::memory_order_relaxed);
+            entry.sequence.store(sequence + 2, std::memory_order_release);
+        }
+    }
+
+private:
+    struct alignas(64) Entry {
+        std::atomic<uint32_t> sequence{0};  // Odd while the writer updates the entry.
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> noResponses{0};
+        std::atomic<uint64_t> errorWords{0};
+        std::atomic<uint64_t> wordCountMismatches{0};
+        std::atomic<uint64_t> lastTimetag{0};
+    };
+    static_assert(sizeof(Entry) == 64, "BusStatistics entries must fill one cache line");
+
+    /**
+     * @brief Updates one entry inside its sequence. Single writer: plain load/store, no locked instructions.
+     */
+    void update(int index, const MessageTransaction& trans, bool noResponse, bool mismatch) {
+        Entry& entry = m_entries[index];
+        const uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+        entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        entry.messages.store(entry.messages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (noResponse) entry.noResponses.store(entry.noResponses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (trans.errorValid()) entry.errorWords.store(entry.errorWords.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (mismatch) entry.wordCountMismatches.store(entry.wordCountMismatches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (trans.header.full_timetag != 0) entry.lastTimetag.store(trans.header.full_timetag, std::memory_order_relaxed);
+        entry.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    std::array<Entry, ENTRIES> m_entries{};
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "activityBitmap.hpp"
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief On-disk layout of a BM capture file (.bmc).
+ *          file  := FileHeader { BlockHeader payload }
+ *        Each payload is the raw monitor words of one data-queue read, exactly as the card
+ *        delivered them, so a capture can be decoded (and re-filtered) later with the same
+ *        stream decoder as live data. The structs are written as-is in the host's byte order
+ *        (little-endian on every supported platform).
+ *
+ *        A capture is accompanied by a sparse index sidecar (<capture>.idx):
+ *          index := IndexHeader { IndexEntry }
+ *        Each entry covers a run of consecutive blocks (about CaptureIndexBuilder's entry span)
+ *        and records their time range and which Bus/RT/SA carried traffic, so a query only
+ *        decodes the entries that can contain matching messages.
+ */
+namespace CaptureFormat {
+    constexpr char FILE_MAGIC[8] = {'A', 'I', 'M', '1', '5', '5', '3', 'C'};
+    constexpr uint16_t VERSION = 1;
+    constexpr uint32_t BLOCK_MAGIC = 0x4B4C4231; // "1BLK", lets a reader resynchronize after a damaged block.
+    constexpr uint32_t FLAG_CARD_FILTER = 1u << 0; // The card filter was active for some of the recording (see BLOCK_FLAG_CARD_FILTER).
+    constexpr uint8_t BLOCK_FLAG_CARD_FILTER = 1u << 0; // The card only captured messages selected by the filter when this block was read.
+
+    /**
+     * @brief Board, stream and capture configuration at the start of the recording.
+     */
+    struct FileHeader {
+        char magic[8];
+        uint16_t version;
+        uint16_t headerBytes;
+        uint32_t device;
+        uint32_t stream;
+        uint32_t coupling;
+        uint32_t boardSerial;
+        uint32_t boardType;
+        uint32_t flags;
+        uint32_t reserved;
+        uint64_t startHostTimeNs;          // Host wall clock, nanoseconds since the Unix epoch.
+        char filterExpression[208];        // Host filter at the start, NUL-terminated (informational).
+    };
+    static_assert(std::is_trivially_copyable<FileHeader>::value, "FileHeader must be trivially copyable");
+    static_assert(sizeof(FileHeader) == 256, "FileHeader layout changed");
+
+    /**
+     * @brief Prefix of one block of raw monitor words.
+     */
+    struct BlockHeader {
+        uint32_t magic;
+        uint32_t payloadBytes;
+        uint64_t hostTimeNs;               // Host wall clock when the data-queue read returned.
+        uint32_t lostBytesBefore;          // Data lost between the previous block and this one.
+        uint8_t gapReason;                 // GapReason bits for that loss, 0 if none.
+        uint8_t flags;                     // BLOCK_FLAG_* bits.
+        uint8_t reserved[2];
+    };
+    static_assert(std::is_trivially_copyable<BlockHeader>::value, "BlockHeader must be trivially copyable");
+    static_assert(sizeof(BlockHeader) == 24, "BlockHeader layout changed");
+
+    constexpr char INDEX_MAGIC[8] = {'A', 'I', 'M', '1', '5', '5', '3', 'I'};
+    constexpr uint16_t INDEX_VERSION = 1;
+
+    /**
+     * @brief Header of an index sidecar.
+     */
+    struct IndexHeader {
+        char magic[8];
+        uint16_t version;
+        uint16_t headerBytes;
+        uint32_t entryBytes;
+        uint64_t captureStartHostTimeNs;   // Copied from the capture's FileHeader to pair the two files.
+        uint64_t captureBytes;             // Capture size covered by the index; 0 if it was not closed cleanly.
+    };
+    static_assert(std::is_trivially_copyable<IndexHeader>::value, "IndexHeader must be trivially copyable");
+    static_assert(sizeof(IndexHeader) == 32, "IndexHeader layout changed");
+
+    /**
+     * @brief One index entry: a run of blocks and the messages that start in it.
+     *        A message still open at endOffset belongs to this entry; a reader continues
+     *        into the following blocks until it completes.
+     */
+    struct IndexEntry {
+        uint64_t fileOffset;               // First block of the entry.
+        uint64_t endOffset;                // First block after the entry.
+        uint64_t firstTimeUs;              // Earliest message timetag (timetagMicroseconds), UINT64_MAX if none.
+        uint64_t lastTimeUs;               // Latest message timetag, 0 if none.
+        uint64_t firstHostTimeNs;          // Host receive time of the first block.
+        uint64_t resumeTimetag;            // Decoder state at fileOffset (Bm1553StreamDecoder::ResumePoint),
+        uint32_t timetagHigh;              // so messages decoded from here get the same timetags
+        uint8_t timetagHighValid;          // as in a decode from the start of the file.
+        uint8_t reserved[3];
+        uint32_t messageCount;
+        uint32_t reserved2;
+        uint64_t presence[ActivityBitmap::WORDS]; // Bus/RT/SA of the command words, ActivityBitmap::bitIndex layout.
+    };
+    static_assert(std::is_trivially_copyable<IndexEntry>::value, "IndexEntry must be trivially copyable");
+    static_assert(sizeof(IndexEntry) == 320, "IndexEntry layout changed");
+}
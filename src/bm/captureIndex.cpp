@@ -0,0 +1,224 @@
+#include "captureIndex.hpp"
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+/**
+ * @brief Sets the presence bit of the Bus/RT/SA addressed by a command word.
+ */
+void markCommand(CaptureFormat::IndexEntry& entry, AiUInt16 cmd, bool busB) {
+    const int bit = ActivityBitmap::bitIndex(busB ? 1 : 0, cmd >> 11, (cmd >> 5) & 0x1F);
+    entry.presence[bit >> 6] |= uint64_t(1) << (bit & 63);
+}
+
+/**
+ * @brief Checks a command word against the Bus/RT/SA part of a query.
+ */
+bool commandMatches(const CaptureIndex::Query& query, AiUInt16 cmd, bool busB) {
+    if (query.bus && (std::toupper(static_cast<unsigned char>(query.bus)) == 'B') != busB) return false;
+    if (query.rt >= 0 && query.rt != (cmd >> 11)) return false;
+    return query.sa < 0 || query.sa == ((cmd >> 5) & 0x1F);
+}
+} // namespace
+
+/**
+ * @brief Creates the index file and writes a header that marks it incomplete until close().
+ * @param indexPath The sidecar to create; an existing file is replaced.
+ * @param captureStartHostTimeNs The start time from the capture's FileHeader.
+ * @param error Receives the reason if the file cannot be created.
+ * @return True if the index is open.
+ */
+bool CaptureIndexBuilder::open(const std::string& indexPath, uint64_t captureStartHostTimeNs, std::string& error) {
+    close(0);
+    m_file = std::fopen(indexPath.c_str(), "wb");
+    if (!m_file) { error = "cannot create " + indexPath + ": " + std::strerror(errno); return false; }
+    m_header = CaptureFormat::IndexHeader{};
+    std::memcpy(m_header.magic, CaptureFormat::INDEX_MAGIC, sizeof(m_header.magic));
+    m_header.version = CaptureFormat::INDEX_VERSION;
+    m_header.headerBytes = sizeof(m_header);
+    m_header.entryBytes = sizeof(CaptureFormat::IndexEntry);
+    m_header.captureStartHostTimeNs = captureStartHostTimeNs;
+    std::fwrite(&m_header, sizeof(m_header), 1, m_file);
+    m_decoder.reset();
+    m_entryOpen = false; m_previousOpen = false; m_entryCount = 0;
+    return true;
+}
+
+/**
+ * @brief Indexes the next block of the capture. Blocks must be added in file order.
+ * @param offset The block's offset in the capture file.
+ * @param block The block header.
+ * @param words The block's monitor words.
+ * @param wordCount The number of monitor words.
+ */
+void CaptureIndexBuilder::addBlock(uint64_t offset, const CaptureFormat::BlockHeader& block, const AiUInt32* words, size_t wordCount) {
+    if (!m_file) return;
+    if (m_entryOpen && m_entry.endOffset - m_entry.fileOffset >= m_entrySpan) {
+        if (m_previousOpen) { writeEntry(m_previous); m_previousOpen = false; }
+        if (m_decoder.hasPending()) { m_previous = m_entry; m_previousOpen = true; } else { writeEntry(m_entry); }
+        m_entryOpen = false;
+    }
+    if (!m_entryOpen) startEntry(offset, block.hostTimeNs);
+    m_entry.endOffset = offset + sizeof(block) + block.payloadBytes;
+    // Live decoding flushes the message in progress at a gap; do the same so readers agree.
+    if (block.gapReason != 0 && m_decoder.flush()) onMessage(m_decoder.completed());
+    m_decoder.feed(words, wordCount, [this](const MessageTransaction& trans) { onMessage(trans); });
+}
+
+/**
+ * @brief Writes the remaining entries, records the capture size in the header and closes the file.
+ *        Does nothing if the index is not open.
+ * @param captureBytes The final size of the capture file, or 0 to leave the index marked incomplete
+ *        (e.g. after a capture write error), so that it is rebuilt when loaded.
+ */
+void CaptureIndexBuilder::close(uint64_t captureBytes) {
+    if (!m_file) return;
+    if (m_decoder.flush()) onMessage(m_decoder.completed());
+    if (m_previousOpen) { writeEntry(m_previous); m_previousOpen = false; }
+    if (m_entryOpen) { writeEntry(m_entry); m_entryOpen = false; }
+    m_header.captureBytes = captureBytes;
+    if (fseeko(m_file, 0, SEEK_SET) == 0) std::fwrite(&m_header, sizeof(m_header), 1, m_file);
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+/**
+ * @brief Starts a new entry at a block, recording the decoder's timetag state there.
+ */
+void CaptureIndexBuilder::startEntry(uint64_t offset, uint64_t hostTimeNs) {
+    m_entry = CaptureFormat::IndexEntry{};
+    m_entry.fileOffset = offset;
+    m_entry.endOffset = offset;
+    m_entry.firstTimeUs = UINT64_MAX;
+    m_entry.firstHostTimeNs = hostTimeNs;
+    Bm1553StreamDecoder::ResumePoint resume = m_decoder.resumePoint();
+    m_entry.resumeTimetag = resume.timetag;
+    m_entry.timetagHigh = resume.timetagHigh;
+    m_entry.timetagHighValid = resume.timetagHighValid ? 1 : 0;
+    m_entryOpen = true;
+}
+
+/**
+ * @brief Records a completed message in the entry it started in.
+ */
+void CaptureIndexBuilder::onMessage(const MessageTransaction& trans) {
+    CaptureFormat::IndexEntry& entry = m_previousOpen ? m_previous : m_entry;
+    if (trans.cmd1Valid()) {
+        ++entry.messageCount;
+        markCommand(entry, trans.header.cmd1, trans.has(MSG_CMD1_BUS_B));
+        if (trans.has(MSG_CMD2_VALID)) markCommand(entry, trans.header.cmd2, trans.has(MSG_CMD2_BUS_B));
+        if (trans.header.full_timetag != 0) {
+            const uint64_t us = timetagMicroseconds(trans.header.full_timetag);
+            if (us < entry.firstTimeUs) entry.firstTimeUs = us;
+            if (us > entry.lastTimeUs) entry.lastTimeUs = us;
+        }
+    }
+    if (m_previousOpen) { writeEntry(m_previous); m_previousOpen = false; }
+}
+
+/**
+ * @brief Appends one entry to the index file.
+ */
+void CaptureIndexBuilder::writeEntry(const CaptureFormat::IndexEntry& entry) {
+    std::fwrite(&entry, sizeof(entry), 1, m_file);
+    ++m_entryCount;
+}
+
+/**
+ * @brief Rebuilds the index sidecar of an existing capture by reading it once from start to end.
+ *        A capture cut short by a crash is indexed up to its last complete block.
+ * @param capturePath The capture file.
+ * @param error Receives the reason if the capture cannot be read or the index not written.
+ * @param entrySpan Capture bytes per index entry.
+ * @return True if the index was written.
+ */
+bool CaptureIndexBuilder::rebuild(const std::string& capturePath, std::string& error, uint64_t entrySpan) {
+    CaptureReader reader;
+    if (!reader.open(capturePath, error)) return false;
+    CaptureIndexBuilder builder(entrySpan);
+    if (!builder.open(CaptureIndex::pathFor(capturePath), reader.header().startHostTimeNs, error)) return false;
+    reader.forEachBlock(reader.firstBlockOffset(), reader.fileBytes(),
+                        [&builder](uint64_t offset, const CaptureFormat::BlockHeader& block, const AiUInt32* words, size_t count) {
+                            builder.addBlock(offset, block, words, count);
+                        });
+    builder.close(reader.fileBytes());
+    return true;
+}
+
+/**
+ * @brief Loads the index of a capture, rebuilding it first if it is missing, incomplete or belongs
+ *        to a different recording.
+ * @param capturePath The capture file; the index is expected at pathFor(capturePath).
+ * @param error Receives the reason if neither the capture nor the index can be read.
+ * @return True if the index was loaded.
+ */
+bool CaptureIndex::load(const std::string& capturePath, std::string& error) {
+    CaptureReader capture;
+    if (!capture.open(capturePath, error)) return false;
+    if (read(pathFor(capturePath), capture)) return true;
+    if (!CaptureIndexBuilder::rebuild(capturePath, error)) return false;
+    if (read(pathFor(capturePath), capture)) return true;
+    error = "cannot read " + pathFor(capturePath);
+    return false;
+}
+
+/**
+ * @brief Reads an index file if it is complete and matches the capture.
+ */
+bool CaptureIndex::read(const std::string& indexPath, const CaptureReader& capture) {
+    m_entries.clear();
+    std::FILE* file = std::fopen(indexPath.c_str(), "rb");
+    if (!file) return false;
+    CaptureFormat::IndexHeader header;
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                 std::memcmp(header.magic, CaptureFormat::INDEX_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.version == CaptureFormat::INDEX_VERSION && header.headerBytes == sizeof(header) &&
+                 header.entryBytes == sizeof(CaptureFormat::IndexEntry) &&
+                 header.captureStartHostTimeNs == capture.header().startHostTimeNs && header.captureBytes == capture.fileBytes();
+    CaptureFormat::IndexEntry entry;
+    while (valid && std::fread(&entry, sizeof(entry), 1, file) == 1) m_entries.push_back(entry);
+    std::fclose(file);
+    if (!valid) m_entries.clear();
+    return valid;
+}
+
+/**
+ * @brief Selects the entries whose time range overlaps the query and whose presence bitmap has a
+ *        matching Bus/RT/SA.
+ * @return Entry indices in file order.
+ */
+std::vector<size_t> CaptureIndex::candidates(const Query& query) const {
+    uint64_t wanted[ActivityBitmap::WORDS] = {};
+    for (int bus = 0; bus < 2; ++bus) {
+        for (int rt = 0; rt < 32; ++rt) {
+            for (int sa = 0; sa < 32; ++sa) {
+                if (!commandMatches(query, static_cast<AiUInt16>((rt << 11) | (sa << 5)), bus == 1)) continue;
+                const int bit = ActivityBitmap::bitIndex(bus, rt, sa);
+                wanted[bit >> 6] |= uint64_t(1) << (bit & 63);
+            }
+        }
+    }
+    std::vector<size_t> result;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const CaptureFormat::IndexEntry& entry = m_entries[i];
+        if (entry.lastTimeUs < query.fromUs || entry.firstTimeUs > query.toUs) continue;
+        bool present = false;
+        for (int w = 0; w < ActivityBitmap::WORDS && !present; ++w) present = (entry.presence[w] & wanted[w]) != 0;
+        if (present) result.push_back(i);
+    }
+    return result;
+}
+
+/**
+ * @brief Checks a decoded message against the query. A message without a timetag only matches an open time range.
+ */
+bool CaptureIndex::Query::matches(const MessageTransaction& trans) const {
+    if (!trans.cmd1Valid()) return false;
+    bool addressed = commandMatches(*this, trans.header.cmd1, trans.has(MSG_CMD1_BUS_B)) ||
+                     (trans.has(MSG_CMD2_VALID) && commandMatches(*this, trans.header.cmd2, trans.has(MSG_CMD2_BUS_B)));
+    if (!addressed) return false;
+    if (trans.header.full_timetag == 0) return fromUs == 0 && toUs == UINT64_MAX;
+    const uint64_t us = timetagMicroseconds(trans.header.full_timetag);
+    return us >= fromUs && us <= toUs;
+}
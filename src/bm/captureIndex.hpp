@@ -0,0 +1,94 @@
+#pragma once
+
+#include "captureFormat.hpp"
+#include "captureReader.hpp"
+#include "streamDecoder.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Builds the index sidecar of a capture (see CaptureFormat) incrementally, one block at a time.
+ *        Blocks are decoded with a decoder of its own, so the index describes exactly the words in
+ *        the file; the same code indexes a live capture and rebuilds the index of an old one.
+ *        A new entry starts at the first block after entrySpan bytes of capture.
+ */
+class CaptureIndexBuilder {
+public:
+    static constexpr uint64_t DEFAULT_ENTRY_SPAN = 256 * 1024;
+
+    explicit CaptureIndexBuilder(uint64_t entrySpan = DEFAULT_ENTRY_SPAN) : m_entrySpan(entrySpan ? entrySpan : 1) {}
+    ~CaptureIndexBuilder() { close(0); }
+
+    CaptureIndexBuilder(const CaptureIndexBuilder&) = delete;
+    CaptureIndexBuilder& operator=(const CaptureIndexBuilder&) = delete;
+
+    bool open(const std::string& indexPath, uint64_t captureStartHostTimeNs, std::string& error);
+    void addBlock(uint64_t offset, const CaptureFormat::BlockHeader& block, const AiUInt32* words, size_t wordCount);
+    void close(uint64_t captureBytes);
+    bool isOpen() const { return m_file != nullptr; }
+    uint64_t entryCount() const { return m_entryCount; }
+
+    static bool rebuild(const std::string& capturePath, std::string& error, uint64_t entrySpan = DEFAULT_ENTRY_SPAN);
+
+private:
+    void startEntry(uint64_t offset, uint64_t hostTimeNs);
+    void onMessage(const MessageTransaction& trans);
+    void writeEntry(const CaptureFormat::IndexEntry& entry);
+
+    const uint64_t m_entrySpan;
+    std::FILE* m_file = nullptr;
+    CaptureFormat::IndexHeader m_header{};
+    Bm1553StreamDecoder m_decoder;
+    CaptureFormat::IndexEntry m_entry{};
+    bool m_entryOpen = false;
+    // The previous entry stays open until the message that was in progress at its end completes.
+    CaptureFormat::IndexEntry m_previous{};
+    bool m_previousOpen = false;
+    uint64_t m_entryCount = 0;
+};
+
+/**
+ * @brief The loaded index of a capture, used to find the entries that can hold matching messages.
+ */
+class CaptureIndex {
+public:
+    /**
+     * @brief Messages to look for; bus 0, rt/sa -1 and an open time range mean 'any'.
+     *        Times are timetagMicroseconds() values. sa matches the command word's subaddress field,
+     *        so SA 0 and 31 select mode codes.
+     */
+    struct Query {
+        char bus = 0;
+        int rt = -1;
+        int sa = -1;
+        uint64_t fromUs = 0;
+        uint64_t toUs = UINT64_MAX;
+
+        bool matches(const MessageTransaction& trans) const;
+    };
+
+    static std::string pathFor(const std::string& capturePath) { return capturePath + ".idx"; }
+
+    bool load(const std::string& capturePath, std::string& error);
+    const std::vector<CaptureFormat::IndexEntry>& entries() const { return m_entries; }
+    std::vector<size_t> candidates(const Query& query) const;
+
+    /**
+     * @brief Decodes only the candidate entries and calls onTransaction for each matching message,
+     *        in file order. Gap markers in those entries are passed through.
+     */
+    template <typename Handler>
+    void find(CaptureReader& reader, const Query& query, Handler&& onTransaction) const {
+        for (size_t index : candidates(query)) {
+            reader.decodeEntry(m_entries[index], [&](const MessageTransaction& trans) {
+                if (trans.isGap() || query.matches(trans)) onTransaction(trans);
+            });
+        }
+    }
+
+private:
+    bool read(const std::string& indexPath, const CaptureReader& capture);
+
+    std::vector<CaptureFormat::IndexEntry> m_entries;
+};
@@ -0,0 +1,46 @@
+#include "captureReader.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Maps a capture file and validates its header.
+ * @param path The capture file.
+ * @param error Receives the reason if the file cannot be used.
+ * @return True if the file is open.
+ */
+bool CaptureReader::open(const std::string& path, std::string& error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { error = "cannot open " + path + ": " + std::strerror(errno); return false; }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(m_header)) {
+        ::close(fd);
+        error = path + " is not a BM capture file";
+        return false;
+    }
+    // The mapping stays valid after the descriptor is closed.
+    void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) { error = "cannot map " + path + ": " + std::strerror(errno); return false; }
+    m_data = static_cast<const unsigned char*>(data);
+    m_fileBytes = static_cast<uint64_t>(info.st_size);
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    if (std::memcmp(m_header.magic, CaptureFormat::FILE_MAGIC, sizeof(m_header.magic)) != 0 ||
+        m_header.version != CaptureFormat::VERSION || m_header.headerBytes < sizeof(m_header)) {
+        error = path + " is not a BM capture file";
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Unmaps the file, if open.
+ */
+void CaptureReader::close() {
+    if (m_data) { munmap(const_cast<unsigned char*>(m_data), static_cast<size_t>(m_fileBytes)); m_data = nullptr; }
+    m_fileBytes = 0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "captureFormat.hpp"
+#include "streamDecoder.hpp"
+#include <cstring>
+#include <string>
+
+/**
+ * @brief Reads a BM capture file (see CaptureFormat) block by block and decodes index entries.
+ *        The file is memory-mapped read-only and block payloads are handed to the decoder in
+ *        place, without copying; only the pages of the blocks actually visited are read, so
+ *        walking the candidate entries of an index only touches those parts of the file.
+ */
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader() { close(); }
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    const CaptureFormat::FileHeader& header() const { return m_header; }
+    uint64_t fileBytes() const { return m_fileBytes; }
+    uint64_t firstBlockOffset() const { return m_header.headerBytes; }
+
+    /**
+     * @brief Locates the block at an offset inside the mapping.
+     * @param offset The offset of a block header.
+     * @param block Receives the block header.
+     * @return The block's monitor words, or nullptr at the end of the file or at a damaged or truncated block.
+     */
+    const AiUInt32* blockAt(uint64_t offset, CaptureFormat::BlockHeader& block) const {
+        if (!m_data || offset + sizeof(block) > m_fileBytes) return nullptr;
+        std::memcpy(&block, m_data + offset, sizeof(block));
+        const uint64_t payloadOffset = offset + sizeof(block);
+        if (block.magic != CaptureFormat::BLOCK_MAGIC || block.payloadBytes % 4 != 0 || payloadOffset + block.payloadBytes > m_fileBytes) return nullptr;
+        // Headers and payloads are multiples of 4 bytes from a page-aligned mapping, so words are aligned.
+        return reinterpret_cast<const AiUInt32*>(m_data + payloadOffset);
+    }
+
+    /**
+     * @brief Calls onBlock(offset, blockHeader, words, wordCount) for every block starting in [from, to).
+     *        Stops early at a damaged or truncated block.
+     * @return The offset just past the last block visited.
+     */
+    template <typename BlockHandler>
+    uint64_t forEachBlock(uint64_t from, uint64_t to, BlockHandler&& onBlock) const {
+        CaptureFormat::BlockHeader block;
+        uint64_t offset = from;
+        while (offset < to) {
+            const AiUInt32* words = blockAt(offset, block);
+            if (!words) break;
+            onBlock(offset, block, words, block.payloadBytes / 4);
+            offset += sizeof(block) + block.payloadBytes;
+        }
+        return offset;
+    }
+
+    /**
+     * @brief Decodes the messages that start in one index entry and calls onTransaction for each,
+     *        including gap markers for blocks that follow lost data. The tail of a message begun
+     *        in the previous entry is skipped; a message still open at the end of the entry is
+     *        completed from the following blocks.
+     */
+    template <typename Handler>
+    void decodeEntry(const CaptureFormat::IndexEntry& entry, Handler&& onTransaction) {
+        Bm1553StreamDecoder::ResumePoint resume;
+        resume.timetag = entry.resumeTimetag; resume.timetagHigh = entry.timetagHigh; resume.timetagHighValid = entry.timetagHighValid != 0;
+        m_decoder.resume(resume);
+        auto deliver = [&onTransaction](const MessageTransaction& trans) { if (trans.cmd1Valid()) onTransaction(trans); };
+        uint64_t next = forEachBlock(entry.fileOffset, entry.endOffset, [&](uint64_t, const CaptureFormat::BlockHeader& block, const AiUInt32* words, size_t count) {
+            if (block.gapReason != 0) {
+                if (m_decoder.flush()) deliver(m_decoder.completed());
+                onTransaction(MessageTransaction::makeGap(m_decoder.lastTimetag(), block.lostBytesBefore, block.gapReason));
+            }
+            m_decoder.feed(words, count, deliver);
+        });
+        CaptureFormat::BlockHeader block;
+        const AiUInt32* words = nullptr;
+        while (m_decoder.hasPending() && (words = blockAt(next, block)) != nullptr) {
+            if (block.gapReason != 0) break;
+            for (size_t i = 0; i < block.payloadBytes / 4; ++i) {
+                if (m_decoder.consume(words[i])) { deliver(m_decoder.completed()); return; }
+            }
+            next += sizeof(block) + block.payloadBytes;
+        }
+        if (m_decoder.flush()) deliver(m_decoder.completed());
+    }
+
+private:
+    const unsigned char* m_data = nullptr;
+    CaptureFormat::FileHeader m_header{};
+    uint64_t m_fileBytes = 0;
+    Bm1553StreamDecoder m_decoder;
+};
@@ -0,0 +1,202 @@
+#include "captureWriter.hpp"
+#include "streamDecoder.hpp"
+#include <cerrno>
+#include <cstring>
+
+/**
+ * @brief Creates the capture file and its index sidecar, writes the header and starts the writer thread.
+ *        The buffers are allocated on the first open and reused afterwards.
+ * @param path The file to create; an existing file is replaced.
+ * @param header The file header; magic, version and size are filled in here.
+ * @param error Receives the reason if the file cannot be created.
+ * @return True if the capture is open.
+ */
+bool CaptureWriter::open(const std::string& path, const CaptureFormat::FileHeader& header, std::string& error) {
+    close();
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) { error = "cannot create " + path + ": " + std::strerror(errno); return false; }
+    // Blocks are already gathered into large buffers; stdio buffering would only add a copy.
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    CaptureFormat::FileHeader fileHeader = header;
+    std::memcpy(fileHeader.magic, CaptureFormat::FILE_MAGIC, sizeof(fileHeader.magic));
+    fileHeader.version = CaptureFormat::VERSION;
+    fileHeader.headerBytes = sizeof(fileHeader);
+    if (std::fwrite(&fileHeader, sizeof(fileHeader), 1, file) != 1) {
+        error = "cannot write " + path + ": " + std::strerror(errno);
+        std::fclose(file);
+        return false;
+    }
+
+    m_indexError.clear();
+    if (!m_index.open(CaptureIndex::pathFor(path), fileHeader.startHostTimeNs, m_indexError)) {
+        // The capture matters more than its index, which can be rebuilt later.
+        m_indexError = "index not written (" + m_indexError + ")";
+    }
+    m_writeOffset = sizeof(fileHeader);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_buffers.empty()) {
+        m_buffers.resize(BUFFER_COUNT);
+        for (auto& buffer : m_buffers) { buffer.reallocate(BUFFER_BYTES); }
+    }
+    m_fill.assign(BUFFER_COUNT, 0);
+    m_free.clear();
+    for (size_t i = 0; i < BUFFER_COUNT; ++i) { m_free.push_back(BUFFER_COUNT - 1 - i); }
+    m_full.clear();
+    m_current = NO_BUFFER;
+    m_pendingLostBytes = 0; m_pendingGapReason = 0; m_blockFlagsSeen = 0;
+    m_stopRequested = false;
+    m_bytesWritten.store(sizeof(fileHeader)); m_blocksCaptured.store(0); m_droppedBlocks.store(0); m_droppedBytes.store(0); m_writeErrors.store(0);
+
+    m_path = path;
+    m_file = file;
+    m_header = fileHeader;
+    m_thread = std::thread(&CaptureWriter::writerThreadFunc, this);
+    m_open.store(true, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Writes everything captured so far, stops the writer thread, updates the header flags
+ *        (see updateHeaderFlags()) and closes the file. Does nothing if no capture is open.
+ */
+void CaptureWriter::close() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open.store(false, std::memory_order_release);
+        m_stopRequested = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    updateHeaderFlags();
+    std::fclose(m_file);
+    m_file = nullptr;
+    m_index.close(m_writeErrors.load() == 0 ? m_bytesWritten.load() : 0);
+}
+
+/**
+ * @brief Adds one block of raw monitor words to the capture. Called by a single producer thread.
+ *        Only copies into the current buffer; the disk is written by the writer thread.
+ * @param payload The raw monitor words.
+ * @param bytes The payload size in bytes.
+ * @param hostTimeNs Host wall clock time the data was received, in nanoseconds since the Unix epoch.
+ * @param lostBytesBefore Bytes lost before this block (see GapReason).
+ * @param gapReason GapReason bits for that loss.
+ * @param flags CaptureFormat::BLOCK_FLAG_* bits of the block.
+ * @return False if the capture is not open or the block had to be dropped.
+ */
+bool CaptureWriter::append(const void* payload, uint32_t bytes, uint64_t hostTimeNs, uint32_t lostBytesBefore, uint8_t gapReason, uint8_t flags) {
+    const size_t needed = sizeof(CaptureFormat::BlockHeader) + bytes;
+    bool wakeWriter = false, captured = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open.load(std::memory_order_relaxed)) return false;
+        m_pendingLostBytes += lostBytesBefore; m_pendingGapReason |= gapReason;
+        m_blockFlagsSeen |= flags;
+        if (m_current != NO_BUFFER && m_fill[m_current] + needed > BUFFER_BYTES) {
+            m_full.push_back(m_current);
+            m_current = NO_BUFFER;
+            wakeWriter = true;
+        }
+        if (m_current == NO_BUFFER && !m_free.empty() && needed <= BUFFER_BYTES) {
+            m_current = m_free.back();
+            m_free.pop_back();
+        }
+        if (m_current == NO_BUFFER) {
+            // The disk is behind: drop the block and report it as a gap in front of the next one.
+            m_pendingLostBytes += bytes; m_pendingGapReason |= GAP_CAPTURE_OVERRUN;
+            m_droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+            m_droppedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        } else {
+            CaptureFormat::BlockHeader header{};
+            header.magic = CaptureFormat::BLOCK_MAGIC;
+            header.payloadBytes = bytes;
+            header.hostTimeNs = hostTimeNs;
+            header.lostBytesBefore = m_pendingLostBytes;
+            header.gapReason = m_pendingGapReason;
+            header.flags = flags;
+            unsigned char* out = m_buffers[m_current].data() + m_fill[m_current];
+            std::memcpy(out, &header, sizeof(header));
+            std::memcpy(out + sizeof(header), payload, bytes);
+            m_fill[m_current] += needed;
+            m_pendingLostBytes = 0; m_pendingGapReason = 0;
+            m_blocksCaptured.fetch_add(1, std::memory_order_relaxed);
+            captured = true;
+        }
+    }
+    if (wakeWriter) m_cv.notify_one();
+    return captured;
+}
+
+/**
+ * @brief The writer thread: writes full buffers as they are handed over, the partially filled
+ *        buffer every FLUSH_INTERVAL, and everything that is left when the capture is closed.
+ */
+void CaptureWriter::writerThreadFunc() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait_for(lock, FLUSH_INTERVAL, [this] { return !m_full.empty() || m_stopRequested; });
+        // Sampled once: a stop requested while buffers are being written gets one more pass for the last buffer.
+        const bool stopping = m_stopRequested;
+        if ((m_full.empty() || stopping) && m_current != NO_BUFFER && m_fill[m_current] > 0) {
+            m_full.push_back(m_current);
+            m_current = NO_BUFFER;
+        }
+        while (!m_full.empty()) {
+            size_t index = m_full.front();
+            m_full.pop_front();
+            lock.unlock();
+            if (writeBuffer(index)) indexBuffer(index);
+            lock.lock();
+            m_fill[index] = 0;
+            m_free.push_back(index);
+        }
+        if (stopping) break;
+    }
+}
+
+/**
+ * @brief Writes one buffer to the file with a single call. Runs on the writer thread without the lock.
+ *        After a failed write the file offsets are unknown, so indexing stops; the index is rebuilt when loaded.
+ * @return True if the buffer was written completely.
+ */
+bool CaptureWriter::writeBuffer(size_t index) {
+    size_t bytes = m_fill[index];
+    if (std::fwrite(m_buffers[index].data(), 1, bytes, m_file) != bytes) {
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+        m_index.close(0);
+        return false;
+    }
+    m_bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Feeds the blocks of a buffer just written to the index builder.
+ */
+void CaptureWriter::indexBuffer(size_t index) {
+    const unsigned char* data = m_buffers[index].data();
+    const size_t bytes = m_fill[index];
+    for (size_t pos = 0; pos < bytes;) {
+        CaptureFormat::BlockHeader block;
+        std::memcpy(&block, data + pos, sizeof(block));
+        // Blocks are multiples of 4 bytes in a page-aligned buffer, so the payload is word-aligned.
+        m_index.addBlock(m_writeOffset + pos, block, reinterpret_cast<const AiUInt32*>(data + pos + sizeof(block)), block.payloadBytes / 4);
+        pos += sizeof(block) + block.payloadBytes;
+    }
+    m_writeOffset += bytes;
+}
+
+/**
+ * @brief Sets FLAG_CARD_FILTER in the file header if any block was captured with the card filter on,
+ *        which the header written at open cannot know when the filter changes during the recording.
+ *        Runs after the writer thread stopped.
+ */
+void CaptureWriter::updateHeaderFlags() {
+    if (!(m_blockFlagsSeen & CaptureFormat::BLOCK_FLAG_CARD_FILTER) || (m_header.flags & CaptureFormat::FLAG_CARD_FILTER)) return;
+    m_header.flags |= CaptureFormat::FLAG_CARD_FILTER;
+    if (std::fseek(m_file, 0, SEEK_SET) != 0 || std::fwrite(&m_header, sizeof(m_header), 1, m_file) != 1) {
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
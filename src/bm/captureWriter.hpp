@@ -0,0 +1,86 @@
+#pragma once
+
+#include "alignedBuffer.hpp"
+#include "captureFormat.hpp"
+#include "captureIndex.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Writes a binary capture file (see CaptureFormat) on its own thread.
+ *        The producer copies each block into one of a few large page-aligned buffers; full
+ *        buffers are written by the writer thread in a single unbuffered write each, and a
+ *        partially filled buffer is written at least every FLUSH_INTERVAL. The producer never
+ *        waits for the disk: if every buffer is still waiting to be written the block is dropped,
+ *        and the loss is recorded in the next block written so a reader sees the gap.
+ *        The writer thread also indexes every buffer it has written (see CaptureIndexBuilder),
+ *        so the index sidecar grows with the capture and never costs the producer anything.
+ */
+class CaptureWriter {
+public:
+    static constexpr size_t BUFFER_BYTES = 4 * 1024 * 1024;
+    static constexpr size_t BUFFER_COUNT = 4;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{1000};
+
+    CaptureWriter() = default;
+    ~CaptureWriter() { close(); }
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open(const std::string& path, const CaptureFormat::FileHeader& header, std::string& error);
+    void close();
+    bool isOpen() const { return m_open.load(std::memory_order_acquire); }
+
+    bool append(const void* payload, uint32_t bytes, uint64_t hostTimeNs, uint32_t lostBytesBefore, uint8_t gapReason, uint8_t flags = 0);
+
+    const std::string& path() const { return m_path; }
+    const std::string& indexError() const { return m_indexError; }
+    uint64_t bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    uint64_t blocksCaptured() const { return m_blocksCaptured.load(std::memory_order_relaxed); }
+    uint64_t droppedBlocks() const { return m_droppedBlocks.load(std::memory_order_relaxed); }
+    uint64_t droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+    uint64_t writeErrors() const { return m_writeErrors.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t NO_BUFFER = static_cast<size_t>(-1);
+
+    void writerThreadFunc();
+    bool writeBuffer(size_t index);
+    void indexBuffer(size_t index);
+    void updateHeaderFlags();
+
+    std::string m_path;
+    std::FILE* m_file = nullptr;
+    CaptureFormat::FileHeader m_header{};
+    std::thread m_thread;
+    std::atomic<bool> m_open{false};
+    CaptureIndexBuilder m_index;
+    std::string m_indexError;
+    uint64_t m_writeOffset = 0; // File offset of the next buffer written; writer thread only.
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopRequested = false;
+    std::vector<AlignedBuffer> m_buffers;
+    std::vector<size_t> m_fill;
+    std::vector<size_t> m_free;
+    std::deque<size_t> m_full;
+    size_t m_current = NO_BUFFER;
+    uint32_t m_pendingLostBytes = 0;
+    uint8_t m_pendingGapReason = 0;
+    uint8_t m_blockFlagsSeen = 0; // Union of the flags of every block appended.
+
+    std::atomic<uint64_t> m_bytesWritten{0};
+    std::atomic<uint64_t> m_blocksCaptured{0};
+    std::atomic<uint64_t> m_droppedBlocks{0};
+    std::atomic<uint64_t> m_droppedBytes{0};
+    std::atomic<uint64_t> m_writeErrors{0};
+};
@@ -0,0 +1,17 @@
+#include "commandWord.hpp"
+
+namespace {
+/**
+ * @brief Builds the descriptor of every possible command word.
+ */
+constexpr std::array<CommandWordDescriptor, CMD_WORD_TABLE_SIZE> buildCommandWordTable() {
+    std::array<CommandWordDescriptor, CMD_WORD_TABLE_SIZE> table{};
+    for (size_t cmd = 0; cmd < CMD_WORD_TABLE_SIZE; ++cmd) {
+        table[cmd] = makeCommandWordDescriptor(static_cast<AiUInt16>(cmd));
+    }
+    return table;
+}
+} // namespace
+
+// Evaluated by the compiler; the 256 KiB table lands in read-only data with no start-up cost.
+constexpr std::array<CommandWordDescriptor, CMD_WORD_TABLE_SIZE> CMD_WORD_TABLE = buildCommandWordTable();
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Api1553.h"
+#include <array>
+#include <cstddef>
+
+/**
+ * @brief What a single MIL-STD-1553 command word asks the addressed RT to do.
+ *        RT-to-RT transfers are a receive command followed by a transmit command,
+ *        so they only become visible once the second command word is known.
+ */
+enum class CommandKind : AiUInt8 {
+    RECEIVE,          // BC to RT (or the receiving half of RT to RT)
+    TRANSMIT,         // RT to BC (or the transmitting half of RT to RT)
+    MODE_CODE,        // Mode code without a data word
+    MODE_CODE_DATA    // Mode code 16-31, followed by exactly one data word
+};
+
+/**
+ * @brief Packed, precomputed description of one raw command word.
+ *        rtSaKey is (RT << 5) | SA and doubles as an index into per-RT/SA tables;
+ *        for mode codes SA is the mode code indicator (0 or 31) and the mode code
+ *        number lives in the word-count field.
+ */
+struct CommandWordDescriptor {
+    AiUInt16 rtSaKey;
+    AiUInt8  dataWords;   // Expected number of data words (0-32)
+    AiUInt8  info;        // Bits 0-1: CommandKind, bit 2: transmit, bits 3-7: word count / mode code field
+
+    int rt() const { return rtSaKey >> 5; }
+    int sa() const { return rtSaKey & 0x1F; }
+    CommandKind kind() const { return static_cast<CommandKind>(info & 0x3); }
+    bool isTransmit() const { return (info & 0x4) != 0; }
+    bool isModeCode() const { return kind() == CommandKind::MODE_CODE || kind() == CommandKind::MODE_CODE_DATA; }
+    int wordCountField() const { return info >> 3; }
+    int modeCode() const { return info >> 3; }
+};
+static_assert(sizeof(CommandWordDescriptor) == 4, "CommandWordDescriptor must stay packed");
+
+constexpr size_t CMD_WORD_TABLE_SIZE = 65536;
+
+/**
+ * @brief Computes the descriptor of a command word. Used to build CMD_WORD_TABLE at compile time.
+ * @param cmd The raw 16-bit command word.
+ * @return The packed descriptor.
+ */
+constexpr CommandWordDescriptor makeCommandWordDescriptor(AiUInt16 cmd) {
+    int rt = (cmd >> 11) & 0x1F;
+    int tr = (cmd >> 10) & 0x01;
+    int sa = (cmd >> 5) & 0x1F;
+    int wc = cmd & 0x1F;
+    bool modeCode = (sa == 0 || sa == 31);
+
+    CommandKind kind = tr ? CommandKind::TRANSMIT : CommandKind::RECEIVE;
+    int dataWords = (wc == 0) ? 32 : wc;
+    if (modeCode) {
+        kind = (wc >= 16) ? CommandKind::MODE_CODE_DATA : CommandKind::MODE_CODE;
+        dataWords = (wc >= 16) ? 1 : 0;
+    }
+    return CommandWordDescriptor{ static_cast<AiUInt16>((rt << 5) | sa), static_cast<AiUInt8>(dataWords),
+                                  static_cast<AiUInt8>(static_cast<int>(kind) | (tr << 2) | (wc << 3)) };
+}
+
+extern const std::array<CommandWordDescriptor, CMD_WORD_TABLE_SIZE> CMD_WORD_TABLE;
+
+/**
+ * @brief Looks up the precomputed descriptor of a command word.
+ */
+inline const CommandWordDescriptor& describeCommandWord(AiUInt16 cmd) { return CMD_WORD_TABLE[cmd]; }
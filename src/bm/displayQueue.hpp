@@ -0,0 +1,109 @@
+#pragma once
+
+#include "messageBatch.hpp"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Bounded hand-off of message batches from the decode thread to the UI.
+ *        The decode thread never waits for the UI: when the queue is full the oldest
+ *        queued batch is dropped (its storage goes back to the pool) and counted, so the
+ *        display stays current and memory stays bounded. Its gap markers are kept, and a display
+ *        drop marker stands in for its messages (see carryMarkers()). The UI drains it once per frame.
+ */
+class DisplayQueue {
+public:
+    explicit DisplayQueue(size_t maxBatches) : m_maxBatches(maxBatches ? maxBatches : 1) {}
+
+    /**
+     * @brief Queues a batch for display, dropping the oldest queued batch if the queue is full.
+     * @return False if a batch had to be dropped to make room.
+     */
+    bool push(MessageBatch&& batch) {
+        if (batch.empty()) return true;
+        MessageBatch dropped;
+        size_t droppedMessages = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queuedMessages.fetch_add(batch.size(), std::memory_order_relaxed);
+            if (m_batches.size() >= m_maxBatches) {
+                dropped = std::move(m_batches.front());
+                m_batches.pop_front();
+                droppedMessages = carryMarkers(dropped, m_batches.empty() ? batch : m_batches.front());
+            }
+            m_batches.push_back(std::move(batch));
+            if (m_batches.size() > m_highWaterMark.load(std::memory_order_relaxed)) {
+                m_highWaterMark.store(m_batches.size(), std::memory_order_relaxed);
+            }
+        }
+        if (dropped.empty()) return true;
+        m_droppedBatches.fetch_add(1, std::memory_order_relaxed);
+        m_droppedMessages.fetch_add(droppedMessages, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * @brief Moves every queued batch to the end of out, oldest first.
+     * @return The number of batches taken.
+     */
+    size_t drain(std::vector<MessageBatch>& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t taken = m_batches.size();
+        for (auto& batch : m_batches) { out.push_back(std::move(batch)); }
+        m_batches.clear();
+        return taken;
+    }
+
+    /**
+     * @brief Discards queued batches and resets the counters.
+     */
+    void reset() {
+        std::deque<MessageBatch> discarded;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            discarded.swap(m_batches);
+        }
+        m_queuedMessages.store(0); m_droppedMessages.store(0); m_droppedBatches.store(0); m_highWaterMark.store(0);
+    }
+
+    size_t maxBatches() const { return m_maxBatches; }
+    uint64_t queuedMessages() const { return m_queuedMessages.load(std::memory_order_relaxed); }
+    uint64_t droppedMessages() const { return m_droppedMessages.load(std::memory_order_relaxed); }
+    uint64_t droppedBatches() const { return m_droppedBatches.load(std::memory_order_relaxed); }
+    size_t highWaterMark() const { return m_highWaterMark.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Moves the gap markers of a dropped batch to the front of the next batch, followed by one display
+     *        drop marker for its messages, so the list still shows where data is missing. A display drop
+     *        marker already in the dropped batch is folded into the new one. Nothing is carried into a batch
+     *        of another replay seek epoch, which the UI does not show with the dropped one.
+     * @return The number of bus messages dropped.
+     */
+    size_t carryMarkers(const MessageBatch& dropped, MessageBatch& next) {
+        m_carried.clear();
+        size_t messages = 0;
+        AiUInt32 notDisplayed = 0;
+        for (const auto& trans : dropped) {
+            if (trans.isDisplayDrop()) { notDisplayed += trans.droppedMessages(); }
+            else if (trans.isGap()) { m_carried.push_back(trans); }
+            else { ++messages; }
+        }
+        if (next.epoch() != dropped.epoch()) return messages;
+        notDisplayed += static_cast<AiUInt32>(messages);
+        if (notDisplayed > 0) m_carried.push_back(MessageTransaction::makeDisplayDrop(dropped[dropped.size() - 1].header.full_timetag, notDisplayed));
+        next.prepend(m_carried.data(), m_carried.size());
+        return messages;
+    }
+
+    const size_t m_maxBatches;
+    std::mutex m_mutex;
+    std::deque<MessageBatch> m_batches;
+    std::vector<MessageTransaction> m_carried; // Scratch for carryMarkers(), reused under m_mutex.
+    std::atomic<uint64_t> m_queuedMessages{0};
+    std::atomic<uint64_t> m_droppedMessages{0};
+    std::atomic<uint64_t> m_droppedBatches{0};
+    std::atomic<size_t> m_highWaterMark{0};
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Log-linear histogram of latencies in microseconds (8 sub-buckets per power of two,
+ *        i.e. about 12% resolution) for p50/p99 reporting.
+ *        record() must only be called from one thread; the readers may run on any thread.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKETS = 8;
+    static constexpr int BUCKETS = 40 * SUB_BUCKETS;
+
+    static int bucketOf(uint64_t us) {
+        if (us < SUB_BUCKETS) return static_cast<int>(us);
+        int msb = 63 - __builtin_clzll(us);
+        int idx = (msb - 2) * SUB_BUCKETS + static_cast<int>((us >> (msb - 3)) & (SUB_BUCKETS - 1));
+        return idx < BUCKETS ? idx : BUCKETS - 1;
+    }
+
+    static uint64_t bucketLowerBound(int idx) {
+        if (idx < SUB_BUCKETS) return static_cast<uint64_t>(idx);
+        int msb = idx / SUB_BUCKETS + 2;
+        return static_cast<uint64_t>(SUB_BUCKETS + idx % SUB_BUCKETS) << (msb - 3);
+    }
+
+    void record(uint64_t us) {
+        std::atomic<uint64_t>& bucket = m_buckets[bucketOf(us)];
+        // Single writer: plain load/store avoids a locked instruction per sample.
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the lower bound of the bucket holding the given percentile (0-100), or 0 if empty.
+     */
+    uint64_t percentile(double p) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total - 1)) + 1, seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return bucketLowerBound(i);
+        }
+        return bucketLowerBound(BUCKETS - 1);
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    void reset() { for (auto& b : m_buckets) b.store(0); m_count.store(0); }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+};
+
+/**
+ * @brief Minimum of the host-minus-card clock offset over the last WINDOW_SECONDS of host time, kept in
+ *        one-second slots. The smallest offset stands for the fastest delivery; taking it over a sliding
+ *        window rather than the whole run keeps the drift between the unsynchronized card and host clocks
+ *        (tens of ppm) out of the latency. In exchange, latency that stays high for a whole window is
+ *        under-reported. Single thread.
+ */
+class OffsetWindowMin {
+public:
+    static constexpr int WINDOW_SECONDS = 10;
+
+    /**
+     * @brief Adds a sample and returns the minimum offset of the window that ends with it.
+     */
+    int64_t update(int64_t hostUs, int64_t offset) {
+        const int64_t slot = hostUs / SLOT_US;
+        if (!m_valid || slot < m_slot || slot - m_slot >= WINDOW_SECONDS) {
+            m_mins.fill(NONE);
+            m_valid = true;
+        } else {
+            for (int64_t s = m_slot + 1; s <= slot; ++s) m_mins[s % WINDOW_SECONDS] = NONE;
+        }
+        m_slot = slot;
+        int64_t& current = m_mins[slot % WINDOW_SECONDS];
+        current = std::min(current, offset);
+        return *std::min_element(m_mins.begin(), m_mins.end());
+    }
+
+    void reset() { m_valid = false; }
+
+private:
+    static constexpr int64_t SLOT_US = 1000000;
+    static constexpr int64_t NONE = std::numeric_limits<int64_t>::max();
+    std::array<int64_t, WINDOW_SECONDS> m_mins{};
+    int64_t m_slot = 0;
+    bool m_valid = false;
+};
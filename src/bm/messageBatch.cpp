@@ -0,0 +1,87 @@
+#include "messageBatch.hpp"
+#include <utility>
+
+/**
+ * @brief Wraps pooled storage into a batch. Only MessageBatchPool creates non-empty batches.
+ */
+MessageBatch::MessageBatch(std::vector<MessageTransaction>&& storage, size_t capacity, std::shared_ptr<MessageBatchPool> pool)
+    : m_records(std::move(storage)), m_capacity(capacity), m_pool(std::move(pool)) {}
+
+/**
+ * @brief Takes over the storage of another batch, leaving it empty and without storage.
+ */
+MessageBatch::MessageBatch(MessageBatch&& other) noexcept
+    : m_records(std::move(other.m_records)), m_capacity(other.m_capacity), m_epoch(other.m_epoch), m_pool(std::move(other.m_pool)) {
+    other.m_capacity = 0;
+}
+
+/**
+ * @brief Returns the current storage to its pool and takes over the storage of another batch.
+ */
+MessageBatch& MessageBatch::operator=(MessageBatch&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_records = std::move(other.m_records);
+        m_capacity = other.m_capacity;
+        m_epoch = other.m_epoch;
+        m_pool = std::move(other.m_pool);
+        other.m_capacity = 0;
+    }
+    return *this;
+}
+
+/**
+ * @brief Returns the record storage to the pool it came from.
+ */
+MessageBatch::~MessageBatch() { release(); }
+
+/**
+ * @brief Hands the storage back to the pool, if any, and leaves the batch empty.
+ */
+void MessageBatch::release() {
+    if (m_pool) { m_pool->recycle(std::move(m_records)); m_pool.reset(); }
+    m_records = std::vector<MessageTransaction>();
+    m_capacity = 0;
+    m_epoch = 0;
+}
+
+/**
+ * @brief Creates a pool. Pools are always shared so that in-flight batches can keep them alive.
+ * @param batchCapacity Number of records each batch can hold.
+ * @param maxPooled Maximum number of idle storage blocks kept for reuse.
+ */
+std::shared_ptr<MessageBatchPool> MessageBatchPool::create(size_t batchCapacity, size_t maxPooled) {
+    return std::shared_ptr<MessageBatchPool>(new MessageBatchPool(batchCapacity, maxPooled));
+}
+
+/**
+ * @brief Returns an empty batch, reusing idle storage when available.
+ */
+MessageBatch MessageBatchPool::acquire() {
+    std::vector<MessageTransaction> storage;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free.empty()) { storage = std::move(m_free.back()); m_free.pop_back(); }
+        else { ++m_allocated; }
+    }
+    if (storage.capacity() < m_batchCapacity) storage.reserve(m_batchCapacity);
+    return MessageBatch(std::move(storage), m_batchCapacity, shared_from_this());
+}
+
+/**
+ * @brief Returns the number of storage blocks this pool has allocated so far.
+ */
+size_t MessageBatchPool::allocatedBatches() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocated;
+}
+
+/**
+ * @brief Takes back the storage of a finished batch. Storage beyond maxPooled is freed.
+ */
+void MessageBatchPool::recycle(std::vector<MessageTransaction>&& storage) {
+    storage.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free.size() < m_maxPooled) { m_free.push_back(std::move(storage)); }
+    else if (m_allocated > 0) { --m_allocated; }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "streamDecoder.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class MessageBatchPool;
+
+/**
+ * @brief Move-only batch of decoded BM messages handed from the backend to the UI.
+ *        The record storage is borrowed from a MessageBatchPool and goes back to it
+ *        when the batch is destroyed, so steady-state operation does not allocate.
+ */
+class MessageBatch {
+public:
+    MessageBatch() = default;
+    MessageBatch(MessageBatch&& other) noexcept;
+    MessageBatch& operator=(MessageBatch&& other) noexcept;
+    MessageBatch(const MessageBatch&) = delete;
+    MessageBatch& operator=(const MessageBatch&) = delete;
+    ~MessageBatch();
+
+    /**
+     * @brief Appends a copy of a transaction.
+     * @return False if the batch is full (or has no storage) and the record was not added.
+     */
+    bool push(const MessageTransaction& trans) {
+        if (m_records.size() >= m_capacity) return false;
+        m_records.push_back(trans);
+        return true;
+    }
+
+    /**
+     * @brief Inserts records before the first one. Unlike push() this may exceed the capacity; it only
+     *        carries the few markers of a batch the display queue dropped into the next one.
+     */
+    void prepend(const MessageTransaction* records, size_t count) { m_records.insert(m_records.begin(), records, records + count); }
+
+    bool full() const { return m_records.size() >= m_capacity; }
+    bool empty() const { return m_records.empty(); }
+    size_t size() const { return m_records.size(); }
+    const MessageTransaction& operator[](size_t i) const { return m_records[i]; }
+    // Replay seek epoch of the messages (see BmPipelineStats::replaySeekEpoch); 0 for live monitoring.
+    uint32_t epoch() const { return m_epoch; }
+    void setEpoch(uint32_t epoch) { m_epoch = epoch; }
+    std::vector<MessageTransaction>::const_iterator begin() const { return m_records.begin(); }
+    std::vector<MessageTransaction>::const_iterator end() const { return m_records.end(); }
+
+private:
+    friend class MessageBatchPool;
+    MessageBatch(std::vector<MessageTransaction>&& storage, size_t capacity, std::shared_ptr<MessageBatchPool> pool);
+    void release();
+
+    std::vector<MessageTransaction> m_records;
+    size_t m_capacity = 0;
+    uint32_t m_epoch = 0;
+    std::shared_ptr<MessageBatchPool> m_pool;
+};
+
+/**
+ * @brief Recycles the record storage of MessageBatch objects.
+ *        Thread-safe: batches are acquired on the decode thread and released on the UI thread.
+ */
+class MessageBatchPool : public std::enable_shared_from_this<MessageBatchPool> {
+public:
+    static std::shared_ptr<MessageBatchPool> create(size_t batchCapacity, size_t maxPooled);
+
+    MessageBatch acquire();
+    size_t batchCapacity() const { return m_batchCapacity; }
+    size_t allocatedBatches() const;
+
+private:
+    friend class MessageBatch;
+    MessageBatchPool(size_t batchCapacity, size_t maxPooled) : m_batchCapacity(batchCapacity), m_maxPooled(maxPooled) {}
+    void recycle(std::vector<MessageTransaction>&& storage);
+
+    const size_t m_batchCapacity;
+    const size_t m_maxPooled;
+    mutable std::mutex m_mutex;
+    std::vector<std::vector<MessageTransaction>> m_free;
+    size_t m_allocated = 0;
+};
@@ -0,0 +1,328 @@
+#include "messageFilter.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+
+/**
+ * @brief Bus, RT, T/R and SA decoded from a bitmap key (bus << 11 | command word >> 5).
+ */
+struct KeyFields {
+    int bus, rt, transmit, sa;
+    explicit KeyFields(unsigned key) : bus(key >> 11), rt((key >> 6) & 0x1F), transmit((key >> 5) & 1), sa(key & 0x1F) {}
+    bool isModeCode() const { return sa == 0 || sa == 31; }
+};
+
+void setAll(MessageFilter::KeyBits& bits) { bits.fill(~uint64_t(0)); }
+
+MessageFilter::KeyBits keysWhere(const std::function<bool(const KeyFields&)>& pred) {
+    MessageFilter::KeyBits bits{};
+    for (unsigned key = 0; key < MessageFilter::KEY_COUNT; ++key) {
+        if (pred(KeyFields(key))) bits[key >> 6] |= uint64_t(1) << (key & 63);
+    }
+    return bits;
+}
+
+/**
+ * @brief One parsed term: the keys it can possibly accept and, if it needs more than the key, a predicate.
+ */
+struct Term {
+    MessageFilter::KeyBits keys{};
+    bool hasPredicate = false;
+    MessageFilter::Predicate predicate;
+};
+
+/**
+ * @brief Recursive-descent parser for filter expressions; see MessageFilter for the grammar.
+ */
+class Parser {
+public:
+    explicit Parser(const std::string& text) : m_text(text) {}
+
+    bool parse(std::vector<std::vector<Term>>& clauses, std::string& error) {
+        skipSpace();
+        if (atEnd()) { clauses.emplace_back(); return true; }
+        for (;;) {
+            std::vector<Term> clause;
+            if (!parseClause(clause)) { error = m_error; return false; }
+            clauses.push_back(std::move(clause));
+            skipSpace();
+            if (atEnd()) return true;
+            if (!consume("||") && !consumeWord("or")) { error = fail("expected '||'"); return false; }
+        }
+    }
+
+private:
+    bool parseClause(std::vector<Term>& clause) {
+        for (;;) {
+            skipSpace();
+            if (atEnd() || peek("||") || peekWord("or")) break;
+            if (!clause.empty() && (consume("&&") || consumeWord("and"))) skipSpace();
+            Term term;
+            if (!parseTerm(term)) return false;
+            clause.push_back(term);
+        }
+        if (clause.empty()) { fail("expected a filter term"); return false; }
+        return true;
+    }
+
+    bool parseTerm(Term& term) {
+        bool negate = consume("!");
+        skipSpace();
+        size_t start = m_pos;
+        std::string word;
+        while (!atEnd() && std::isalpha(static_cast<unsigned char>(m_text[m_pos]))) { word += static_cast<char>(std::tolower(static_cast<unsigned char>(m_text[m_pos++]))); }
+
+        MessageFilter::Predicate& p = term.predicate;
+        if (word == "bus") {
+            if (!expect("=")) return false;
+            skipSpace();
+            char c = atEnd() ? 0 : static_cast<char>(std::toupper(static_cast<unsigned char>(m_text[m_pos])));
+            if (c != 'A' && c != 'B') { fail("expected bus A or B"); return false; }
+            ++m_pos;
+            term.keys = keysWhere([c](const KeyFields& k) { return k.bus == (c == 'B'); });
+        } else if (word == "rt" || word == "sa" || word == "mc") {
+            if (!expect("=")) return false;
+            uint32_t set = 0;
+            if (!parseList(set)) return false;
+            if (word == "rt") { term.keys = keysWhere([set](const KeyFields& k) { return (set >> k.rt) & 1; }); }
+            else if (word == "sa") { term.keys = keysWhere([set](const KeyFields& k) { return !k.isModeCode() && ((set >> k.sa) & 1); }); }
+            else {
+                term.keys = keysWhere([](const KeyFields& k) { return k.isModeCode(); });
+                term.hasPredicate = true; p.kind = MessageFilter::Predicate::MODE_CODE; p.modeCodes = set;
+            }
+        } else if (word == "dir") {
+            if (!expect("=")) return false;
+            skipSpace();
+            char c = atEnd() ? 0 : static_cast<char>(std::toupper(static_cast<unsigned char>(m_text[m_pos])));
+            if (c != 'T' && c != 'R') { fail("expected direction T or R"); return false; }
+            ++m_pos;
+            term.keys = keysWhere([c](const KeyFields& k) { return k.transmit == (c == 'T'); });
+        } else if (word == "error" || word == "noresp") {
+            setAll(term.keys);
+            term.hasPredicate = true;
+            p.kind = word == "error" ? MessageFilter::Predicate::ERROR : MessageFilter::Predicate::NO_RESPONSE;
+        } else if (word == "status") {
+            setAll(term.keys);
+            term.hasPredicate = true; p.kind = MessageFilter::Predicate::STATUS_BITS; p.op = MessageFilter::Predicate::ANY_BIT;
+            long mask = 0, value = 0;
+            if (!expect("&") || !parseNumber(mask, 0xFFFF)) return false;
+            p.mask = static_cast<AiUInt16>(mask);
+            if (consume("=")) { if (!parseNumber(value, 0xFFFF)) return false; p.op = MessageFilter::Predicate::EQ; p.value = static_cast<AiUInt16>(value); }
+        } else if (word == "data") {
+            setAll(term.keys);
+            term.hasPredicate = true; p.kind = MessageFilter::Predicate::DATA_WORD;
+            long index = 0, mask = 0xFFFF, value = 0;
+            if (!expect("[") || !parseNumber(index, BM_MAX_DATA_WORDS - 1) || !expect("]")) return false;
+            if (consume("&") && !parseNumber(mask, 0xFFFF)) return false;
+            skipSpace();
+            if (consume("!=")) p.op = MessageFilter::Predicate::NE;
+            else if (consume("<=")) p.op = MessageFilter::Predicate::LE;
+            else if (consume(">=")) p.op = MessageFilter::Predicate::GE;
+            else if (consume("=")) p.op = MessageFilter::Predicate::EQ;
+            else if (consume("<")) p.op = MessageFilter::Predicate::LT;
+            else if (consume(">")) p.op = MessageFilter::Predicate::GT;
+            else { fail("expected a comparison"); return false; }
+            if (!parseNumber(value, 0xFFFF)) return false;
+            p.index = static_cast<uint8_t>(index); p.mask = static_cast<AiUInt16>(mask); p.value = static_cast<AiUInt16>(value);
+        } else {
+            m_pos = start;
+            fail(word.empty() ? "expected a filter term" : "unknown filter term '" + word + "'");
+            return false;
+        }
+
+        if (negate) {
+            if (term.hasPredicate) { setAll(term.keys); p.negate = true; }
+            else { for (auto& w : term.keys) w = ~w; }
+        }
+        return true;
+    }
+
+    bool parseList(uint32_t& set) {
+        do {
+            long first = 0, last = 0;
+            if (!parseNumber(first, 31)) return false;
+            last = first;
+            if (consume("-") && !parseNumber(last, 31)) return false;
+            if (last < first) { fail("empty range"); return false; }
+            for (long n = first; n <= last; ++n) set |= uint32_t(1) << n;
+        } while (consume(","));
+        return true;
+    }
+
+    bool parseNumber(long& value, long max) {
+        skipSpace();
+        const char* begin = m_text.c_str() + m_pos;
+        char* end = nullptr;
+        if (atEnd() || !std::isdigit(static_cast<unsigned char>(*begin))) { fail("expected a number"); return false; }
+        bool hex = begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X');
+        value = std::strtol(begin, &end, hex ? 16 : 10);
+        m_pos += static_cast<size_t>(end - begin);
+        if (value < 0 || value > max) { fail("number out of range (max " + std::to_string(max) + ")"); return false; }
+        return true;
+    }
+
+    bool expect(const char* token) { if (consume(token)) return true; fail(std::string("expected '") + token + "'"); return false; }
+
+    bool consume(const char* token) {
+        skipSpace();
+        if (!peek(token)) return false;
+        m_pos += std::char_traits<char>::length(token);
+        return true;
+    }
+
+    bool consumeWord(const char* word) {
+        skipSpace();
+        if (!peekWord(word)) return false;
+        m_pos += std::char_traits<char>::length(word);
+        return true;
+    }
+
+    bool peek(const char* token) const { return m_text.compare(m_pos, std::char_traits<char>::length(token), token) == 0; }
+
+    bool peekWord(const char* word) const {
+        size_t len = std::char_traits<char>::length(word);
+        if (m_pos + len > m_text.size()) return false;
+        for (size_t i = 0; i < len; ++i) { if (std::tolower(static_cast<unsigned char>(m_text[m_pos + i])) != word[i]) return false; }
+        return m_pos + len == m_text.size() || !std::isalnum(static_cast<unsigned char>(m_text[m_pos + len]));
+    }
+
+    void skipSpace() { while (!atEnd() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos; }
+    bool atEnd() const { return m_pos >= m_text.size(); }
+
+    std::string fail(const std::string& message) {
+        if (m_error.empty()) m_error = message + " at position " + std::to_string(m_pos + 1);
+        return m_error;
+    }
+
+    const std::string& m_text;
+    size_t m_pos = 0;
+    std::string m_error;
+};
+
+} // namespace
+
+/**
+ * @brief Evaluates a residual predicate against a message.
+ */
+bool MessageFilter::Predicate::evaluate(const MessageTransaction& trans) const {
+    bool result = false;
+    switch (kind) {
+        case MODE_CODE: {
+            const CommandWordDescriptor& cmd = describeCommandWord(trans.header.cmd1);
+            result = cmd.isModeCode() && ((modeCodes >> cmd.modeCode()) & 1);
+            break;
+        }
+        case ERROR: result = trans.errorValid(); break;
+        case NO_RESPONSE: result = !trans.stat1Valid(); break;
+        case STATUS_BITS:
+            result = trans.stat1Valid() && (op == ANY_BIT ? (trans.header.stat1 & mask) != 0 : (trans.header.stat1 & mask) == value);
+            break;
+        case DATA_WORD: {
+            if (index >= trans.dataCount()) break;
+            AiUInt16 word = trans.data_words[index] & mask;
+            switch (op) {
+                case EQ: result = word == value; break;
+                case NE: result = word != value; break;
+                case LT: result = word < value; break;
+                case GT: result = word > value; break;
+                case LE: result = word <= value; break;
+                case GE: result = word >= value; break;
+                default: break;
+            }
+            break;
+        }
+    }
+    return result != negate;
+}
+
+/**
+ * @brief Compiles a filter expression into an enabled filter.
+ * @param expression The expression text; an empty expression accepts every message.
+ * @param out Receives the compiled filter; left unchanged on error.
+ * @param error Receives a description of the first syntax error.
+ * @return True if the expression was valid.
+ */
+bool MessageFilter::compile(const std::string& expression, MessageFilter& out, std::string& error) {
+    std::vector<std::vector<Term>> clauses;
+    if (!Parser(expression).parse(clauses, error)) return false;
+
+    MessageFilter filter;
+    filter.m_enabled = true;
+    filter.m_expression = expression;
+    for (const auto& terms : clauses) {
+        ResidualClause clause;
+        setAll(clause.keys);
+        for (const auto& term : terms) {
+            for (size_t w = 0; w < clause.keys.size(); ++w) clause.keys[w] &= term.keys[w];
+            if (term.hasPredicate) clause.predicates.push_back(term.predicate);
+        }
+        if (clause.predicates.empty()) {
+            for (size_t w = 0; w < clause.keys.size(); ++w) filter.m_accept[w] |= clause.keys[w];
+        } else {
+            filter.m_residual.push_back(std::move(clause));
+        }
+    }
+    // Keys accepted outright never need the residual check.
+    for (auto& clause : filter.m_residual) {
+        for (size_t w = 0; w < clause.keys.size(); ++w) {
+            clause.keys[w] &= ~filter.m_accept[w];
+            filter.m_candidate[w] |= clause.keys[w];
+        }
+    }
+    out = std::move(filter);
+    return true;
+}
+
+/**
+ * @brief Builds the expression equivalent to a single Bus/RT/SA-or-MC selection from the tree.
+ *        -1 for rt/sa/mc or 0 for bus means 'any'; an SA selection takes precedence over an MC.
+ */
+std::string MessageFilter::criteriaExpression(char bus, int rt, int sa, int mc) {
+    std::string expr;
+    auto add = [&expr](const std::string& term) { if (!expr.empty()) expr += ' '; expr += term; };
+    if (bus != 0) add(std::string("bus=") + static_cast<char>(std::toupper(static_cast<unsigned char>(bus))));
+    if (rt != -1) add("rt=" + std::to_string(rt));
+    if (sa != -1) add("sa=" + std::to_string(sa));
+    else if (mc != -1) add("mc=" + std::to_string(mc));
+    return expr;
+}
+
+/**
+ * @brief Derives the selection the card can filter on: every RT/direction/SA (or mode code) that
+ *        the accept bitmap can pass on either bus. The result is a superset of the messages this
+ *        filter accepts, so the host filter still has the final say.
+ * @param out Receives the per-RT masks.
+ * @return False if the filter is disabled or selects every RT and SA, i.e. card filtering would not save anything.
+ */
+bool MessageFilter::cardFilter(CardFilter& out) const {
+    if (!m_enabled) return false;
+    out = CardFilter{};
+    for (unsigned key = 0; key < KEY_COUNT; ++key) {
+        if (!((m_accept[key >> 6] | m_candidate[key >> 6]) >> (key & 63) & 1)) continue;
+        KeyFields k(key);
+        CardFilterMasks& rt = out[k.rt];
+        (k.transmit ? rt.txSa : rt.rxSa) |= AiUInt32(1) << k.sa;
+        // The mode code number is in the word count field, which the key does not include.
+        if (k.isModeCode()) (k.transmit ? rt.txMc : rt.rxMc) = 0xFFFFFFFF;
+    }
+    for (const auto& rt : out) {
+        if (rt.rxSa != 0xFFFFFFFF || rt.txSa != 0xFFFFFFFF) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Slow path of accepts(): runs the residual clauses whose key set contains the message's key.
+ */
+bool MessageFilter::acceptsResidual(const MessageTransaction& trans, unsigned key) const {
+    const uint64_t bit = uint64_t(1) << (key & 63);
+    for (const auto& clause : m_residual) {
+        if (!(clause.keys[key >> 6] & bit)) continue;
+        bool passed = true;
+        for (const auto& p : clause.predicates) { if (!p.evaluate(trans)) { passed = false; break; } }
+        if (passed) return true;
+    }
+    return false;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "commandWord.hpp"
+#include "streamDecoder.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Immutable, compiled BM message filter.
+ *        A filter is never modified after it is published: the UI compiles a new one and
+ *        swaps it in, so the decode thread always sees a consistent filter.
+ *
+ *        Expressions are an OR of clauses, each clause an AND of terms:
+ *          expr   := clause { ("||" | "or") clause }
+ *          clause := term { ["&&" | "and"] term }
+ *          term   := ["!"] ( "bus=" A|B | "rt=" list | "sa=" list | "mc=" list | "dir=" T|R
+ *                          | "error" | "noresp" | "status&" mask ["=" value]
+ *                          | "data[" index "]" ["&" mask] ("="|"!="|"<"|">"|"<="|">=") value )
+ *          list   := n | n-m { "," ... }          numbers are decimal or 0x hex
+ *        e.g. "bus=A rt=1-4,7 sa=1,2 || rt=10 dir=T error || data[0]&0xFF00=0x1200"
+ *
+ *        sa= matches data subaddresses only (never mode codes); mc= matches mode codes only.
+ *        Terms on bus, RT, T/R and SA compile into a 2 x 2048-bit accept bitmap keyed on the
+ *        bus and the top 11 command word bits, so any number of such clauses costs one bit
+ *        test. Clauses with other terms mark their keys as candidates and are checked by a
+ *        residual evaluation for those keys only.
+ */
+class MessageFilter {
+public:
+    static constexpr int KEY_COUNT = 2 * 2048;
+    using KeyBits = std::array<uint64_t, KEY_COUNT / 64>;
+
+    /**
+     * @brief A term that cannot be decided from the bitmap key alone.
+     */
+    struct Predicate {
+        enum Kind : uint8_t { MODE_CODE, ERROR, NO_RESPONSE, STATUS_BITS, DATA_WORD };
+        enum Op : uint8_t { EQ, NE, LT, GT, LE, GE, ANY_BIT };
+        Kind kind = ERROR;
+        Op op = EQ;
+        bool negate = false;
+        uint8_t index = 0;
+        uint32_t modeCodes = 0;
+        AiUInt16 mask = 0xFFFF;
+        AiUInt16 value = 0;
+
+        bool evaluate(const MessageTransaction& trans) const;
+    };
+
+    /**
+     * @brief A clause with residual predicates, checked only for keys in its own key set.
+     */
+    struct ResidualClause {
+        KeyBits keys{};
+        std::vector<Predicate> predicates;
+    };
+
+    /**
+     * @brief Per-RT selection for the card's message filter (ApiCmdBMFilterIni); a set bit captures
+     *        that receive/transmit subaddress or mode code.
+     */
+    struct CardFilterMasks {
+        AiUInt32 rxSa = 0;
+        AiUInt32 txSa = 0;
+        AiUInt32 rxMc = 0;
+        AiUInt32 txMc = 0;
+    };
+    using CardFilter = std::array<CardFilterMasks, 32>;
+
+    /**
+     * @brief A disabled filter, which accepts every message.
+     */
+    MessageFilter() = default;
+
+    static bool compile(const std::string& expression, MessageFilter& out, std::string& error);
+    static std::string criteriaExpression(char bus, int rt, int sa, int mc);
+
+    MessageFilter withEnabled(bool enable) const { MessageFilter f = *this; f.m_enabled = enable; return f; }
+
+    bool isEnabled() const { return m_enabled; }
+    const std::string& expression() const { return m_expression; }
+    size_t residualClauseCount() const { return m_residual.size(); }
+    bool cardFilter(CardFilter& out) const;
+
+    static unsigned keyOf(const MessageTransaction& trans) {
+        return (trans.has(MSG_CMD1_BUS_B) ? 2048u : 0u) | (trans.header.cmd1 >> 5);
+    }
+
+    /**
+     * @brief Checks a message against the filter. The first command word must be valid.
+     */
+    bool accepts(const MessageTransaction& trans) const {
+        if (!m_enabled) return true;
+        const unsigned key = keyOf(trans);
+        const uint64_t bit = uint64_t(1) << (key & 63);
+        if (m_accept[key >> 6] & bit) return true;
+        if (!(m_candidate[key >> 6] & bit)) return false;
+        return acceptsResidual(trans, key);
+    }
+
+private:
+    bool acceptsResidual(const MessageTransaction& trans, unsigned key) const;
+
+    bool m_enabled = false;
+    std::string m_expression;
+    KeyBits m_accept{};
+    KeyBits m_candidate{};
+    std::vector<ResidualClause> m_residual;
+};
@@ -0,0 +1,96 @@
+#include "messageFormat.hpp"
+#include "commandWord.hpp"
+#include <cinttypes>
+#include <cstdio>
+
+/**
+ * @brief Returns the header text of a column of the single-line message view.
+ */
+const char* MessageFormat::columnTitle(Column column) {
+    switch (column) {
+        case COL_TIME: return "Time (us)";
+        case COL_BUS: return "Bus";
+        case COL_TYPE: return "Type";
+        case COL_SUBADDRESS: return "SA / MC";
+        case COL_STATUS: return "Status";
+        case COL_DATA: return "Data";
+        default: return "";
+    }
+}
+
+/**
+ * @brief Renders one column of a gap marker: where data was lost, how much and why, or how many
+ *        messages the display dropped.
+ */
+std::string MessageFormat::formatGapColumn(const MessageTransaction& trans, Column column) {
+    static const char* const reasons[] = {"local overflow", "remote overflow", "local buffer error", "remote buffer error", "ASP overflow", "byte count mismatch", "capture overrun", "monitor reconfigured"};
+    switch (column) {
+        case COL_TIME: {
+            if (trans.header.full_timetag == 0) return "<no timestamp>";
+            char tempBuf[32];
+            snprintf(tempBuf, sizeof(tempBuf), "%010" PRIu64, trans.header.full_timetag);
+            return tempBuf;
+        }
+        case COL_TYPE:
+            return trans.isDisplayDrop() ? "NOT DISPLAYED" : "DATA LOSS";
+        case COL_DATA: {
+            if (trans.isDisplayDrop()) return std::to_string(trans.droppedMessages()) + " messages not displayed (display fell behind)";
+            std::string out = trans.gapLostBytes() ? std::to_string(trans.gapLostBytes()) + " bytes lost" : "data lost";
+            std::string why;
+            for (size_t i = 0; i < sizeof(reasons) / sizeof(reasons[0]); ++i) {
+                if (trans.header.gap_reason & (1 << i)) { why += why.empty() ? "" : ", "; why += reasons[i]; }
+            }
+            if (!why.empty()) out += " (" + why + ")";
+            return out;
+        }
+        default:
+            return "";
+    }
+}
+
+/**
+ * @brief Renders one column of a message for the single-line message view.
+ *        Called lazily by the virtual list for visible rows only.
+ * @param trans The decoded message.
+ * @param column The column to render.
+ * @return The cell text.
+ */
+std::string MessageFormat::formatColumn(const MessageTransaction& trans, Column column) {
+    if (trans.isGap()) return formatGapColumn(trans, column);
+    if (!trans.cmd1Valid()) return "";
+    const CommandWordDescriptor& cmd = describeCommandWord(trans.header.cmd1);
+    char tempBuf[64];
+    switch (column) {
+        case COL_TIME:
+            if (trans.header.full_timetag == 0) return "<no timestamp>";
+            snprintf(tempBuf, sizeof(tempBuf), "%010" PRIu64, trans.header.full_timetag);
+            return tempBuf;
+        case COL_BUS:
+            return std::string(1, trans.bus1());
+        case COL_TYPE:
+            if (trans.cmd2Valid()) { snprintf(tempBuf, sizeof(tempBuf), "RT %d to RT %d", cmd.rt(), describeCommandWord(trans.header.cmd2).rt()); }
+            else if (!cmd.isTransmit()) { snprintf(tempBuf, sizeof(tempBuf), "BC to RT %d", cmd.rt()); }
+            else { snprintf(tempBuf, sizeof(tempBuf), "RT %d to BC", cmd.rt()); }
+            return tempBuf;
+        case COL_SUBADDRESS:
+            if (cmd.isModeCode()) { snprintf(tempBuf, sizeof(tempBuf), "MC: %d (Op %d)", cmd.sa(), cmd.modeCode()); }
+            else { snprintf(tempBuf, sizeof(tempBuf), "SA: %d WC: %d", cmd.sa(), cmd.wordCountField()); }
+            return tempBuf;
+        case COL_STATUS:
+            if (!trans.stat1Valid()) return "No Response";
+            if (trans.stat2Valid()) { snprintf(tempBuf, sizeof(tempBuf), "%04X %04X", trans.header.stat1, trans.header.stat2); }
+            else { snprintf(tempBuf, sizeof(tempBuf), "%04X", trans.header.stat1); }
+            return tempBuf;
+        case COL_DATA: {
+            std::string out;
+            out.reserve(cmd.dataWords * 5);
+            for (int i = 0; i < cmd.dataWords; ++i) {
+                snprintf(tempBuf, sizeof(tempBuf), "%04X ", i < trans.dataCount() ? trans.data_words[i] : 0);
+                out += tempBuf;
+            }
+            return out;
+        }
+        default:
+            return "";
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "streamDecoder.hpp"
+#include <string>
+
+/**
+ * @brief Text rendering of decoded BM messages.
+ *        Formatting is deliberately kept out of the capture path: the backend only
+ *        produces binary MessageTransaction records and the UI renders the rows it shows.
+ */
+namespace MessageFormat {
+    /**
+     * @brief Columns of the single-line message view.
+     */
+    enum Column { COL_TIME = 0, COL_BUS, COL_TYPE, COL_SUBADDRESS, COL_STATUS, COL_DATA, COL_COUNT };
+
+    std::string formatColumn(const MessageTransaction& trans, Column column);
+    std::string formatGapColumn(const MessageTransaction& trans, Column column);
+    const char* columnTitle(Column column);
+}
@@ -0,0 +1,55 @@
+#include "parallelCaptureDecoder.hpp"
+
+namespace {
+bool isTimetagWord(AiUInt32 word) {
+    const AiUInt32 type = word >> 28;
+    return type == 0x2 || type == 0x3;
+}
+} // namespace
+
+/**
+ * @brief Lists the monitor words of every complete block, pointing into the mapping.
+ *        Only the block headers are read here.
+ */
+std::vector<ParallelCaptureDecoder::Span> ParallelCaptureDecoder::collectSpans(const CaptureReader& reader) {
+    std::vector<Span> spans;
+    reader.forEachBlock(reader.firstBlockOffset(), reader.fileBytes(),
+                        [&spans](uint64_t, const CaptureFormat::BlockHeader& block, const AiUInt32* words, size_t count) {
+                            if (count > 0 || block.gapReason != 0) spans.push_back({words, static_cast<uint32_t>(count), block.lostBytesBefore, block.gapReason});
+                        });
+    return spans;
+}
+
+/**
+ * @brief Cuts the word stream into parts of at least partBytes, each starting at a timetag word.
+ *        Only the few words between a block boundary and the next timetag word are read.
+ * @param spans The blocks of the capture, in file order.
+ * @param partBytes The smallest part size in bytes; parts grow until the next timetag word.
+ * @return The parts in file order; together they cover every word exactly once.
+ */
+std::vector<ParallelCaptureDecoder::Part> ParallelCaptureDecoder::plan(const std::vector<Span>& spans, uint64_t partBytes) {
+    std::vector<Part> parts;
+    if (spans.empty()) return parts;
+    Part part;
+    uint64_t bytes = 0;
+    for (size_t s = 0; s < spans.size(); ++s) {
+        const size_t first = (s == part.firstSpan) ? part.firstWord : 0;
+        bytes += uint64_t(spans[s].count - first) * 4;
+        if (bytes < partBytes || s + 1 >= spans.size()) continue;
+        // Cut at the first timetag word after this block.
+        size_t cutSpan = s + 1, cutWord = 0;
+        while (cutSpan < spans.size() && !(cutWord < spans[cutSpan].count && isTimetagWord(spans[cutSpan].words[cutWord]))) {
+            if (++cutWord >= spans[cutSpan].count) { ++cutSpan; cutWord = 0; }
+        }
+        if (cutSpan >= spans.size()) break;
+        part.endSpan = cutSpan; part.endWord = cutWord;
+        parts.push_back(part);
+        part = Part();
+        part.firstSpan = cutSpan; part.firstWord = cutWord;
+        bytes = 0;
+        s = cutSpan - 1;
+    }
+    part.endSpan = spans.size(); part.endWord = 0;
+    parts.push_back(part);
+    return parts;
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "captureReader.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Decodes a whole capture on several threads for offline analysis.
+ *        The capture is cut into parts of about partBytes at resynchronization points: a timetag
+ *        word (type 0x2 or 0x3) always starts a new message, so a decoder started there produces
+ *        exactly the messages a sequential decode would. Workers decode parts straight from the
+ *        memory-mapped file into per-part vectors; the calling thread delivers the parts in file
+ *        order, which is time order, with at most 2 x threads parts decoded ahead to bound memory.
+ *        The high timetag word (type 0x3) is only written when it changes, about every 67 s of bus
+ *        time, so the one in force at a cut is usually far back. Workers therefore decode each part
+ *        with a provisional high word of 0 and record the last high word they see; on delivery the
+ *        timetags of the messages ahead of the part's first high word are completed from the parts
+ *        before it, which gives the same timetags as a sequential decode.
+ */
+class ParallelCaptureDecoder {
+public:
+    struct Options {
+        unsigned threads = 0;                     // 0 uses every hardware thread.
+        uint64_t partBytes = 32 * 1024 * 1024;
+    };
+
+    struct Result {
+        uint64_t messages = 0;                    // Messages (and gap markers) delivered.
+        uint64_t bytes = 0;                       // Monitor-word bytes decoded.
+        size_t parts = 0;
+        unsigned threads = 0;
+    };
+
+    /**
+     * @brief One block's monitor words inside the mapping.
+     */
+    struct Span {
+        const AiUInt32* words;
+        uint32_t count;
+        uint32_t lostBytesBefore;
+        uint8_t gapReason;
+    };
+
+    /**
+     * @brief A range of the word stream, from (firstSpan, firstWord) up to (endSpan, endWord).
+     */
+    struct Part {
+        size_t firstSpan = 0, firstWord = 0;
+        size_t endSpan = 0, endWord = 0;
+    };
+
+    /**
+     * @brief A decoded part. Timetags of the first `provisional` messages lack the high timetag word
+     *        (or are PROVISIONAL_TIMETAG for messages that inherit the previous part's last timetag).
+     */
+    struct DecodedPart {
+        std::vector<MessageTransaction> messages;
+        size_t provisional = 0;
+        uint64_t endTimetag = 0;       // The decoder's last timetag at the end of the part.
+        bool endTimetagExact = true;   // False if endTimetag was set before the part's first high word.
+        bool highKnown = false;        // A high timetag word is in force at the end of the part.
+        AiUInt32 high = 0;
+    };
+
+    static constexpr uint64_t PROVISIONAL_TIMETAG = UINT64_MAX;
+
+    static std::vector<Span> collectSpans(const CaptureReader& reader);
+    static std::vector<Part> plan(const std::vector<Span>& spans, uint64_t partBytes);
+
+    /**
+     * @brief Decodes the capture in parallel.
+     * @param reader An open capture.
+     * @param options Thread count and part size.
+     * @param accept Called on the worker threads for each decoded message; each worker uses its own copy.
+     *        Messages it rejects are dropped before they are stored. Gap markers are always kept. The
+     *        timetags it sees may still be provisional (see DecodedPart), so it must not filter on time.
+     * @param deliver Called on the calling thread for every kept message, in file order.
+     */
+    template <typename Accept, typename Deliver>
+    static Result decode(const CaptureReader& reader, const Options& options, const Accept& accept, Deliver&& deliver) {
+        Result result;
+        const std::vector<Span> spans = collectSpans(reader);
+        const std::vector<Part> parts = plan(spans, options.partBytes);
+        for (const Span& span : spans) result.bytes += uint64_t(span.count) * 4;
+        result.parts = parts.size();
+        if (parts.empty()) return result;
+        unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        result.threads = static_cast<unsigned>(std::min<size_t>(threads, parts.size()));
+        const size_t window = 2 * size_t(result.threads);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<DecodedPart> decoded(parts.size());
+        std::vector<char> done(parts.size(), 0);
+        size_t nextPart = 0, delivered = 0;
+
+        auto worker = [&, accept]() mutable {
+            while (true) {
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] { return nextPart >= parts.size() || nextPart < delivered + window; });
+                    if (nextPart >= parts.size()) return;
+                    index = nextPart++;
+                }
+                DecodedPart out;
+                decodePart(spans, parts[index], index == 0, accept, out);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    decoded[index] = std::move(out);
+                    done[index] = 1;
+                }
+                cv.notify_all();
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < result.threads; ++i) pool.emplace_back(worker);
+
+        // The high timetag word and last timetag in force at the end of the parts delivered so far.
+        TimetagState state;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            DecodedPart part;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return done[i] != 0; });
+                part = std::move(decoded[i]);
+                delivered = i + 1;
+            }
+            cv.notify_all();
+            for (size_t m = 0; m < part.provisional; ++m) part.messages[m].header.full_timetag = state.complete(part.messages[m].header.full_timetag);
+            state.advance(part);
+            for (const MessageTransaction& trans : part.messages) deliver(trans);
+            result.messages += part.messages.size();
+        }
+        for (std::thread& thread : pool) thread.join();
+        return result;
+    }
+
+    /**
+     * @brief Completes provisional timetags from the parts before, in delivery order.
+     */
+    struct TimetagState {
+        bool highKnown = false;
+        AiUInt32 high = 0;
+        uint64_t lastTimetag = 0;
+
+        uint64_t complete(uint64_t provisional) const {
+            if (provisional == PROVISIONAL_TIMETAG) return lastTimetag;
+            // Without any high word a sequential decode has no timetags at all.
+            return highKnown ? provisional | (uint64_t(high) << 26) : 0;
+        }
+        void advance(const DecodedPart& part) {
+            lastTimetag = part.endTimetagExact ? part.endTimetag : complete(part.endTimetag);
+            if (part.highKnown) { highKnown = true; high = part.high; }
+        }
+    };
+
+private:
+    /**
+     * @brief Decodes one part. Blocks that follow lost data get a gap marker, as in live decoding;
+     *        a part that starts inside a block leaves that block's gap to the part before it.
+     *        Every part but the first starts with a provisional high word of 0. Timetags are exact from
+     *        the first low timetag word after the part's first high word on; the messages completed
+     *        before that word are counted as provisional.
+     */
+    template <typename Accept>
+    static void decodePart(const std::vector<Span>& spans, const Part& part, bool first, Accept& accept, DecodedPart& out) {
+        Bm1553StreamDecoder decoder;
+        bool highSeen = first, exact = first;
+        if (!first) {
+            Bm1553StreamDecoder::ResumePoint provisional;
+            provisional.timetag = PROVISIONAL_TIMETAG;
+            provisional.timetagHighValid = true;
+            decoder.resume(provisional);
+        }
+        std::vector<MessageTransaction>& messages = out.messages;
+        auto collect = [&](const MessageTransaction& trans) { if (trans.cmd1Valid() && accept(trans)) messages.push_back(trans); };
+        for (size_t s = part.firstSpan; s < spans.size() && (s < part.endSpan || (s == part.endSpan && part.endWord > 0)); ++s) {
+            size_t from = (s == part.firstSpan) ? part.firstWord : 0;
+            const size_t to = (s == part.endSpan) ? part.endWord : spans[s].count;
+            if (from == 0 && spans[s].gapReason != 0) {
+                if (decoder.flush()) collect(decoder.completed());
+                messages.push_back(MessageTransaction::makeGap(decoder.lastTimetag(), spans[s].lostBytesBefore, spans[s].gapReason));
+            }
+            const AiUInt32* words = spans[s].words;
+            if (!exact) {
+                size_t w = from;
+                for (; w < to; ++w) {
+                    const AiUInt32 type = words[w] >> 28;
+                    if (!highSeen) highSeen = type == 0x3;
+                    else if (type == 0x2) break;
+                }
+                if (w < to) {
+                    // This low word completes the message before it, which is still provisional.
+                    decoder.feed(words + from, w + 1 - from, collect);
+                    from = w + 1;
+                    exact = true;
+                    out.provisional = messages.size();
+                }
+            }
+            decoder.feed(words + from, to - from, collect);
+        }
+        if (decoder.flush()) collect(decoder.completed());
+        if (!exact) out.provisional = messages.size();
+        const Bm1553StreamDecoder::ResumePoint end = decoder.resumePoint();
+        out.endTimetag = end.timetag;
+        out.endTimetagExact = exact;
+        out.highKnown = highSeen && end.timetagHighValid;
+        out.high = end.timetagHigh;
+    }
+};
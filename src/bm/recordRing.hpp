@@ -0,0 +1,59 @@
+#pragma once
+
+#include "streamDecoder.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Fixed-capacity ring of decoded messages that overwrites the oldest entry when full.
+ *        Indexing is oldest-first, which is what a virtual list control needs to render any
+ *        row on demand. Storage is allocated in chunks of CHUNK_ENTRIES as the ring fills and
+ *        is never moved or copied, so every append is O(1) and costs at most one chunk
+ *        allocation; the chunks are kept for reuse after clear(). Not thread-safe; owned by the UI thread.
+ */
+class RecordRing {
+public:
+    static constexpr size_t CHUNK_ENTRIES = 64 * 1024;
+
+    explicit RecordRing(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    void push(const MessageTransaction& trans) {
+        ++m_totalPushed;
+        if (m_size < m_capacity) {
+            if (m_size / CHUNK_ENTRIES == m_chunks.size()) {
+                const size_t entries = std::min(CHUNK_ENTRIES, m_capacity - m_size);
+                m_chunks.emplace_back(new MessageTransaction[entries]);
+            }
+            slot(m_size++) = trans;
+            return;
+        }
+        slot(m_start) = trans;
+        m_start = (m_start + 1 == m_capacity) ? 0 : m_start + 1;
+    }
+
+    /**
+     * @brief Returns the i-th retained message, 0 being the oldest.
+     */
+    const MessageTransaction& at(size_t i) const {
+        size_t idx = m_start + i;
+        return slot(idx >= m_capacity ? idx - m_capacity : idx);
+    }
+
+    void clear() { m_size = 0; m_start = 0; }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    uint64_t totalPushed() const { return m_totalPushed; }
+
+private:
+    MessageTransaction& slot(size_t idx) { return m_chunks[idx / CHUNK_ENTRIES][idx % CHUNK_ENTRIES]; }
+    const MessageTransaction& slot(size_t idx) const { return m_chunks[idx / CHUNK_ENTRIES][idx % CHUNK_ENTRIES]; }
+
+    std::vector<std::unique_ptr<MessageTransaction[]>> m_chunks;
+    size_t m_capacity;
+    size_t m_size = 0;
+    size_t m_start = 0;
+    uint64_t m_totalPushed = 0;
+};
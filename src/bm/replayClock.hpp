@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Paces the replay of a capture against the host clock.
+ *        Capture times (BlockHeader::hostTimeNs) are mapped onto wall-clock time from a base point,
+ *        scaled by the replay speed. The base is moved with rebase() whenever the mapping changes:
+ *        after a pause, a seek or a speed change, so playback continues from where it is without a jump.
+ */
+class ReplayClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Sets the playback speed: 1 is real time, 2 twice as fast; 0 (or less) replays as fast as possible.
+     *        Call rebase() afterwards to continue at the new speed from the current position.
+     */
+    void setSpeed(double speed) { m_speed = speed; }
+    double speed() const { return m_speed; }
+    bool unpaced() const { return m_speed <= 0; }
+
+    /**
+     * @brief Maps a capture time onto a host time point; later capture times are due relative to this one.
+     */
+    void rebase(uint64_t captureTimeNs, Clock::time_point now) {
+        m_baseCaptureNs = captureTimeNs;
+        m_baseHost = now;
+    }
+
+    /**
+     * @brief Returns how long to wait until a capture time is due; zero if it is due already, when
+     *        replaying as fast as possible, or for a time before the base (e.g. a clock step in the capture).
+     */
+    Clock::duration delayUntil(uint64_t captureTimeNs, Clock::time_point now) const {
+        if (unpaced() || captureTimeNs <= m_baseCaptureNs) return Clock::duration::zero();
+        const double scaledNs = static_cast<double>(captureTimeNs - m_baseCaptureNs) / m_speed;
+        const Clock::time_point due = m_baseHost + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::nano>(scaledNs));
+        return due > now ? due - now : Clock::duration::zero();
+    }
+
+private:
+    double m_speed = 1.0;
+    uint64_t m_baseCaptureNs = 0;
+    Clock::time_point m_baseHost{};
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of preallocated slots.
+ *        The producer fills a slot in place via beginWrite()/commitWrite() and the
+ *        consumer drains it via beginRead()/commitRead(), so no element is ever
+ *        copied or allocated after construction. Exactly one thread may produce
+ *        and exactly one thread may consume.
+ * @tparam T Slot type. Slots are default constructed once and reused forever.
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @brief Constructs the ring, rounding the capacity up to a power of two.
+     * @param capacity The minimum number of slots the ring must hold.
+     */
+    explicit SpscRing(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        m_slots.resize(rounded);
+        m_mask = rounded - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Gives the producer direct access to every slot, e.g. to preallocate buffers.
+     *        Must only be called while neither thread is using the ring.
+     */
+    std::vector<T>& slots() { return m_slots; }
+
+    /**
+     * @brief Returns the next free slot for the producer, or nullptr if the ring is full.
+     *        Each run of calls that find the ring full counts as one full episode, however
+     *        often the producer retries before the consumer frees a slot.
+     */
+    T* beginWrite() {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail > m_mask) {
+            if (!m_producerBlocked) { m_producerBlocked = true; m_fullEpisodes.fetch_add(1, std::memory_order_relaxed); }
+            return nullptr;
+        }
+        m_producerBlocked = false;
+        return &m_slots[head & m_mask];
+    }
+
+    /**
+     * @brief Publishes the slot obtained from beginWrite() to the consumer.
+     */
+    void commitWrite() {
+        const size_t head = m_head.load(std::memory_order_relaxed) + 1;
+        m_head.store(head, std::memory_order_release);
+        const size_t used = head - m_tail.load(std::memory_order_acquire);
+        if (used > m_highWaterMark.load(std::memory_order_relaxed)) {
+            m_highWaterMark.store(used, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Returns the oldest filled slot for the consumer, or nullptr if the ring is empty.
+     */
+    T* beginRead() {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return nullptr;
+        return &m_slots[tail & m_mask];
+    }
+
+    /**
+     * @brief Returns the slot obtained from beginRead() to the producer.
+     */
+    void commitRead() { m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    /**
+     * @brief Discards all queued slots and resets the statistics.
+     *        Must only be called while neither thread is using the ring.
+     */
+    void reset() {
+        m_head.store(0); m_tail.store(0);
+        m_highWaterMark.store(0); m_fullEpisodes.store(0); m_producerBlocked = false;
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+    size_t size() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire); }
+    size_t highWaterMark() const { return m_highWaterMark.load(std::memory_order_relaxed); }
+    size_t fullEpisodes() const { return m_fullEpisodes.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> m_slots;
+    size_t m_mask = 0;
+
+    // Producer and consumer indices live on separate cache lines to avoid false sharing.
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::atomic<size_t> m_highWaterMark{0};
+    std::atomic<size_t> m_fullEpisodes{0};
+    bool m_producerBlocked = false; // Producer only: the last beginWrite() found the ring full.
+};
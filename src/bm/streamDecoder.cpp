@@ -0,0 +1,59 @@
+#include "streamDecoder.hpp"
+
+/**
+ * @brief Finalizes the pending transaction, e.g. when the bus goes idle or monitoring stops.
+ * @return True if a transaction was pending and is now available through completed().
+ */
+bool Bm1553StreamDecoder::flush() {
+    if (current().isEmpty()) return false;
+    complete();
+    return true;
+}
+
+/**
+ * @brief Discards all decoder state, including the latched timetag words.
+ */
+void Bm1553StreamDecoder::reset() {
+    m_transactions[0].clear();
+    m_transactions[1].clear();
+    m_currentIndex = 0;
+    m_timetagHigh = 0;
+    m_timetagHighValid = false;
+    m_lastFullTimetag = 0;
+}
+
+/**
+ * @brief Hands the current transaction over to completed() and starts a fresh one.
+ *        Messages without their own timetag inherit the last one seen on the stream.
+ *        Only the header of the new transaction is reset; stale data words beyond
+ *        data_count are never read.
+ */
+void Bm1553StreamDecoder::complete() {
+    if (current().header.full_timetag == 0) current().header.full_timetag = m_lastFullTimetag;
+    m_currentIndex ^= 1;
+    current().clear();
+}
+
+/**
+ * @brief Captures the state a decoder needs to continue from this point in the stream, so decoding
+ *        can later start here without the words before it (e.g. at an index entry of a capture).
+ *        Words of a message in progress are not included; they belong to the decoding before this point.
+ */
+Bm1553StreamDecoder::ResumePoint Bm1553StreamDecoder::resumePoint() const {
+    ResumePoint point;
+    point.timetag = current().header.full_timetag ? current().header.full_timetag : m_lastFullTimetag;
+    point.timetagHigh = m_timetagHigh;
+    point.timetagHighValid = m_timetagHighValid;
+    return point;
+}
+
+/**
+ * @brief Discards all state and continues from a point captured with resumePoint().
+ */
+void Bm1553StreamDecoder::resume(const ResumePoint& point) {
+    reset();
+    current().header.full_timetag = point.timetag;
+    m_lastFullTimetag = point.timetag;
+    m_timetagHigh = point.timetagHigh;
+    m_timetagHighValid = point.timetagHighValid;
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Api1553.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+constexpr int BM_MAX_DATA_WORDS = 32;
+
+/**
+ * @brief Validity and bus flags of a MessageHeader.
+ */
+enum MessageFlags : AiUInt16 {
+    MSG_CMD1_VALID    = 1 << 0,
+    MSG_CMD2_VALID    = 1 << 1,
+    MSG_STAT1_VALID   = 1 << 2,
+    MSG_STAT2_VALID   = 1 << 3,
+    MSG_ERROR_VALID   = 1 << 4,
+    MSG_CMD1_BUS_B    = 1 << 5,
+    MSG_CMD2_BUS_B    = 1 << 6,
+    MSG_STAT1_BUS_B   = 1 << 7,
+    MSG_STAT2_BUS_B   = 1 << 8,
+    MSG_DATA_OVERFLOW = 1 << 9, // More than BM_MAX_DATA_WORDS data words were seen; the excess was dropped.
+    MSG_GAP           = 1 << 10, // Not a bus message: marks data lost between the card and the host (see GapReason).
+    MSG_DISPLAY_DROP  = 1 << 11  // With MSG_GAP: marks messages the display queue dropped because the UI fell behind.
+};
+
+/**
+ * @brief Why a gap marker was inserted; stored in MessageHeader::gap_reason.
+ */
+enum GapReason : AiUInt8 {
+    GAP_LOCAL_OVERFLOW   = 1 << 0, // API_DATA_QUEUE_STATUS_LOC_OVERFLOW
+    GAP_REMOTE_OVERFLOW  = 1 << 1, // API_DATA_QUEUE_STATUS_REM_OVERFLOW
+    GAP_LOCAL_BUF_ERR    = 1 << 2, // API_DATA_QUEUE_STATUS_LOC_BUF_ERR
+    GAP_REMOTE_BUF_ERR   = 1 << 3, // API_DATA_QUEUE_STATUS_REM_BUF_ERR
+    GAP_ASP_OVERFLOW     = 1 << 4, // API_DATA_QUEUE_STATUS_ASP_OVERFLOW
+    GAP_BYTE_COUNT       = 1 << 5, // The driver transferred more bytes than the host received.
+    GAP_CAPTURE_OVERRUN  = 1 << 6, // The capture file writer fell behind and dropped data.
+    GAP_RECONFIGURE      = 1 << 7  // The monitor was halted to switch capture mode; traffic in between was not recorded.
+};
+
+/**
+ * @brief Fixed-size, trivially copyable summary of one monitored message.
+ */
+struct MessageHeader {
+    uint64_t full_timetag;
+    AiUInt16 cmd1;
+    AiUInt16 cmd2;
+    AiUInt16 stat1;
+    AiUInt16 stat2;
+    AiUInt32 error_word;
+    AiUInt16 flags;
+    AiUInt8  data_count;
+    AiUInt8  gap_reason; // GapReason bits; only used by MSG_GAP records.
+};
+static_assert(std::is_trivially_copyable<MessageHeader>::value, "MessageHeader must be trivially copyable");
+static_assert(sizeof(MessageHeader) == 24, "MessageHeader layout changed");
+
+/**
+ * @brief One assembled MIL-STD-1553 message as seen by the Bus Monitor.
+ *        The data words are stored inline, so assembling a message never allocates.
+ */
+struct MessageTransaction {
+    MessageHeader header;
+    std::array<AiUInt16, BM_MAX_DATA_WORDS> data_words;
+
+    void clear() { header = MessageHeader{}; }
+    bool isEmpty() const { return (header.flags & (MSG_CMD1_VALID | MSG_CMD2_VALID | MSG_STAT1_VALID | MSG_ERROR_VALID)) == 0 && header.data_count == 0; }
+    bool has(AiUInt16 flag) const { return (header.flags & flag) != 0; }
+
+    bool cmd1Valid() const { return has(MSG_CMD1_VALID); }
+    bool cmd2Valid() const { return has(MSG_CMD2_VALID); }
+    bool stat1Valid() const { return has(MSG_STAT1_VALID); }
+    bool stat2Valid() const { return has(MSG_STAT2_VALID); }
+    bool errorValid() const { return has(MSG_ERROR_VALID); }
+    char bus1() const { return has(MSG_CMD1_BUS_B) ? 'B' : 'A'; }
+    char bus2() const { return has(MSG_CMD2_BUS_B) ? 'B' : 'A'; }
+    int dataCount() const { return header.data_count; }
+
+    /**
+     * @brief Gap marker records: error_word holds the number of lost bytes (0 if unknown),
+     *        or for display drop markers the number of messages not displayed.
+     */
+    bool isGap() const { return has(MSG_GAP); }
+    bool isDisplayDrop() const { return has(MSG_DISPLAY_DROP); }
+    AiUInt32 gapLostBytes() const { return header.error_word; }
+    AiUInt32 droppedMessages() const { return header.error_word; }
+    static MessageTransaction makeGap(uint64_t timetag, AiUInt32 lostBytes, AiUInt8 reason) {
+        MessageTransaction gap;
+        gap.clear();
+        gap.header.full_timetag = timetag;
+        gap.header.flags = MSG_GAP;
+        gap.header.error_word = lostBytes;
+        gap.header.gap_reason = reason;
+        return gap;
+    }
+    static MessageTransaction makeDisplayDrop(uint64_t timetag, AiUInt32 messages) {
+        MessageTransaction drop = makeGap(timetag, messages, 0);
+        drop.header.flags |= MSG_DISPLAY_DROP;
+        return drop;
+    }
+};
+static_assert(std::is_trivially_copyable<MessageTransaction>::value, "MessageTransaction must be trivially copyable");
+
+/**
+ * @brief Converts a full BM timetag (IRIG day/hour/minute/second/microsecond fields,
+ *        high word << 26 | low word) to microseconds since the start of the year.
+ */
+inline uint64_t timetagMicroseconds(uint64_t fullTimetag) {
+    const uint64_t us = fullTimetag & 0xFFFFF, sec = (fullTimetag >> 20) & 0x3F, min = (fullTimetag >> 26) & 0x3F;
+    const uint64_t hour = (fullTimetag >> 32) & 0x1F, day = (fullTimetag >> 37) & 0x1FF;
+    return us + 1000000ull * (sec + 60ull * (min + 60ull * (hour + 24ull * day)));
+}
+
+/**
+ * @brief Resumable decoder for the AIM BM recording stream.
+ *        Turns raw 32-bit monitor words into MessageTransaction objects. All state -
+ *        the partially assembled transaction and the latched timetag words - lives in
+ *        the instance, so a message split across two data-queue reads is reassembled
+ *        correctly and several decoders can run side by side. Decoding does no heap allocation.
+ */
+class Bm1553StreamDecoder {
+public:
+    Bm1553StreamDecoder() { reset(); }
+
+    /**
+     * @brief Feeds a span of monitor words and invokes the handler for every completed transaction.
+     *        A transaction still open at the end of the span is kept for the next call.
+     * @param words Pointer to the raw monitor words.
+     * @param count Number of monitor words in the span.
+     * @param onTransaction Callable taking a const MessageTransaction&.
+     */
+    template <typename Handler>
+    void feed(const AiUInt32* words, size_t count, Handler&& onTransaction) {
+        for (size_t i = 0; i < count; ++i) {
+            if (consume(words[i])) onTransaction(completed());
+        }
+    }
+
+    bool consume(AiUInt32 monitorWord);
+    bool flush();
+    bool hasPending() const { return !current().isEmpty(); }
+    const MessageTransaction& completed() const { return m_transactions[m_currentIndex ^ 1]; }
+    uint64_t lastTimetag() const { return m_lastFullTimetag; }
+
+    /**
+     * @brief Decoder state carried from one message to the next: the latched high timetag word and
+     *        the timetag the next message gets unless it has its own.
+     */
+    struct ResumePoint {
+        uint64_t timetag = 0;
+        AiUInt32 timetagHigh = 0;
+        bool timetagHighValid = false;
+    };
+    ResumePoint resumePoint() const;
+    void resume(const ResumePoint& point);
+    void reset();
+
+private:
+    MessageTransaction& current() { return m_transactions[m_currentIndex]; }
+    const MessageTransaction& current() const { return m_transactions[m_currentIndex]; }
+    void complete();
+
+    // Double buffer: completing a transaction flips the index instead of copying it.
+    MessageTransaction m_transactions[2];
+    unsigned m_currentIndex = 0;
+    AiUInt32 m_timetagHigh = 0;
+    bool m_timetagHighValid = false;
+    uint64_t m_lastFullTimetag = 0;
+};
+
+/**
+ * @brief Applies a single monitor word to the decoder state machine.
+ *        A new transaction is demarcated by a timetag or command word. When one is encountered,
+ *        the previously assembled transaction is finalized and made available through completed().
+ *        The card writes an error word after the words of the erroneous message, so it belongs to
+ *        the transaction being assembled; only a second error word starts a transaction of its own.
+ *        Defined inline because it runs once per monitor word inside feed().
+ * @param monitorWord The raw 32-bit monitor word from the BM data queue.
+ * @return True if a transaction was completed by this word, false otherwise.
+ */
+inline bool Bm1553StreamDecoder::consume(AiUInt32 monitorWord) {
+    AiUInt8 type = (monitorWord >> 28) & 0x0F;
+    AiUInt32 entryData = monitorWord & 0x07FFFFFF;
+    AiUInt16 busWord = entryData & 0xFFFF;
+
+    bool isNewMessageStart = (type == 0x2 || type == 0x3 || type == 0x8 || type == 0xC) || (type == 0x1 && current().errorValid());
+    bool completedOne = false;
+    if (isNewMessageStart && !current().isEmpty()) {
+        complete();
+        completedOne = true;
+    }
+
+    MessageHeader& h = current().header;
+    switch (type) {
+        case 0x1: h.flags |= MSG_ERROR_VALID; h.error_word = entryData; break;
+        case 0x2:
+            // The high timetag word is latched across messages and chunks; each low word completes a timetag.
+            if (m_timetagHighValid) {
+                h.full_timetag = ((uint64_t)m_timetagHigh << 26) | (entryData & 0x03FFFFFF);
+                m_lastFullTimetag = h.full_timetag;
+            }
+            break;
+        case 0x3: m_timetagHigh = entryData & 0x000FFFFF; m_timetagHighValid = true; break;
+        case 0x8: case 0x9: case 0xA: case 0xB: case 0xC: case 0xD: case 0xE: case 0xF: {
+            bool busB = (type > 0xB);
+            switch (type & 0x3) {
+                case 0x0: h.cmd1 = busWord; h.flags |= MSG_CMD1_VALID | (busB ? MSG_CMD1_BUS_B : 0); break;
+                case 0x1: h.cmd2 = busWord; h.flags |= MSG_CMD2_VALID | (busB ? MSG_CMD2_BUS_B : 0); break;
+                case 0x2:
+                    if (h.data_count < BM_MAX_DATA_WORDS) { current().data_words[h.data_count++] = busWord; }
+                    else { h.flags |= MSG_DATA_OVERFLOW; }
+                    break;
+                case 0x3:
+                    if (!(h.flags & MSG_STAT1_VALID)) {
+                        h.stat1 = busWord; h.flags |= MSG_STAT1_VALID | (busB ? MSG_STAT1_BUS_B : 0);
+                    } else {
+                        h.stat2 = busWord; h.flags |= MSG_STAT2_VALID | (busB ? MSG_STAT2_BUS_B : 0);
+                    }
+                    break;
+            }
+            break;
+        }
+        default: break; // Ignore unused or reserved types.
+    }
+    return completedOne;
+}
@@ -5,6 +5,24 @@
 #include <fstream>
 #include <string>
 #include <wx/arrstr.h> 
+#include <memory>
+#include <algorithm>
+#include <wx/filedlg.h>
+
+namespace {
+// Replay speeds offered in the speed choice; 0 replays as fast as possible.
+const double REPLAY_SPEEDS[] = {0.5, 1, 2, 5, 10, 100, 0};
+const int REPLAY_SLIDER_STEPS = 1000;
+
+/**
+ * @brief Formats a time from the start of a capture as H:MM:SS.
+ */
+wxString formatReplayTime(uint64_t ns) {
+    uint64_t seconds = ns / 1000000000ull;
+    return wxString::Format("%llu:%02u:%02u", static_cast<unsigned long long>(seconds / 3600),
+                            static_cast<unsigned>(seconds / 60 % 60), static_cast<unsigned>(seconds % 60));
+}
+} // namespace
 
 
 // Event table for connecting UI events to their handler functions.
@@ -18,7 +36,16 @@ wxBEGIN_EVENT_TABLE(BusMonitorFrame, wxFrame)
     EVT_BUTTON(ID_CLEAR_BTN, BusMonitorFrame::onClearClicked)
     EVT_MENU(wxID_EXIT, BusMonitorFrame::onExit)
     EVT_TREE_ITEM_ACTIVATED(ID_RT_SA_TREE, BusMonitorFrame::onTreeItemClicked)
+    EVT_TEXT_ENTER(ID_FILTER_EXPR_TXT, BusMonitorFrame::onFilterExpressionEntered)
     EVT_CHECKBOX(ID_LOG_TO_FILE_CHECKBOX, BusMonitorFrame::onLogToFileToggled)
+    EVT_TIMER(ID_ACTIVITY_TIMER, BusMonitorFrame::onActivityTimer)
+    EVT_TIMER(ID_REFRESH_TIMER, BusMonitorFrame::onRefreshTimer)
+    EVT_TIMER(ID_STATISTICS_TIMER, BusMonitorFrame::onStatisticsTimer)
+    EVT_MENU(ID_OPEN_CAPTURE_MENU, BusMonitorFrame::onOpenCaptureClicked)
+    EVT_BUTTON(ID_REPLAY_PAUSE_BTN, BusMonitorFrame::onReplayPauseClicked)
+    EVT_CHOICE(ID_REPLAY_SPEED_CHOICE, BusMonitorFrame::onReplaySpeedChanged)
+    EVT_COMMAND_SCROLL_THUMBTRACK(ID_REPLAY_SLIDER, BusMonitorFrame::onReplaySliderTracking)
+    EVT_COMMAND_SCROLL_CHANGED(ID_REPLAY_SLIDER, BusMonitorFrame::onReplaySliderChanged)
     EVT_CLOSE(BusMonitorFrame::onCloseFrame)
 wxEND_EVENT_TABLE()
 
@@ -28,7 +55,11 @@ wxEND_EVENT_TABLE()
  *        and establishes communication with the backend BM singleton.
  */
 BusMonitorFrame::BusMonitorFrame() : wxFrame(nullptr, wxID_ANY, "MIL-STD-1553 Bus Monitor") {
-    // 1. --- UI Component Creation and Layout ---
+    // 1. --- Configuration Loading ---
+    // Loaded first because several controls are sized from it.
+    loadConfiguration();
+
+    // 2. --- UI Component Creation and Layout ---
     // This section follows the standard wxWidgets pattern: create controls,
     // arrange them in sizers, and then set the top-level sizer for the frame.
     // std::cout << "--- PATH DEBUGGING ---" << std::endl;
@@ -41,6 +72,7 @@ BusMonitorFrame::BusMonitorFrame() : wxFrame(nullptr, wxID_ANY, "MIL-STD-1553 Bu
     menuFile->Append(ID_ADD_MENU, "Start / Stop\tCtrl-R", "Start or stop monitoring");
     menuFile->Append(ID_FILTER_MENU, "Clear filter\tCtrl-F", "Clear filtering of messages");
     menuFile->Append(ID_CLEAR_MENU, "Clear messages\tCtrl-M", "Clear messages");
+    menuFile->Append(ID_OPEN_CAPTURE_MENU, "Open Capture...\tCtrl-O", "Replay a recorded capture file");
     menuFile->AppendSeparator();
     menuFile->Append(wxID_EXIT);
     auto *menuBar = new wxMenuBar;
@@ -49,11 +81,18 @@ BusMonitorFrame::BusMonitorFrame() : wxFrame(nullptr, wxID_ANY, "MIL-STD-1553 Bu
 
     // --- Top Control Bar ---
     auto *deviceIdText = new wxStaticText(this, wxID_ANY, "AIM Device ID:");
-    m_deviceIdTextInput = new wxTextCtrl(this, ID_DEVICE_ID_TXT, "0", wxDefaultPosition, wxSize(40, TOP_BAR_COMP_HEIGHT));
+    m_deviceIdTextInput = new wxTextCtrl(this, ID_DEVICE_ID_TXT, std::to_string(m_defaultDeviceNum), wxDefaultPosition, wxSize(40, TOP_BAR_COMP_HEIGHT));
     m_startStopButton = new wxButton(this, ID_ADD_BTN, "Start", wxDefaultPosition, wxSize(100, TOP_BAR_COMP_HEIGHT));
     m_startStopButton->SetBackgroundColour(wxColour("#ffcc00"));
     m_filterButton = new wxButton(this, ID_FILTER_BTN, "No filter set. Click a tree item to filter.", wxDefaultPosition, wxSize(-1, TOP_BAR_COMP_HEIGHT));
     m_filterButton->Enable(false);
+    auto *filterExprText = new wxStaticText(this, wxID_ANY, "Filter:");
+    m_filterExpressionInput = new wxTextCtrl(this, ID_FILTER_EXPR_TXT, "", wxDefaultPosition, wxSize(280, TOP_BAR_COMP_HEIGHT), wxTE_PROCESS_ENTER);
+    m_filterExpressionInput->SetHint("e.g. bus=A rt=1-4 sa=2 || rt=5 error");
+    m_filterExpressionInput->SetToolTip("Filter expression, applied with Enter.\n"
+                                        "Terms: bus=A|B rt=list sa=list mc=list dir=T|R error noresp\n"
+                                        "       status&MASK[=VALUE] data[i][&MASK](=|!=|<|>|<=|>=)VALUE\n"
+                                        "Combine with && (or a space) and ||, negate with !. Lists: 1-4,7");
     auto *clearButton = new wxButton(this, ID_CLEAR_BTN, "Clear", wxDefaultPosition, wxSize(-1, TOP_BAR_COMP_HEIGHT));
     m_logToFileCheckBox = new wxCheckBox(this, ID_LOG_TO_FILE_CHECKBOX, "Log to File"); 
 
@@ -86,128 +125,180 @@ BusMonitorFrame::BusMonitorFrame() : wxFrame(nullptr, wxID_ANY, "MIL-STD-1553 Bu
     }
 
     // --- Message List (Log) Setup ---
-    m_messageList = new wxTextCtrl(this, wxID_ANY, "", wxDefaultPosition, wxDefaultSize, wxTE_MULTILINE | wxTE_READONLY | wxHSCROLL | wxTE_DONTWRAP);
-    wxFont font(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
-    m_messageList->SetFont(font);
+    // A virtual list renders only the visible rows from an in-memory ring of decoded messages.
+    m_messageList = new MessageListCtrl(this, wxID_ANY, m_uiRecentMessageCount);
+
+    // --- Statistics Panel ---
+    // Per Bus/RT/SA counters of all decoded traffic, independent of the host message filter. With card
+    // filtering (Card_Filtering) the card drops excluded traffic, so the panel then counts only what passed.
+    m_statisticsList = new StatisticsListCtrl(this, wxID_ANY);
+
+    // --- Replay Controls ---
+    // Shown only while a capture file is replayed (File > Open Capture).
+    auto *replayText = new wxStaticText(this, wxID_ANY, "Replay:");
+    m_replayPauseButton = new wxButton(this, ID_REPLAY_PAUSE_BTN, "Pause", wxDefaultPosition, wxSize(100, TOP_BAR_COMP_HEIGHT));
+    wxArrayString speedLabels;
+    for (double speed : REPLAY_SPEEDS) speedLabels.Add(speed > 0 ? wxString::Format("%gx", speed) : wxString("Max"));
+    m_replaySpeedChoice = new wxChoice(this, ID_REPLAY_SPEED_CHOICE, wxDefaultPosition, wxDefaultSize, speedLabels);
+    m_replaySpeedChoice->SetSelection(1);
+    m_replaySlider = new wxSlider(this, ID_REPLAY_SLIDER, 0, 0, REPLAY_SLIDER_STEPS);
+    m_replayPositionText = new wxStaticText(this, wxID_ANY, "0:00:00 / 0:00:00");
 
     // --- Sizer Layout ---
     auto *topHorizontalSizer = new wxBoxSizer(wxHORIZONTAL);
     topHorizontalSizer->Add(deviceIdText, 0, wxALIGN_CENTER_VERTICAL | wxLEFT | wxRIGHT, 5);
     topHorizontalSizer->Add(m_deviceIdTextInput, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
     topHorizontalSizer->Add(m_startStopButton, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    topHorizontalSizer->Add(filterExprText, 0, wxALIGN_CENTER_VERTICAL | wxLEFT | wxRIGHT, 5);
+    topHorizontalSizer->Add(m_filterExpressionInput, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
     topHorizontalSizer->Add(m_filterButton, 1, wxALIGN_CENTER_VERTICAL | wxALL, 5);
     topHorizontalSizer->Add(m_logToFileCheckBox, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5); 
     topHorizontalSizer->Add(clearButton, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
     auto *bottomHorizontalSizer = new wxBoxSizer(wxHORIZONTAL);
     bottomHorizontalSizer->Add(m_milStd1553Tree, 0, wxEXPAND | wxALL, 5); 
+    bottomHorizontalSizer->Add(m_statisticsList, 0, wxEXPAND | wxALL, 5);
     bottomHorizontalSizer->Add(m_messageList, 1, wxEXPAND | wxALL, 5);   
-    auto *mainVerticalSizer = new wxBoxSizer(wxVERTICAL);
-    mainVerticalSizer->Add(topHorizontalSizer, 0, wxEXPAND | wxALL, 5);
-    mainVerticalSizer->Add(bottomHorizontalSizer, 1, wxEXPAND | wxALL, 5);
-
-    SetSizer(mainVerticalSizer);
-    SetMinSize(wxSize(800, 600)); 
+    m_replaySizer = new wxBoxSizer(wxHORIZONTAL);
+    m_replaySizer->Add(replayText, 0, wxALIGN_CENTER_VERTICAL | wxLEFT | wxRIGHT, 5);
+    m_replaySizer->Add(m_replayPauseButton, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    m_replaySizer->Add(m_replaySpeedChoice, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    m_replaySizer->Add(m_replaySlider, 1, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    m_replaySizer->Add(m_replayPositionText, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+    m_mainSizer = new wxBoxSizer(wxVERTICAL);
+    m_mainSizer->Add(topHorizontalSizer, 0, wxEXPAND | wxALL, 5);
+    m_mainSizer->Add(m_replaySizer, 0, wxEXPAND | wxLEFT | wxRIGHT, 5);
+    m_mainSizer->Add(bottomHorizontalSizer, 1, wxEXPAND | wxALL, 5);
+    m_mainSizer->Show(m_replaySizer, false);
+
+    SetSizer(m_mainSizer);
+    SetMinSize(wxSize(1200, 600)); 
     Centre();
-    CreateStatusBar();
+    CreateStatusBar(3);
+    const int statusWidths[3] = {-1, 560, 260};
+    SetStatusWidths(3, statusWidths);
     SetStatusText("Ready, press Start");
 
-// In src/bm/ui/mainWindow.cpp
-
-        // 2. --- Configuration Loading ---
-        m_uiRecentMessageCount = 2000; // Start with a default
-        int defaultDeviceNum = 0;      // Start with a default
-
-        std::string configPath = Common::getConfigPath();
-        std::ifstream ifs(configPath);
-
-        if (ifs.is_open()) {
-            try {
-                nlohmann::json configJson;
-                ifs >> configJson;
-                Logger::info("Successfully opened and parsed " + configPath);
-
-                // Check for and read Bus Monitor settings
-                if (configJson.contains("Bus_Monitor")) {
-                    const auto& bmConfig = configJson["Bus_Monitor"];
-                    
-                    if (bmConfig.contains("Default_Device_Number")) {
-                        defaultDeviceNum = bmConfig.value("Default_Device_Number", 0);
-                        Logger::info("Loaded Default_Device_Number: " + std::to_string(defaultDeviceNum));
-                    }
-                    
-                    if (bmConfig.contains("UI_Recent_Line_Count")) {
-                        m_uiRecentMessageCount = bmConfig.value("UI_Recent_Line_Count", 2000);
-                        Logger::info("Loaded UI_Recent_Line_Count: " + std::to_string(m_uiRecentMessageCount));
-                    }
-                }
-            } catch (const nlohmann::json::parse_error &e) {
-                Logger::error("JSON parse error in " + configPath + ": " + std::string(e.what()));
-            }
-        } else {
-            Logger::info("Config file not found: " + configPath + ". Using defaults.");
-        }
-
-        // Now, apply the loaded (or default) value to the UI text input
-        m_deviceIdTextInput->SetValue(std::to_string(defaultDeviceNum));
-    // ...
-    
     // 3. --- Backend Communication Setup ---
-    // Sets up callback functions to receive data from the BM backend.
-    // CRITICAL: Uses wxTheApp->CallAfter to safely marshal calls from the BM's
-    // worker thread to the main UI thread, preventing race conditions and crashes.
+    // Sets up timers that pull data from the BM backend on the main UI thread.
+    // The backend's worker threads never call into the UI, so a slow UI cannot
+    // stall capture and no GUI events pile up while the bus is busy.
 
     /**
-    * @brief Callback to receive formatted message strings from the backend.
+    * @brief Frame timer that pulls decoded messages from the backend.
     * 
-    * This lambda is passed to the BM singleton. When the backend has new data,
-    * it invokes this callback. The call is marshaled to the main UI thread
-    * via wxTheApp->CallAfter to safely update the message list.
+    * The backend queues binary message batches in a bounded display queue and never
+    * waits for the UI. This timer drains the queue at UI_Refresh_Hz and appends all
+    * batches of a frame to the list in one update; if the UI falls behind, the backend
+    * drops the oldest batches and the counters are shown in the status bar.
     */
-    BM::getInstance().setUpdateMessagesCallback(
-        [this](const std::string& messages) {
-            wxTheApp->CallAfter([this, messages] {
-                appendMessagesToUi(wxString::FromUTF8(messages.c_str()));
-            });
-        }
-    );
-// In BusMonitorFrame::BusMonitorFrame()
+    m_refreshTimer.SetOwner(this, ID_REFRESH_TIMER);
+    m_refreshTimer.Start(1000 / m_uiRefreshHz);
 
-// ...
+    /**
+    * @brief Timer that applies Bus/RT/SA activity to the tree view.
+    * 
+    * The backend only sets bits in its activity bitmap; this timer takes the bitmap
+    * at UI_Activity_Refresh_Hz and highlights the items that became active, so the
+    * GUI event queue sees one update per item instead of one per message.
+    */
+    m_activityTimer.SetOwner(this, ID_ACTIVITY_TIMER);
+    m_activityTimer.Start(1000 / m_activityRefreshHz);
 
-// 3. --- Backend Communication Setup ---
-// Sets up callback functions to receive data from the BM backend.
-// CRITICAL: Uses wxTheApp->CallAfter to safely marshal calls from the BM's
-// worker thread to the main UI thread, preventing race conditions and crashes.
+    /**
+    * @brief Timer that refreshes the statistics panel.
+    * 
+    * The decode thread counts every message in the backend's statistics table without
+    * locking; this timer copies a consistent snapshot at UI_Statistics_Refresh_Hz.
+    */
+    m_statisticsTimer.SetOwner(this, ID_STATISTICS_TIMER);
+    m_statisticsTimer.Start(1000 / m_statisticsRefreshHz);
+}
 
 /**
- * @brief Callback to receive formatted message strings from the backend.
- * 
- * This lambda is passed to the BM singleton. When the backend has new data,
- * it invokes this callback. The call is marshaled to the main UI thread
- * via wxTheApp->CallAfter to safely update the message list.
+ * @brief Loads the Bus Monitor section of config.json, falling back to defaults
+ *        for any missing value or if the file cannot be read.
  */
- BM::getInstance().setUpdateMessagesCallback(
-    [this](const std::string& messages) {
-        wxTheApp->CallAfter([this, messages] {
-            appendMessagesToUi(wxString::FromUTF8(messages.c_str()));
-        });
-    }
-);
+void BusMonitorFrame::loadConfiguration() {
+    m_uiRecentMessageCount = 1000000; // Start with a default
+    m_activityRefreshHz = 10;         // Start with a default
+    m_uiRefreshHz = 30;               // Start with a default
+    m_statisticsRefreshHz = 2;        // Start with a default
+    m_cardFiltering = false;          // Start with a default
+    m_useInterrupts = true;           // Start with a default
+    m_minReadBytes = 0;               // 0 = backend default
+    m_maxReadBytes = 0;               // 0 = backend default
+    m_defaultDeviceNum = 0;           // Start with a default
+    m_deviceBackend = AimDevice::HARDWARE; // Start with a default
+
+    std::string configPath = Common::getConfigPath();
+    std::ifstream ifs(configPath);
+
+    if (ifs.is_open()) {
+        try {
+            nlohmann::json configJson;
+            ifs >> configJson;
+            Logger::info("Successfully opened and parsed " + configPath);
+
+            // Check for and read Bus Monitor settings
+            if (configJson.contains("Bus_Monitor")) {
+                const auto& bmConfig = configJson["Bus_Monitor"];
+                
+                if (bmConfig.contains("Default_Device_Number")) {
+                    m_defaultDeviceNum = bmConfig.value("Default_Device_Number", 0);
+                    Logger::info("Loaded Default_Device_Number: " + std::to_string(m_defaultDeviceNum));
+                }
+                
+                if (bmConfig.contains("UI_Recent_Message_Count")) {
+                    m_uiRecentMessageCount = bmConfig.value("UI_Recent_Message_Count", 1000000);
+                    Logger::info("Loaded UI_Recent_Message_Count: " + std::to_string(m_uiRecentMessageCount));
+                }
 
-    /**
-    * @brief Callback to receive active terminal information for visual updates.
-    * 
-    * This lambda is invoked by the backend whenever a new terminal becomes active.
-    * It passes the bus/RT/SA coordinates, which are then used to highlight the
-    * corresponding item in the UI's tree view, again safely via wxTheApp->CallAfter.
-    */
-    BM::getInstance().setUpdateTreeItemCallback(
-        [this](char bus, int rt, int sa, bool isActive) {
-            wxTheApp->CallAfter([this, bus, rt, sa, isActive] {
-                updateTreeItemVisualState(bus, rt, sa, isActive);
-            });
+                if (bmConfig.contains("UI_Activity_Refresh_Hz")) {
+                    m_activityRefreshHz = std::max(1, std::min(100, bmConfig.value("UI_Activity_Refresh_Hz", 10)));
+                    Logger::info("Loaded UI_Activity_Refresh_Hz: " + std::to_string(m_activityRefreshHz));
+                }
+
+                if (bmConfig.contains("UI_Refresh_Hz")) {
+                    m_uiRefreshHz = std::max(1, std::min(100, bmConfig.value("UI_Refresh_Hz", 30)));
+                    Logger::info("Loaded UI_Refresh_Hz: " + std::to_string(m_uiRefreshHz));
+                }
+
+                if (bmConfig.contains("UI_Statistics_Refresh_Hz")) {
+                    m_statisticsRefreshHz = std::max(1, std::min(20, bmConfig.value("UI_Statistics_Refresh_Hz", 2)));
+                    Logger::info("Loaded UI_Statistics_Refresh_Hz: " + std::to_string(m_statisticsRefreshHz));
+                }
+
+                if (bmConfig.contains("Card_Filtering")) {
+                    m_cardFiltering = bmConfig.value("Card_Filtering", false);
+                    Logger::info(std::string("Loaded Card_Filtering: ") + (m_cardFiltering ? "true" : "false"));
+                }
+
+                if (bmConfig.contains("Use_BM_Interrupts")) {
+                    m_useInterrupts = bmConfig.value("Use_BM_Interrupts", true);
+                    Logger::info(std::string("Loaded Use_BM_Interrupts: ") + (m_useInterrupts ? "true" : "false"));
+                }
+
+                if (bmConfig.contains("Min_Read_Bytes")) {
+                    m_minReadBytes = std::max(0, bmConfig.value("Min_Read_Bytes", 0));
+                    Logger::info("Loaded Min_Read_Bytes: " + std::to_string(m_minReadBytes));
+                }
+
+                if (bmConfig.contains("Max_Read_Bytes")) {
+                    m_maxReadBytes = std::max(0, bmConfig.value("Max_Read_Bytes", 0));
+                    Logger::info("Loaded Max_Read_Bytes: " + std::to_string(m_maxReadBytes));
+                }
+
+                if (bmConfig.contains("Device_Backend")) {
+                    m_deviceBackend = bmConfig.value("Device_Backend", std::string(AimDevice::HARDWARE));
+                    Logger::info("Loaded Device_Backend: " + m_deviceBackend);
+                }
+            }
+        } catch (const nlohmann::json::parse_error &e) {
+            Logger::error("JSON parse error in " + configPath + ": " + std::string(e.what()));
         }
-    );
+    } else {
+        Logger::info("Config file not found: " + configPath + ". Using defaults.");
+    }
 }
 
 /**
@@ -217,22 +308,92 @@ BusMonitorFrame::BusMonitorFrame() : wxFrame(nullptr, wxID_ANY, "MIL-STD-1553 Bu
 BusMonitorFrame::~BusMonitorFrame() {}
 
 /**
- * @brief Appends a new chunk of messages to the UI's message list.
- *        To prevent performance degradation from an infinitely growing text control,
- *        this function trims the oldest lines if the total line count exceeds
- *        the configured `m_uiRecentMessageCount`.
- * @param newMessagesChunk The new block of formatted text to add.
+ * @brief Appends the batches of decoded messages received in one frame to the UI's message list.
+ *        The virtual list stores the binary records in its ring (overwriting the oldest
+ *        beyond `m_uiRecentMessageCount`) and formats rows only when they are drawn.
+ * @param batches The batches of binary message records to add, oldest first.
  */
-void BusMonitorFrame::appendMessagesToUi(const wxString& newMessagesChunk) {
-    m_messageList->AppendText(newMessagesChunk);
-    int lines = m_messageList->GetNumberOfLines();
-    if (lines > m_uiRecentMessageCount) {
-        int linesToRemove = lines - m_uiRecentMessageCount;
-        long pos = m_messageList->XYToPosition(0, linesToRemove);
-        if (pos > 0) {
-            m_messageList->Remove(0, pos);
-        }
+void BusMonitorFrame::appendMessagesToUi(const std::vector<MessageBatch>& batches) {
+    m_messageList->appendBatches(batches);
+}
+
+/**
+ * @brief Frame timer handler: drains the backend's display queue and refreshes the list once.
+ *        The batches are released right after, returning their storage to the backend's pool.
+ *        Also ends the run if the backend reports that acquisition failed on the card.
+ */
+void BusMonitorFrame::onRefreshTimer(wxTimerEvent &) {
+    // A replay seek clears the list once the decoder has reached the new position; batches still queued
+    // from the old position are dropped.
+    uint32_t epoch = BM::getInstance().getPipelineStats().replaySeekEpoch;
+    if (BM::getInstance().takeDisplayBatches(m_frameBatches) > 0) {
+        for (const auto& batch : m_frameBatches) epoch = std::max(epoch, batch.epoch());
+    }
+    if (epoch != m_listEpoch) {
+        m_messageList->clearMessages();
+        resetTreeVisualState();
+        m_listEpoch = epoch;
+    }
+    if (!m_frameBatches.empty()) {
+        m_frameBatches.erase(std::remove_if(m_frameBatches.begin(), m_frameBatches.end(),
+                                            [this](const MessageBatch& batch) { return batch.epoch() != m_listEpoch; }),
+                             m_frameBatches.end());
+        appendMessagesToUi(m_frameBatches);
+        m_frameBatches.clear();
+    }
+    updateDisplayStatus();
+    AiReturn acquisitionError = BM::getInstance().acquisitionError();
+    if (acquisitionError != API_OK && BM::getInstance().isMonitoring()) {
+        // The card failed: release it now rather than leaving a dead run for the Stop button.
+        stopRun();
+        std::string errorString = getAIMApiErrorMessage(acquisitionError);
+        SetStatusText(("Monitoring stopped by a card error: " + errorString).c_str());
+        wxMessageBox("Bus Monitor acquisition failed: " + errorString, "Error", wxOK | wxICON_ERROR, this);
+    }
+}
+
+/**
+ * @brief Statistics timer handler: shows the backend's current per Bus/RT/SA counters.
+ */
+void BusMonitorFrame::onStatisticsTimer(wxTimerEvent &) {
+    BM::getInstance().getStatistics(m_statisticsRows);
+    m_statisticsList->setCardFiltered(BM::getInstance().getPipelineStats().cardFilterActive);
+    m_statisticsList->updateStatistics(m_statisticsRows);
+}
+
+/**
+ * @brief Shows the data queue rate, delivery latency and the display queue counters in the second status bar field when they change,
+ *        and any data loss since the last Start in the third.
+ */
+void BusMonitorFrame::updateDisplayStatus() {
+    BmPipelineStats stats = BM::getInstance().getPipelineStats();
+    wxString text = wxString::Format("Queue: %.1f KB/s%s  Messages: %llu", stats.dataQueueBytesPerSec / 1024.0,
+                                     stats.cardFilterActive ? " (card filter)" : "",
+                                     static_cast<unsigned long long>(stats.displayQueuedMessages));
+    if (stats.latencySamples > 0) {
+        // Relative to the fastest delivery of a sliding window, not to a synchronized clock (see OffsetWindowMin).
+        text += wxString::Format("  Latency p50/p99: %.1f/%.1f ms (vs %d s min)", stats.latencyP50Us / 1000.0, stats.latencyP99Us / 1000.0,
+                                 OffsetWindowMin::WINDOW_SECONDS);
+    }
+    if (stats.captureActive) {
+        text += wxString::Format("  Capture: %.1f MB", stats.captureBytesWritten / (1024.0 * 1024.0));
+    }
+    if (stats.displayDroppedMessages > 0) {
+        text += wxString::Format("  UI dropped: %llu (%llu batches)", static_cast<unsigned long long>(stats.displayDroppedMessages),
+                                 static_cast<unsigned long long>(stats.displayDroppedBatches));
     }
+    if (text != m_displayStatusText) {
+        m_displayStatusText = text;
+        SetStatusText(text, 1);
+    }
+    if (stats.replayActive) updateReplayControls(stats);
+
+    // Loss stays visible after Stop so it cannot be missed; it is reset by the next Start.
+    uint64_t gaps = stats.lossGaps - m_lossGapsAtStart;
+    if (gaps == 0 || gaps == m_shownLossGaps) return;
+    m_shownLossGaps = gaps;
+    SetStatusText(wxString::Format("DATA LOSS: %llu gaps, %llu bytes", static_cast<unsigned long long>(gaps),
+                                   static_cast<unsigned long long>(stats.lostBytes - m_lostBytesAtStart)), 2);
 }
 
 /**
@@ -266,6 +427,24 @@ void BusMonitorFrame::updateTreeItemVisualState(char bus, int rt, int sa, bool i
     } 
 }
 
+/**
+ * @brief Timer handler that applies the Bus/RT/SA activity collected by the backend.
+ *        Items already highlighted are skipped, so a busy terminal costs nothing here.
+ */
+void BusMonitorFrame::onActivityTimer(wxTimerEvent &) {
+    ActivityBitmap::Snapshot active;
+    if (!BM::getInstance().takeActivity(active)) return;
+    for (int w = 0; w < ActivityBitmap::WORDS; ++w) {
+        uint64_t changed = active[w] & ~m_shownActivity[w];
+        m_shownActivity[w] |= changed;
+        while (changed) {
+            int bit = (w << 6) | __builtin_ctzll(changed);
+            changed &= changed - 1;
+            updateTreeItemVisualState((bit >> 10) ? 'B' : 'A', (bit >> 5) & 0x1F, bit & 0x1F, true);
+        }
+    }
+}
+
 /**
  * @brief Event handler for the Start/Stop button and menu item.
  *        Toggles the monitoring state of the BM backend and updates the UI accordingly.
@@ -273,13 +452,8 @@ void BusMonitorFrame::updateTreeItemVisualState(char bus, int rt, int sa, bool i
 void BusMonitorFrame::onStartStopClicked(wxCommandEvent &) {
     if (BM::getInstance().isMonitoring()) {
         SetStatusText("Stopping monitoring...");
-        BM::getInstance().stop();
-        m_startStopButton->SetLabelText("Start");
-        m_startStopButton->SetBackgroundColour(wxColour("#ffcc00"));
-        SetStatusText("Monitoring stopped. Ready to start.");
-        m_deviceIdTextInput->Enable(true);
-        wxCommandEvent emptyEvent;
-        onClearFilterClicked(emptyEvent);
+        bool wasReplaying = stopRun();
+        SetStatusText(wasReplaying ? "Replay stopped. Ready to start." : "Monitoring stopped. Ready to start.");
     } else {
         long deviceNumLong = -1;
         if (!m_deviceIdTextInput->GetValue().ToLong(&deviceNumLong) || deviceNumLong < 0) {
@@ -290,16 +464,20 @@ void BusMonitorFrame::onStartStopClicked(wxCommandEvent &) {
         bool shouldLogData = m_logToFileCheckBox->IsChecked();
         BM::getInstance().enableDataLogging(shouldLogData);
         if (shouldLogData) {
-            Logger::info("Monitoring started with data logging ENABLED.");
+            Logger::info("Monitoring started with binary capture ENABLED.");
         }
 
-        resetTreeVisualState();
-        m_messageList->Clear();
+        resetRunState();
 
         ConfigBmUi bmConfig;
         bmConfig.ulDevice = static_cast<AiUInt32>(deviceNumLong);
         bmConfig.ulStream = 1; 
         bmConfig.ulCoupling = API_CAL_CPL_TRANSFORM;
+        bmConfig.cardFiltering = m_cardFiltering;
+        bmConfig.useInterrupts = m_useInterrupts;
+        bmConfig.minReadBytes = static_cast<AiUInt32>(m_minReadBytes);
+        bmConfig.maxReadBytes = static_cast<AiUInt32>(m_maxReadBytes);
+        bmConfig.deviceBackend = m_deviceBackend;
 
         SetStatusText("Starting monitoring on device " + m_deviceIdTextInput->GetValue() + "...");
         AiReturn bmStartRet = BM::getInstance().start(bmConfig);
@@ -319,6 +497,135 @@ void BusMonitorFrame::onStartStopClicked(wxCommandEvent &) {
     }
 }
 
+/**
+ * @brief Stops the backend and returns the controls to their idle state.
+ * @return True if the run was a replay.
+ */
+bool BusMonitorFrame::stopRun() {
+    bool wasReplaying = BM::getInstance().isReplaying();
+    BM::getInstance().stop();
+    if (wasReplaying) showReplayControls(false);
+    m_startStopButton->SetLabelText("Start");
+    m_startStopButton->SetBackgroundColour(wxColour("#ffcc00"));
+    m_deviceIdTextInput->Enable(true);
+    wxCommandEvent emptyEvent;
+    onClearFilterClicked(emptyEvent);
+    return wasReplaying;
+}
+
+/**
+ * @brief Clears the messages, tree highlighting and data loss display before a new run or replay.
+ */
+void BusMonitorFrame::resetRunState() {
+    resetTreeVisualState();
+    m_messageList->clearMessages();
+    m_statisticsList->clearStatistics();
+    BmPipelineStats statsAtStart = BM::getInstance().getPipelineStats();
+    m_lossGapsAtStart = statsAtStart.lossGaps;
+    m_lostBytesAtStart = statsAtStart.lostBytes;
+    m_shownLossGaps = 0;
+    m_listEpoch = 0;
+    SetStatusText("", 2);
+}
+
+/**
+ * @brief Event handler for File > Open Capture: replays a capture file through the normal display
+ *        instead of a card. Start/Stop stops the replay; filters apply as they do live.
+ */
+void BusMonitorFrame::onOpenCaptureClicked(wxCommandEvent &) {
+    if (BM::getInstance().isMonitoring()) {
+        wxMessageBox("Stop monitoring before opening a capture.", "Open Capture", wxOK | wxICON_INFORMATION, this);
+        return;
+    }
+    wxFileDialog dialog(this, "Open Capture", Common::getExecutableDirectory(), "", "Bus Monitor captures (*.bmc)|*.bmc|All files (*.*)|*.*",
+                        wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    if (dialog.ShowModal() != wxID_OK) return;
+
+    resetRunState();
+    BM::getInstance().setReplaySpeed(selectedReplaySpeed());
+    std::string error;
+    if (!BM::getInstance().startReplay(dialog.GetPath().ToStdString(), error)) {
+        SetStatusText("Error opening capture: " + error);
+        wxMessageBox("Failed to open capture: " + error, "Error", wxOK | wxICON_ERROR, this);
+        return;
+    }
+    SetStatusText("Replaying " + dialog.GetFilename());
+    m_startStopButton->SetLabelText("Stop");
+    m_startStopButton->SetBackgroundColour(wxColour("#ff4545"));
+    m_startStopButton->SetForegroundColour(wxColour("white"));
+    m_deviceIdTextInput->Enable(false);
+    showReplayControls(true);
+}
+
+/**
+ * @brief Shows or hides the replay bar; capture to file is not available while replaying.
+ */
+void BusMonitorFrame::showReplayControls(bool show) {
+    m_replayPauseButton->SetLabelText("Pause");
+    m_replaySlider->SetValue(0);
+    m_replaySlider->Enable(false);
+    m_replaySliderDragging = false;
+    m_logToFileCheckBox->Enable(!show);
+    m_mainSizer->Show(m_replaySizer, show);
+    Layout();
+}
+
+/**
+ * @brief Moves the replay slider and position text to the replay position, unless the user is dragging the slider.
+ */
+void BusMonitorFrame::updateReplayControls(const BmPipelineStats &stats) {
+    m_replaySlider->Enable(stats.replaySeekable);
+    if (!m_replaySliderDragging && stats.replayDurationNs > 0) {
+        uint64_t position = std::min(stats.replayPositionNs, stats.replayDurationNs);
+        m_replaySlider->SetValue(static_cast<int>(position * REPLAY_SLIDER_STEPS / stats.replayDurationNs));
+    }
+    wxString text = formatReplayTime(stats.replayPositionNs) + " / " +
+                    (stats.replaySeekable ? formatReplayTime(stats.replayDurationNs) : wxString("indexing..."));
+    if (stats.replayAtEnd) text += "  (end)";
+    else if (stats.replayPaused) text += "  (paused)";
+    if (text != m_replayPositionText->GetLabel()) m_replayPositionText->SetLabel(text);
+}
+
+/**
+ * @brief Returns the replay speed selected in the speed choice.
+ */
+double BusMonitorFrame::selectedReplaySpeed() const {
+    int selection = m_replaySpeedChoice->GetSelection();
+    return (selection >= 0 && selection < static_cast<int>(sizeof(REPLAY_SPEEDS) / sizeof(REPLAY_SPEEDS[0]))) ? REPLAY_SPEEDS[selection] : 1.0;
+}
+
+/**
+ * @brief Event handler for the replay Pause/Resume button.
+ */
+void BusMonitorFrame::onReplayPauseClicked(wxCommandEvent &) {
+    bool pause = !BM::getInstance().getPipelineStats().replayPaused;
+    BM::getInstance().pauseReplay(pause);
+    m_replayPauseButton->SetLabelText(pause ? "Resume" : "Pause");
+}
+
+/**
+ * @brief Event handler for the replay speed choice; takes effect from the current position.
+ */
+void BusMonitorFrame::onReplaySpeedChanged(wxCommandEvent &) { BM::getInstance().setReplaySpeed(selectedReplaySpeed()); }
+
+/**
+ * @brief Keeps the refresh timer from moving the slider while the user drags it.
+ */
+void BusMonitorFrame::onReplaySliderTracking(wxScrollEvent &) { m_replaySliderDragging = true; }
+
+/**
+ * @brief Seeks the replay to the slider position once the user has released or stepped the slider.
+ *        The refresh timer clears the list when the first messages from the new position arrive,
+ *        so that it shows the messages from the new position on.
+ */
+void BusMonitorFrame::onReplaySliderChanged(wxScrollEvent &) {
+    m_replaySliderDragging = false;
+    BmPipelineStats stats = BM::getInstance().getPipelineStats();
+    if (!stats.replayActive || !stats.replaySeekable) return;
+    BM::getInstance().seekReplay(stats.replayDurationNs / REPLAY_SLIDER_STEPS * static_cast<uint64_t>(m_replaySlider->GetValue()));
+    SetStatusText("Replay position " + formatReplayTime(stats.replayDurationNs / REPLAY_SLIDER_STEPS * static_cast<uint64_t>(m_replaySlider->GetValue())));
+}
+
 /**
  * @brief Event handler for the "Clear Filter" button and menu item.
  *        Disables filtering in the backend and resets the UI filter button to its default state.
@@ -328,16 +635,42 @@ void BusMonitorFrame::onClearFilterClicked(wxCommandEvent &) {
     BM::getInstance().enableFilter(false);
     m_filterButton->SetLabelText("No filter set. Click a tree item to filter.");
     m_filterButton->Enable(false);
+    m_filterExpressionInput->ChangeValue("");
     resetTreeVisualState();
     SetStatusText("Filter cleared.");
 }
 
+/**
+ * @brief Event handler for Enter in the filter expression box.
+ *        Compiles and applies the expression; an empty expression clears the filter.
+ *        On a syntax error the current filter is kept and the error is shown in the status bar.
+ */
+void BusMonitorFrame::onFilterExpressionEntered(wxCommandEvent &) {
+    std::string expression = m_filterExpressionInput->GetValue().ToStdString();
+    if (expression.find_first_not_of(" \t") == std::string::npos) {
+        wxCommandEvent emptyEvent;
+        onClearFilterClicked(emptyEvent);
+        return;
+    }
+    std::string error;
+    if (!BM::getInstance().setFilterExpression(expression, error)) {
+        SetStatusText("Filter error: " + error);
+        wxBell();
+        return;
+    }
+    wxString filterLabel = "Filtering by: " + expression;
+    m_filterButton->SetLabelText(filterLabel);
+    m_filterButton->Enable(true);
+    resetTreeVisualState();
+    SetStatusText(filterLabel);
+}
+
 /**
  * @brief Event handler for the "Clear" button and menu item.
  *        Clears the message list and resets any visual state in the tree.
  */
 void BusMonitorFrame::onClearClicked(wxCommandEvent &) {
-    m_messageList->Clear();
+    m_messageList->clearMessages();
     resetTreeVisualState();
     SetStatusText("Messages cleared.");
 }
@@ -409,6 +742,7 @@ void BusMonitorFrame::onTreeItemClicked(wxTreeEvent &event) {
 
         m_filterButton->SetLabelText(filterLabel);
         m_filterButton->Enable(true);
+        m_filterExpressionInput->ChangeValue(MessageFilter::criteriaExpression(filterBusChar, filterRt, filterSa, filterMc));
         resetTreeVisualState();
         m_milStd1553Tree->SetItemBold(clickedId, true);
         m_milStd1553Tree->EnsureVisible(clickedId);
@@ -423,6 +757,7 @@ void BusMonitorFrame::onTreeItemClicked(wxTreeEvent &event) {
  *        to ensure a consistent UI state.
  */
 void BusMonitorFrame::resetTreeVisualState() {
+    m_shownActivity.fill(0);
     auto& model = MilStd1553::getInstance();
     wxColour defaultColour = wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOWTEXT);
     for (const auto& bus : model.busList) {
@@ -446,17 +781,17 @@ void BusMonitorFrame::resetTreeVisualState() {
 }
 
 /**
- * @brief Enables or disables logging of bus data to a file based on checkbox state.
+ * @brief Enables or disables binary capture of the raw bus data to a file based on checkbox state.
  */
 void BusMonitorFrame::onLogToFileToggled(wxCommandEvent &event) {
     bool isChecked = event.IsChecked();
     BM::getInstance().enableDataLogging(isChecked);
     if (isChecked) {
-        SetStatusText("Data logging to file enabled.");
-        Logger::info("Data logging to file ENABLED by user.");
+        SetStatusText("Binary capture to file enabled.");
+        Logger::info("Binary capture to file ENABLED by user.");
     } else {
-        SetStatusText("Data logging to file disabled.");
-        Logger::info("Data logging to file DISABLED by user.");
+        SetStatusText("Binary capture to file disabled.");
+        Logger::info("Binary capture to file DISABLED by user.");
     }
 }
 
@@ -470,6 +805,9 @@ void BusMonitorFrame::onExit(wxCommandEvent &) { Close(true); }
  *        Ensures that the backend monitoring is stopped cleanly before the application exits.
  */
 void BusMonitorFrame::onCloseFrame(wxCloseEvent&) {
+    m_activityTimer.Stop();
+    m_refreshTimer.Stop();
+    m_statisticsTimer.Stop();
     if (BM::getInstance().isMonitoring()) {
         BM::getInstance().stop();
     }
@@ -5,7 +5,14 @@
 #include <wx/wx.h>
 #include "common.hpp"
 #include "logger.hpp"
+#include "messageBatch.hpp"
+#include "messageListCtrl.hpp"
+#include "statisticsListCtrl.hpp"
+#include "activityBitmap.hpp"
 #include <map>
+#include <vector>
+
+struct BmPipelineStats;
 
 enum {
   ID_ADD_BTN = 1,
@@ -16,7 +23,15 @@ enum {
   ID_CLEAR_MENU,
   ID_DEVICE_ID_TXT,
   ID_RT_SA_TREE,
-  ID_LOG_TO_FILE_CHECKBOX
+  ID_LOG_TO_FILE_CHECKBOX,
+  ID_ACTIVITY_TIMER,
+  ID_REFRESH_TIMER,
+  ID_FILTER_EXPR_TXT,
+  ID_OPEN_CAPTURE_MENU,
+  ID_REPLAY_PAUSE_BTN,
+  ID_REPLAY_SPEED_CHOICE,
+  ID_REPLAY_SLIDER,
+  ID_STATISTICS_TIMER
 };
 
 
@@ -30,21 +45,66 @@ private:
   void onClearFilterClicked(wxCommandEvent &event);
   void onClearClicked(wxCommandEvent &event);
   void onTreeItemClicked(wxTreeEvent &event);
+  void onFilterExpressionEntered(wxCommandEvent &event);
   void onExit(wxCommandEvent &event);
   void onLogToFileToggled(wxCommandEvent &event); 
   void onCloseFrame(wxCloseEvent& event);
+  void onActivityTimer(wxTimerEvent &event);
+  void onRefreshTimer(wxTimerEvent &event);
+  void onStatisticsTimer(wxTimerEvent &event);
+  void onOpenCaptureClicked(wxCommandEvent &event);
+  void onReplayPauseClicked(wxCommandEvent &event);
+  void onReplaySpeedChanged(wxCommandEvent &event);
+  void onReplaySliderTracking(wxScrollEvent &event);
+  void onReplaySliderChanged(wxScrollEvent &event);
 
-  void appendMessagesToUi(const wxString& messages);
+  void loadConfiguration();
+  void appendMessagesToUi(const std::vector<MessageBatch>& batches);
+  void updateDisplayStatus();
   void updateTreeItemVisualState(char bus, int rt, int sa, bool isActive);
   void resetTreeVisualState();
+  void resetRunState();
+  bool stopRun();
+  void showReplayControls(bool show);
+  void updateReplayControls(const BmPipelineStats &stats);
+  double selectedReplaySpeed() const;
 
   int m_uiRecentMessageCount;
+  int m_defaultDeviceNum;
+  int m_activityRefreshHz;
+  wxTimer m_activityTimer;
+  ActivityBitmap::Snapshot m_shownActivity{};
+  int m_uiRefreshHz;
+  wxTimer m_refreshTimer;
+  std::vector<MessageBatch> m_frameBatches;
+  int m_statisticsRefreshHz;
+  wxTimer m_statisticsTimer;
+  std::vector<BusStatistics::Row> m_statisticsRows;
+  bool m_cardFiltering;
+  bool m_useInterrupts;
+  int m_minReadBytes;
+  int m_maxReadBytes;
+  std::string m_deviceBackend;
+  wxString m_displayStatusText;
+  uint64_t m_lossGapsAtStart = 0;
+  uint64_t m_lostBytesAtStart = 0;
+  uint64_t m_shownLossGaps = 0;
+  uint32_t m_listEpoch = 0; // Replay seek epoch of the messages in the list (see BmPipelineStats::replaySeekEpoch).
   wxTextCtrl *m_deviceIdTextInput;
   wxTreeCtrl *m_milStd1553Tree;
-  wxTextCtrl *m_messageList;
+  MessageListCtrl *m_messageList;
+  StatisticsListCtrl *m_statisticsList;
   wxButton *m_startStopButton;
   wxButton *m_filterButton;
+  wxTextCtrl *m_filterExpressionInput;
   wxCheckBox *m_logToFileCheckBox;
+  wxBoxSizer *m_mainSizer;
+  wxBoxSizer *m_replaySizer;
+  wxButton *m_replayPauseButton;
+  wxChoice *m_replaySpeedChoice;
+  wxSlider *m_replaySlider;
+  wxStaticText *m_replayPositionText;
+  bool m_replaySliderDragging = false;
   std::map<wxTreeItemId, int> m_treeItemToMcMap; 
 
 
@@ -0,0 +1,80 @@
+#include "messageListCtrl.hpp"
+#include "messageFormat.hpp"
+#include <algorithm>
+
+/**
+ * @brief Creates the virtual list and its columns.
+ * @param parent The parent window.
+ * @param id The window identifier.
+ * @param capacity Maximum number of messages kept scrollable; older ones are overwritten.
+ */
+MessageListCtrl::MessageListCtrl(wxWindow *parent, wxWindowID id, size_t capacity)
+    : wxListCtrl(parent, id, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_VIRTUAL | wxLC_HRULES),
+      m_records(capacity) {
+  static const int columnWidths[MessageFormat::COL_COUNT] = {120, 40, 110, 120, 90, 1300};
+  for (int c = 0; c < MessageFormat::COL_COUNT; ++c) {
+    InsertColumn(c, MessageFormat::columnTitle(static_cast<MessageFormat::Column>(c)), wxLIST_FORMAT_LEFT, columnWidths[c]);
+  }
+  SetFont(wxFont(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+  m_noResponseAttr.SetTextColour(*wxRED);
+  m_errorAttr.SetBackgroundColour(wxColour(255, 230, 230));
+  m_gapAttr.SetBackgroundColour(wxColour(255, 240, 150));
+}
+
+/**
+ * @brief Adds the batches received during one UI frame to the ring and updates the item count once.
+ *        If the view was scrolled to the bottom it keeps following the newest message;
+ *        otherwise the user's scroll position is left alone.
+ * @param batches The decoded messages to add, oldest batch first.
+ */
+void MessageListCtrl::appendBatches(const std::vector<MessageBatch> &batches) {
+  uint64_t totalBefore = m_records.totalPushed();
+  long oldCount = GetItemCount();
+  bool followTail = oldCount == 0 || GetTopItem() + GetCountPerPage() >= oldCount - 1;
+  for (const auto &batch : batches) {
+    for (const auto &trans : batch) {
+      m_records.push(trans);
+    }
+  }
+  if (m_records.totalPushed() == totalBefore) return;
+  long newCount = static_cast<long>(m_records.size());
+  if (newCount != oldCount) SetItemCount(newCount);
+
+  if (followTail) {
+    EnsureVisible(newCount - 1);
+  }
+  // Once the ring wraps, every row index shifts to a newer message.
+  if (newCount == oldCount || m_records.totalPushed() > m_records.capacity()) {
+    long top = GetTopItem();
+    RefreshItems(top, std::min(newCount - 1, top + GetCountPerPage()));
+  }
+}
+
+/**
+ * @brief Removes all messages from the view.
+ */
+void MessageListCtrl::clearMessages() {
+  m_records.clear();
+  SetItemCount(0);
+  Refresh();
+}
+
+/**
+ * @brief Renders the text of one cell; called by wxWidgets for visible rows only.
+ */
+wxString MessageListCtrl::OnGetItemText(long item, long column) const {
+  if (item < 0 || static_cast<size_t>(item) >= m_records.size()) return wxEmptyString;
+  return wxString::FromUTF8(MessageFormat::formatColumn(m_records.at(item), static_cast<MessageFormat::Column>(column)));
+}
+
+/**
+ * @brief Highlights messages without a response or with an error word.
+ */
+wxItemAttr *MessageListCtrl::OnGetItemAttr(long item) const {
+  if (item < 0 || static_cast<size_t>(item) >= m_records.size()) return nullptr;
+  const MessageTransaction &trans = m_records.at(item);
+  if (trans.isGap()) return &m_gapAttr;
+  if (trans.errorValid()) return &m_errorAttr;
+  if (!trans.stat1Valid()) return &m_noResponseAttr;
+  return nullptr;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "messageBatch.hpp"
+#include "recordRing.hpp"
+#include <vector>
+#include <wx/listctrl.h>
+#include <wx/wx.h>
+
+/**
+ * @brief Virtual report-mode list showing one decoded BM message per row.
+ *        Rows are rendered on demand from a RecordRing, so appending is O(1) and the
+ *        control never holds more than the visible rows as text.
+ */
+class MessageListCtrl : public wxListCtrl {
+public:
+  MessageListCtrl(wxWindow *parent, wxWindowID id, size_t capacity);
+
+  void appendBatches(const std::vector<MessageBatch> &batches);
+  void clearMessages();
+  size_t messageCount() const { return m_records.size(); }
+
+protected:
+  wxString OnGetItemText(long item, long column) const override;
+  wxItemAttr *OnGetItemAttr(long item) const override;
+
+private:
+  RecordRing m_records;
+  mutable wxItemAttr m_noResponseAttr;
+  mutable wxItemAttr m_errorAttr;
+  mutable wxItemAttr m_gapAttr;
+};
@@ -0,0 +1,107 @@
+#include "statisticsListCtrl.hpp"
+#include <algorithm>
+
+/**
+ * @brief Creates the virtual list and its columns.
+ * @param parent The parent window.
+ * @param id The window identifier.
+ */
+StatisticsListCtrl::StatisticsListCtrl(wxWindow *parent, wxWindowID id)
+    : wxListCtrl(parent, id, wxDefaultPosition, wxSize(560, -1), wxLC_REPORT | wxLC_VIRTUAL | wxLC_HRULES) {
+  static const char *const titles[COL_COUNT] = {"Terminal", "Messages", "Rate/s", "No Resp", "Errors", "WC Mism", "Last Seen"};
+  static const int widths[COL_COUNT] = {110, 80, 60, 60, 55, 60, 120};
+  for (int c = 0; c < COL_COUNT; ++c) {
+    InsertColumn(c, titles[c], c == COL_TERMINAL || c == COL_LAST_SEEN ? wxLIST_FORMAT_LEFT : wxLIST_FORMAT_RIGHT, widths[c]);
+  }
+  SetFont(wxFont(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+  m_faultAttr.SetTextColour(*wxRED);
+}
+
+/**
+ * @brief Shows a new snapshot and computes each terminal's message rate since the previous one.
+ * @param rows The snapshot rows, as returned by BM::getStatistics().
+ */
+void StatisticsListCtrl::updateStatistics(const std::vector<BusStatistics::Row> &rows) {
+  auto now = std::chrono::steady_clock::now();
+  double seconds = m_hasPrevious ? std::chrono::duration<double>(now - m_previousUpdate).count() : 0.0;
+  m_rows = rows;
+  m_rates.assign(m_rows.size(), 0.0);
+  for (size_t i = 0; i < m_rows.size(); ++i) {
+    uint64_t &previous = m_previousMessages[m_rows[i].index];
+    // A smaller count means the backend was reset by a new run.
+    if (seconds > 0 && m_rows[i].counters.messages >= previous) m_rates[i] = (m_rows[i].counters.messages - previous) / seconds;
+    previous = m_rows[i].counters.messages;
+  }
+  m_previousUpdate = now;
+  m_hasPrevious = true;
+
+  long count = static_cast<long>(m_rows.size());
+  if (count != GetItemCount()) SetItemCount(count);
+  if (count > 0) {
+    long top = GetTopItem();
+    RefreshItems(top, std::min(count - 1, top + GetCountPerPage()));
+  }
+}
+
+/**
+ * @brief Removes all rows and forgets the previous snapshot.
+ */
+void StatisticsListCtrl::clearStatistics() {
+  m_rows.clear();
+  m_rates.clear();
+  m_previousMessages.fill(0);
+  m_hasPrevious = false;
+  SetItemCount(0);
+  Refresh();
+}
+
+/**
+ * @brief Marks the panel as counting only the traffic the card filter passes; the card drops the rest
+ *        before it is decoded.
+ * @param filtered Whether card filtering is active.
+ */
+void StatisticsListCtrl::setCardFiltered(bool filtered) {
+  if (filtered == m_cardFiltered) return;
+  m_cardFiltered = filtered;
+  wxListItem column;
+  column.SetMask(wxLIST_MASK_TEXT);
+  column.SetText(filtered ? "Terminal (filtered)" : "Terminal");
+  SetColumn(COL_TERMINAL, column);
+  if (filtered) SetToolTip("Card filtering is on: traffic excluded by the filter is not counted.");
+  else UnsetToolTip();
+}
+
+/**
+ * @brief Renders the text of one cell; called by wxWidgets for visible rows only.
+ */
+wxString StatisticsListCtrl::OnGetItemText(long item, long column) const {
+  if (item < 0 || static_cast<size_t>(item) >= m_rows.size()) return wxEmptyString;
+  const BusStatistics::Row &row = m_rows[item];
+  const BusStatistics::Counters &c = row.counters;
+  switch (column) {
+    case COL_TERMINAL:
+      return wxString::Format("%c RT%02d SA%02d %c", row.busIdx() ? 'B' : 'A', row.rt(), row.sa(), row.transmit() ? 'T' : 'R');
+    case COL_MESSAGES: return wxString::Format("%llu", static_cast<unsigned long long>(c.messages));
+    case COL_RATE: return wxString::Format("%.0f", m_rates[item]);
+    case COL_NO_RESPONSE: return wxString::Format("%llu", static_cast<unsigned long long>(c.noResponses));
+    case COL_ERRORS: return wxString::Format("%llu", static_cast<unsigned long long>(c.errorWords));
+    case COL_WORD_COUNT: return wxString::Format("%llu", static_cast<unsigned long long>(c.wordCountMismatches));
+    case COL_LAST_SEEN: {
+      if (c.lastTimetag == 0) return "-";
+      // IRIG timetag fields: hour, minute, second and microsecond of the day.
+      return wxString::Format("%02u:%02u:%02u.%06u", static_cast<unsigned>((c.lastTimetag >> 32) & 0x1F),
+                              static_cast<unsigned>((c.lastTimetag >> 26) & 0x3F), static_cast<unsigned>((c.lastTimetag >> 20) & 0x3F),
+                              static_cast<unsigned>(c.lastTimetag & 0xFFFFF));
+    }
+    default: return wxEmptyString;
+  }
+}
+
+/**
+ * @brief Highlights terminals that missed a response, reported an error or sent the wrong word count.
+ */
+wxItemAttr *StatisticsListCtrl::OnGetItemAttr(long item) const {
+  if (item < 0 || static_cast<size_t>(item) >= m_rows.size()) return nullptr;
+  const BusStatistics::Counters &c = m_rows[item].counters;
+  return (c.noResponses || c.errorWords || c.wordCountMismatches) ? &m_faultAttr : nullptr;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "busStatistics.hpp"
+#include <array>
+#include <chrono>
+#include <vector>
+#include <wx/listctrl.h>
+#include <wx/wx.h>
+
+/**
+ * @brief Virtual report-mode list of the per Bus/RT/SA statistics, one row per terminal seen on the bus.
+ *        Fed with a BusStatistics snapshot on a UI timer; message rates come from the difference to
+ *        the previous snapshot.
+ */
+class StatisticsListCtrl : public wxListCtrl {
+public:
+  StatisticsListCtrl(wxWindow *parent, wxWindowID id);
+
+  void updateStatistics(const std::vector<BusStatistics::Row> &rows);
+  void clearStatistics();
+  void setCardFiltered(bool filtered);
+
+protected:
+  wxString OnGetItemText(long item, long column) const override;
+  wxItemAttr *OnGetItemAttr(long item) const override;
+
+private:
+  enum Column { COL_TERMINAL = 0, COL_MESSAGES, COL_RATE, COL_NO_RESPONSE, COL_ERRORS, COL_WORD_COUNT, COL_LAST_SEEN, COL_COUNT };
+
+  std::vector<BusStatistics::Row> m_rows;
+  std::vector<double> m_rates;  // Messages per second of each row since the previous update.
+  std::array<uint64_t, BusStatistics::ENTRIES> m_previousMessages{};
+  std::chrono::steady_clock::time_point m_previousUpdate;
+  bool m_hasPrevious = false;
+  bool m_cardFiltered = false;
+  mutable wxItemAttr m_faultAttr;
+};
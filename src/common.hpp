@@ -29,7 +29,8 @@ struct FrameConfig {
   int sa2;
   int wc;
   BcMode mode;
-  std::array<std::string, BC_MAX_DATA_WORDS> data;
+  std::array<std::string, BC_MAX_DATA_WORDS> data;        // Data words as shown in the UI.
+  std::array<uint16_t, BC_MAX_DATA_WORDS> payload{};      // The same words parsed once, as sent on the bus.
 };
 
 namespace Common {
@@ -57,4 +58,33 @@ namespace Common {
     inline std::string getLogPath() {
         return getExecutableDirectory() + "BusController.log";
     }
+
+    /**
+     * @brief Parses a data word typed as 1-4 hex digits, optionally prefixed with 0x.
+     * @return False if the text is empty, too long or not hex; word is then unchanged.
+     */
+    inline bool parseDataWord(const std::string& text, uint16_t& word) {
+        size_t pos = (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) ? 2 : 0;
+        if (text.size() == pos || text.size() - pos > 4) return false;
+        uint16_t value = 0;
+        for (; pos < text.size(); ++pos) {
+            const char c = text[pos];
+            int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+            else return false;
+            value = static_cast<uint16_t>((value << 4) | digit);
+        }
+        word = value;
+        return true;
+    }
+
+    /**
+     * @brief Formats a data word as four upper-case hex digits.
+     */
+    inline std::string formatDataWord(uint16_t word) {
+        static const char digits[] = "0123456789ABCDEF";
+        return {digits[(word >> 12) & 0xF], digits[(word >> 8) & 0xF], digits[(word >> 4) & 0xF], digits[word & 0xF]};
+    }
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "aimDevice.hpp"
+#include "hardwareDevice.hpp"
+#include "simulatedDevice.hpp"
+#include "logger.hpp"
+#include <nlohmann/json.hpp>
+#include <fstream>
+
+namespace {
+/**
+ * @brief Reads the "Simulator" section of config.json, keeping the defaults of SimulatorConfig for
+ *        anything missing. Example:
+ *        "Simulator": { "Seed": 1553, "Utilization_Percent": 40, "Error_Per_Mille": 1, "Real_Time": true,
+ *                       "Schedule": [ { "Bus": "A", "RT": 5, "SA": 1, "Dir": "RX", "WC": 2, "Rate_Hz": 50 } ] }
+ *        Dir is "RX" (BC to RT), "TX" (RT to BC) or "RTRT" (RT/SA to RT2/SA2).
+ */
+SimulatorConfig loadSimulatorConfig(const std::string& configPath) {
+    SimulatorConfig config;
+    std::ifstream ifs(configPath);
+    if (!ifs.is_open()) { Logger::warn("Simulator: " + configPath + " not found, using an idle bus."); return config; }
+    try {
+        nlohmann::json configJson;
+        ifs >> configJson;
+        if (!configJson.contains("Simulator")) return config;
+        const auto& sim = configJson["Simulator"];
+        config.seed = sim.value("Seed", config.seed);
+        config.fillPercent = std::max(0, std::min(100, sim.value("Utilization_Percent", config.fillPercent)));
+        config.fillErrorPerMille = std::max(0, std::min(1000, sim.value("Error_Per_Mille", config.fillErrorPerMille)));
+        config.fillMaxWordCount = std::max(1, std::min(32, sim.value("Max_Word_Count", config.fillMaxWordCount)));
+        config.realTime = sim.value("Real_Time", config.realTime);
+        config.dataQueueBytes = std::max<AiUInt32>(4096, sim.value("Data_Queue_Bytes", config.dataQueueBytes));
+        if (sim.contains("Schedule")) {
+            for (const auto& item : sim["Schedule"]) {
+                SimulatedTraffic traffic;
+                const std::string bus = item.value("Bus", std::string("A"));
+                const std::string dir = item.value("Dir", std::string("RX"));
+                traffic.bus = (bus == "B" || bus == "b") ? 'B' : 'A';
+                traffic.rt = item.value("RT", traffic.rt) & 0x1F;
+                traffic.sa = item.value("SA", traffic.sa) & 0x1F;
+                traffic.transmit = dir == "TX";
+                if (dir == "RTRT") { traffic.rt2 = item.value("RT2", 0) & 0x1F; traffic.sa2 = item.value("SA2", traffic.sa) & 0x1F; }
+                traffic.wordCount = std::max(0, std::min(32, item.value("WC", traffic.wordCount)));
+                traffic.rateHz = item.value("Rate_Hz", traffic.rateHz);
+                traffic.errorPerMille = std::max(0, std::min(1000, item.value("Error_Per_Mille", traffic.errorPerMille)));
+                config.schedule.push_back(traffic);
+            }
+        }
+        Logger::info("Simulator: " + std::to_string(config.schedule.size()) + " scheduled messages, " +
+                     std::to_string(config.fillPercent) + "% background utilization");
+    } catch (const std::exception& e) {
+        Logger::error(std::string("Simulator: cannot parse ") + configPath + ": " + e.what());
+    }
+    return config;
+}
+} // namespace
+
+/**
+ * @brief Creates the device for a backend name.
+ */
+std::unique_ptr<AimDevice> AimDevice::create(const std::string& backend, const std::string& configPath) {
+    if (backend == SIMULATOR) return std::make_unique<SimulatedDevice>(loadSimulatorConfig(configPath));
+    if (backend != HARDWARE) Logger::warn("Unknown Device_Backend '" + backend + "', using the AIM board.");
+    return std::make_unique<HardwareDevice>();
+}
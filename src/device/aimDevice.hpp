@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Api1553.h"
+#include <memory>
+#include <string>
+
+/**
+ * @brief One open stream of an AIM MIL-STD-1553 board, as used by the BM, BC and RT applications.
+ *        The methods mirror the AIM API calls of the same name, without the module handle, which
+ *        belongs to the device; parameters and return codes are those of the AIM API.
+ *        Two backends exist: the board itself (HardwareDevice) and a simulated board (SimulatedDevice),
+ *        selected with the "Device_Backend" value of an application's section in config.json.
+ */
+class AimDevice {
+public:
+    using InterruptHandler = TY_INT_FUNC_PTR;
+
+    virtual ~AimDevice() = default;
+
+    static constexpr const char* HARDWARE = "aim";
+    static constexpr const char* SIMULATOR = "simulator";
+
+    /**
+     * @brief Creates the device for a backend name; the simulator reads its traffic from the
+     *        "Simulator" section of the configuration file.
+     * @param backend HARDWARE or SIMULATOR; anything else selects the hardware.
+     * @param configPath The configuration file, usually Common::getConfigPath().
+     */
+    static std::unique_ptr<AimDevice> create(const std::string& backend, const std::string& configPath);
+
+    virtual const char* backendName() const = 0;
+
+    // Board access (ApiInit/ApiOpenEx, ApiClose, ApiCmdReset, ApiGetBoardInfo, ApiCmdCalCplCon).
+    virtual AiReturn open(AiUInt32 module, AiUInt32 stream) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+    virtual AiReturn reset(AiUInt8 biu, AiUInt8 resetMode, TY_API_RESET_INFO* info) = 0;
+    virtual AiReturn getBoardInfo(TY_API_BOARD_INFO* info) = 0;
+    virtual AiReturn calCplCon(AiUInt8 biu, AiUInt8 bus, AiUInt8 coupling) = 0;
+
+    // Bus monitor.
+    virtual AiReturn bmIni(AiUInt8 biu) = 0;
+    virtual AiReturn bmCapMode(AiUInt8 biu, TY_API_BM_CAP_SETUP* setup) = 0;
+    virtual AiReturn bmFilterIni(AiUInt8 biu, AiUInt8 rt, AiUInt32 rxSa, AiUInt32 txSa, AiUInt32 rxMc, AiUInt32 txMc) = 0;
+    virtual AiReturn bmStart(AiUInt8 biu) = 0;
+    virtual AiReturn bmHalt(AiUInt8 biu) = 0;
+    virtual AiReturn bmIntrMode(AiUInt8 biu, AiUInt8 intMode, AiUInt8 strobeMode, AiUInt8 res) = 0;
+    virtual AiReturn installInterruptHandler(AiUInt8 biu, AiUInt8 type, InterruptHandler handler) = 0;
+    virtual AiReturn deleteInterruptHandler(AiUInt8 biu, AiUInt8 type) = 0;
+
+    // Data queues.
+    virtual AiReturn dataQueueOpen(AiUInt32 id, AiUInt32* size) = 0;
+    virtual AiReturn dataQueueControl(AiUInt32 id, AiUInt32 mode) = 0;
+    virtual AiReturn dataQueueClose(AiUInt32 id) = 0;
+    virtual AiReturn dataQueueRead(TY_API_DATA_QUEUE_READ* read, TY_API_DATA_QUEUE_STATUS* status) = 0;
+
+    // Bus controller.
+    virtual AiReturn bcIni(AiUInt8 biu, AiUInt8 retr, AiUInt8 svrq, AiUInt8 tbm, AiUInt8 gsb) = 0;
+    virtual AiReturn bcBHDef(AiUInt8 biu, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8 qsize, AiUInt8 bqm,
+                             AiUInt8 bsm, AiUInt8 sqm, AiUInt8 eqm, AiUInt8 res, TY_API_BC_BH_INFO* info) = 0;
+    virtual AiReturn bcXferDef(AiUInt8 biu, TY_API_BC_XFER* xfer, AiUInt32* descAddr) = 0;
+    virtual AiReturn bcFrameDef(AiUInt8 biu, TY_API_BC_FRAME* frame) = 0;
+    virtual AiReturn bcMFrameDefEx(AiUInt8 biu, TY_API_BC_MFRAME_EX* majorFrame) = 0;
+    virtual AiReturn bcStart(AiUInt8 biu, AiUInt8 mode, AiUInt32 count, AiFloat frameTimeMs, AiUInt32 startAddr,
+                             AiUInt32* majorAddr, AiUInt32* minorAddr) = 0;
+    virtual AiReturn bcHalt(AiUInt8 biu) = 0;
+    virtual AiReturn bcXferRead(AiUInt8 biu, AiUInt16 xid, AiUInt16 clr, TY_API_BC_XFER_DSP* status) = 0;
+    // Acyclic frame: prepared once, then inserted into the running BC program (mode API_BC_ACYC_SEND_*).
+    virtual AiReturn bcAcycPrep(AiUInt8 biu, TY_API_BC_ACYC* acyc) = 0;
+    virtual AiReturn bcAcycSend(AiUInt8 biu, AiUInt8 mode, AiUInt32 timetagHigh, AiUInt32 timetagLow) = 0;
+
+    // Message buffers of the BC and the RTs.
+    virtual AiReturn bufDef(AiUInt8 biu, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                            AiUInt16* rid, AiUInt32* raddr) = 0;
+    virtual AiReturn bufRead(AiUInt8 biu, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                             AiUInt16* rid, AiUInt32* raddr) = 0;
+
+    // Remote terminals.
+    virtual AiReturn rtIni(AiUInt8 biu, AiUInt8 rt, AiUInt8 con, AiUInt8 bus, AiFloat respTime, AiUInt16 nxw) = 0;
+    virtual AiReturn rtBHDef(AiUInt8 biu, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8 qsize, AiUInt8 bqm,
+                             AiUInt8 bsm, AiUInt8 sqm, AiUInt8 eqm, AiUInt8 res, TY_API_RT_BH_INFO* info) = 0;
+    virtual AiReturn rtSACon(AiUInt8 biu, AiUInt8 rt, AiUInt8 sa, AiUInt16 hid, AiUInt8 saType, AiUInt8 con, AiUInt8 rmod,
+                             AiUInt8 smod, AiUInt16 swm) = 0;
+    virtual AiReturn rtStart(AiUInt8 biu) = 0;
+    virtual AiReturn rtHalt(AiUInt8 biu) = 0;
+    virtual AiReturn rtSAMsgRead(AiUInt8 biu, AiUInt8 rt, AiUInt8 sa, AiUInt8 saType, AiUInt8 clr, TY_API_RT_SA_MSG_DSP* msg) = 0;
+};
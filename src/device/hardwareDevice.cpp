@@ -0,0 +1,44 @@
+#include "hardwareDevice.hpp"
+#include <cstring>
+#include <mutex>
+
+namespace {
+std::mutex libraryMutex;
+int openDevices = 0;
+} // namespace
+
+/**
+ * @brief Initializes the AIM API library if needed and opens a stream of a local board.
+ * @param module The board (module) number.
+ * @param stream The stream (BIU) on the board.
+ * @return API_OK, API_ERR_NAK if no board was found, or the error of ApiOpenEx.
+ */
+AiReturn HardwareDevice::open(AiUInt32 module, AiUInt32 stream) {
+    close();
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    if (openDevices == 0) {
+        AiReturn boards = ApiInit();
+        if (boards <= 0) return boards < 0 ? boards : API_ERR_NAK;
+    }
+    TY_API_OPEN apiOpen; memset(&apiOpen, 0, sizeof(apiOpen));
+    apiOpen.ul_Module = module; apiOpen.ul_Stream = stream; strcpy(apiOpen.ac_SrvName, "local");
+    AiReturn ret = ApiOpenEx(&apiOpen, &m_handle);
+    if (ret != API_OK) {
+        m_handle = 0;
+        if (openDevices == 0) ApiExit();
+        return ret;
+    }
+    ++openDevices;
+    return API_OK;
+}
+
+/**
+ * @brief Closes the stream; the last open device of the process also releases the API library.
+ */
+void HardwareDevice::close() {
+    if (m_handle == 0) return;
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    ApiClose(m_handle);
+    m_handle = 0;
+    if (--openDevices == 0) ApiExit();
+}
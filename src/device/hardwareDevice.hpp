@@ -0,0 +1,87 @@
+#pragma once
+
+#include "aimDevice.hpp"
+
+/**
+ * @brief An AIM board stream, driven through the AIM API library.
+ *        The library is initialized by the first open device of the process and released after the last one is closed.
+ */
+class HardwareDevice : public AimDevice {
+public:
+    HardwareDevice() = default;
+    ~HardwareDevice() override { close(); }
+
+    HardwareDevice(const HardwareDevice&) = delete;
+    HardwareDevice& operator=(const HardwareDevice&) = delete;
+
+    const char* backendName() const override { return HARDWARE; }
+
+    AiReturn open(AiUInt32 module, AiUInt32 stream) override;
+    void close() override;
+    bool isOpen() const override { return m_handle != 0; }
+    AiReturn reset(AiUInt8 biu, AiUInt8 resetMode, TY_API_RESET_INFO* info) override { return ApiCmdReset(m_handle, biu, resetMode, info); }
+    AiReturn getBoardInfo(TY_API_BOARD_INFO* info) override { return ApiGetBoardInfo(m_handle, info); }
+    AiReturn calCplCon(AiUInt8 biu, AiUInt8 bus, AiUInt8 coupling) override { return ApiCmdCalCplCon(m_handle, biu, bus, coupling); }
+
+    AiReturn bmIni(AiUInt8 biu) override { return ApiCmdBMIni(m_handle, biu); }
+    AiReturn bmCapMode(AiUInt8 biu, TY_API_BM_CAP_SETUP* setup) override { return ApiCmdBMCapMode(m_handle, biu, setup); }
+    AiReturn bmFilterIni(AiUInt8 biu, AiUInt8 rt, AiUInt32 rxSa, AiUInt32 txSa, AiUInt32 rxMc, AiUInt32 txMc) override {
+        return ApiCmdBMFilterIni(m_handle, biu, rt, rxSa, txSa, rxMc, txMc);
+    }
+    AiReturn bmStart(AiUInt8 biu) override { return ApiCmdBMStart(m_handle, biu); }
+    AiReturn bmHalt(AiUInt8 biu) override { return ApiCmdBMHalt(m_handle, biu); }
+    AiReturn bmIntrMode(AiUInt8 biu, AiUInt8 intMode, AiUInt8 strobeMode, AiUInt8 res) override { return ApiCmdBMIntrMode(m_handle, biu, intMode, strobeMode, res); }
+    AiReturn installInterruptHandler(AiUInt8 biu, AiUInt8 type, InterruptHandler handler) override { return ApiInstIntHandler(m_handle, biu, type, handler); }
+    AiReturn deleteInterruptHandler(AiUInt8 biu, AiUInt8 type) override { return ApiDelIntHandler(m_handle, biu, type); }
+
+    AiReturn dataQueueOpen(AiUInt32 id, AiUInt32* size) override { return ApiCmdDataQueueOpen(m_handle, id, size); }
+    AiReturn dataQueueControl(AiUInt32 id, AiUInt32 mode) override { return ApiCmdDataQueueControl(m_handle, id, mode); }
+    AiReturn dataQueueClose(AiUInt32 id) override { return ApiCmdDataQueueClose(m_handle, id); }
+    AiReturn dataQueueRead(TY_API_DATA_QUEUE_READ* read, TY_API_DATA_QUEUE_STATUS* status) override { return ApiCmdDataQueueRead(m_handle, read, status); }
+
+    AiReturn bcIni(AiUInt8 biu, AiUInt8 retr, AiUInt8 svrq, AiUInt8 tbm, AiUInt8 gsb) override { return ApiCmdBCIni(m_handle, biu, retr, svrq, tbm, gsb); }
+    AiReturn bcBHDef(AiUInt8 biu, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8 qsize, AiUInt8 bqm,
+                     AiUInt8 bsm, AiUInt8 sqm, AiUInt8 eqm, AiUInt8 res, TY_API_BC_BH_INFO* info) override {
+        return ApiCmdBCBHDef(m_handle, biu, hid, bid, sid, eid, qsize, bqm, bsm, sqm, eqm, res, info);
+    }
+    AiReturn bcXferDef(AiUInt8 biu, TY_API_BC_XFER* xfer, AiUInt32* descAddr) override { return ApiCmdBCXferDef(m_handle, biu, xfer, descAddr); }
+    AiReturn bcFrameDef(AiUInt8 biu, TY_API_BC_FRAME* frame) override { return ApiCmdBCFrameDef(m_handle, biu, frame); }
+    AiReturn bcMFrameDefEx(AiUInt8 biu, TY_API_BC_MFRAME_EX* majorFrame) override { return ApiCmdBCMFrameDefEx(m_handle, biu, majorFrame); }
+    AiReturn bcStart(AiUInt8 biu, AiUInt8 mode, AiUInt32 count, AiFloat frameTimeMs, AiUInt32 startAddr,
+                     AiUInt32* majorAddr, AiUInt32* minorAddr) override {
+        return ApiCmdBCStart(m_handle, biu, mode, count, frameTimeMs, startAddr, majorAddr, minorAddr);
+    }
+    AiReturn bcHalt(AiUInt8 biu) override { return ApiCmdBCHalt(m_handle, biu); }
+    AiReturn bcXferRead(AiUInt8 biu, AiUInt16 xid, AiUInt16 clr, TY_API_BC_XFER_DSP* status) override { return ApiCmdBCXferRead(m_handle, biu, xid, clr, status); }
+    AiReturn bcAcycPrep(AiUInt8 biu, TY_API_BC_ACYC* acyc) override { return ApiCmdBCAcycPrep(m_handle, biu, acyc); }
+    AiReturn bcAcycSend(AiUInt8 biu, AiUInt8 mode, AiUInt32 timetagHigh, AiUInt32 timetagLow) override {
+        return ApiCmdBCAcycSend(m_handle, biu, mode, timetagHigh, timetagLow);
+    }
+
+    AiReturn bufDef(AiUInt8 biu, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                    AiUInt16* rid, AiUInt32* raddr) override {
+        return ApiCmdBufDef(m_handle, biu, bufferType, hid, bid, length, data, rid, raddr);
+    }
+    AiReturn bufRead(AiUInt8 biu, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                     AiUInt16* rid, AiUInt32* raddr) override {
+        return ApiCmdBufRead(m_handle, biu, bufferType, hid, bid, length, data, rid, raddr);
+    }
+
+    AiReturn rtIni(AiUInt8 biu, AiUInt8 rt, AiUInt8 con, AiUInt8 bus, AiFloat respTime, AiUInt16 nxw) override { return ApiCmdRTIni(m_handle, biu, rt, con, bus, respTime, nxw); }
+    AiReturn rtBHDef(AiUInt8 biu, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8 qsize, AiUInt8 bqm,
+                     AiUInt8 bsm, AiUInt8 sqm, AiUInt8 eqm, AiUInt8 res, TY_API_RT_BH_INFO* info) override {
+        return ApiCmdRTBHDef(m_handle, biu, hid, bid, sid, eid, qsize, bqm, bsm, sqm, eqm, res, info);
+    }
+    AiReturn rtSACon(AiUInt8 biu, AiUInt8 rt, AiUInt8 sa, AiUInt16 hid, AiUInt8 saType, AiUInt8 con, AiUInt8 rmod,
+                     AiUInt8 smod, AiUInt16 swm) override {
+        return ApiCmdRTSACon(m_handle, biu, rt, sa, hid, saType, con, rmod, smod, swm);
+    }
+    AiReturn rtStart(AiUInt8 biu) override { return ApiCmdRTStart(m_handle, biu); }
+    AiReturn rtHalt(AiUInt8 biu) override { return ApiCmdRTHalt(m_handle, biu); }
+    AiReturn rtSAMsgRead(AiUInt8 biu, AiUInt8 rt, AiUInt8 sa, AiUInt8 saType, AiUInt8 clr, TY_API_RT_SA_MSG_DSP* msg) override {
+        return ApiCmdRTSAMsgRead(m_handle, biu, rt, sa, saType, clr, msg);
+    }
+
+private:
+    AiUInt32 m_handle = 0;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Api1553.h"
+#include <cstdint>
+
+/**
+ * @brief Encoders for the 32-bit words of the AIM BM recording stream (the data queue format
+ *        decoded by Bm1553StreamDecoder): bits 31-28 give the entry type, the low bits the value.
+ */
+namespace MonitorWords {
+
+// Bus word kinds, OR-ed into the entry type of a bus word (0x8 bus A, 0xC bus B).
+enum : AiUInt32 { COMMAND = 0x0, COMMAND2 = 0x1, DATA = 0x2, STATUS = 0x3 };
+
+inline AiUInt32 errorWord(AiUInt32 error) { return (0x1u << 28) | (error & 0x07FFFFFF); }
+inline AiUInt32 timetagHighWord(uint64_t fullTimetag) { return (0x3u << 28) | static_cast<AiUInt32>((fullTimetag >> 26) & 0x000FFFFF); }
+inline AiUInt32 timetagLowWord(uint64_t fullTimetag) { return (0x2u << 28) | static_cast<AiUInt32>(fullTimetag & 0x03FFFFFF); }
+inline AiUInt32 busWord(char bus, AiUInt32 kind, AiUInt16 word) { return (((bus == 'A' ? 0x8u : 0xCu) | kind) << 28) | word; }
+inline AiUInt16 commandWord(int rt, int tr, int sa, int wc) { return static_cast<AiUInt16>((rt << 11) | (tr << 10) | (sa << 5) | (wc & 0x1F)); }
+
+/**
+ * @brief Encodes a time in microseconds since the start of the year as a full BM timetag
+ *        (IRIG day/hour/minute/second/microsecond fields); the inverse of timetagMicroseconds().
+ */
+inline uint64_t fullTimetag(uint64_t us) {
+    const uint64_t seconds = us / 1000000;
+    const uint64_t day = (seconds / 86400) % 512, hour = seconds / 3600 % 24, min = seconds / 60 % 60, sec = seconds % 60;
+    return (day << 37) | (hour << 32) | (min << 26) | (sec << 20) | (us % 1000000);
+}
+
+} // namespace MonitorWords
@@ -0,0 +1,680 @@
+#include "simulatedBus.hpp"
+#include "monitorWords.hpp"
+#include <algorithm>
+#include <ctime>
+#include <limits>
+
+namespace {
+constexpr uint64_t WORD_US = 20;              // One 1553 word on the wire.
+constexpr uint64_t RESPONSE_US = 8;           // RT response time.
+constexpr uint64_t NO_RESPONSE_US = 14;       // Response timeout.
+constexpr uint64_t GAP_US = 4;                // Minimum intermessage gap.
+constexpr AiUInt32 ERROR_NO_RESPONSE = 0x0040;
+
+int busIndex(char bus) { return bus == 'B' ? 1 : 0; }
+bool isModeCodeSa(int sa) { return sa == 0 || sa == 31; }
+
+/**
+ * @brief Microseconds since the start of the current UTC year, the origin of IRIG timetags.
+ */
+uint64_t microsecondsOfYear() {
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+    const uint64_t secondOfYear = uint64_t(utc.tm_yday) * 86400 + uint64_t(utc.tm_hour) * 3600 + uint64_t(utc.tm_min) * 60 + uint64_t(utc.tm_sec);
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count() % 1000000;
+    return secondOfYear * 1000000 + uint64_t(us);
+}
+} // namespace
+
+/**
+ * @brief Sets up the schedule; items are staggered so that equal rates do not all start together.
+ */
+SimulatedBus::SimulatedBus(const SimulatorConfig& config)
+    : m_config(config), m_rng(config.seed), m_epoch(std::chrono::steady_clock::now()),
+      m_startUs(config.realTime ? microsecondsOfYear() : FREE_RUNNING_START_US) {
+    m_cursorUs = {m_startUs, m_startUs};
+    for (size_t i = 0; i < config.schedule.size(); ++i) {
+        const SimulatedTraffic& traffic = config.schedule[i];
+        if (traffic.rateHz <= 0) continue;
+        ScheduleItem item;
+        item.traffic = traffic;
+        item.periodUs = std::max<uint64_t>(1, static_cast<uint64_t>(1e6 / traffic.rateHz));
+        item.nextDueUs = m_startUs + (i * 250) % item.periodUs;
+        m_schedule.push_back(item);
+    }
+    m_queue.resize(std::max<AiUInt32>(config.dataQueueBytes / 4, 256));
+    m_words.reserve(80);
+}
+
+/**
+ * @brief Returns the bus of a simulated board, created on first use and kept while any device has it open.
+ */
+std::shared_ptr<SimulatedBus> SimulatedBus::forModule(AiUInt32 module, const SimulatorConfig& config) {
+    static std::mutex mutex;
+    static std::map<AiUInt32, std::weak_ptr<SimulatedBus>> buses;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<SimulatedBus> bus = buses[module].lock();
+    if (!bus) {
+        bus = std::make_shared<SimulatedBus>(config);
+        buses[module] = bus;
+    }
+    return bus;
+}
+
+/**
+ * @brief Returns the current bus time; in free-running mode the bus never runs ahead on its own.
+ */
+uint64_t SimulatedBus::nowUs() const {
+    if (!m_config.realTime) return std::max(m_cursorUs[0], m_cursorUs[1]);
+    return m_startUs + std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+/**
+ * @brief Generates the traffic up to the current bus time.
+ */
+void SimulatedBus::advance() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+}
+
+void SimulatedBus::runFor(uint64_t us) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(std::max(m_cursorUs[0], m_cursorUs[1]) + us);
+}
+
+/**
+ * @brief Returns the number of messages sent on both buses so far.
+ */
+uint64_t SimulatedBus::messages() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_messages;
+}
+
+/**
+ * @brief Runs both buses up to a bus time. The bus that is free first always sends next, so messages
+ *        are produced in start-time order. Each bus sends, in priority order: the pending transfers of
+ *        the BC program, the scheduled message that is due longest, and background traffic while its
+ *        utilization is below the fill target. Otherwise it idles until the next of these is due.
+ * @param targetUs Bus time to run to; messages starting before it are sent.
+ */
+void SimulatedBus::advanceTo(uint64_t targetUs) {
+    const uint64_t fill = static_cast<uint64_t>(std::max(0, std::min(100, m_config.fillPercent)));
+    while (true) {
+        const int b = m_cursorUs[0] <= m_cursorUs[1] ? 0 : 1;
+        const uint64_t t = m_cursorUs[b];
+        if (t >= targetUs) break;
+        if (m_bcRunning && m_bcNextFrameUs <= t) { queueMinorFrame(); continue; }
+
+        uint64_t duration = 0;
+        uint64_t nextDueUs = std::numeric_limits<uint64_t>::max();
+        if (m_bcPendingIndex[b] < m_bcPending[b].size()) {
+            duration = transmit(m_bcPending[b][m_bcPendingIndex[b]++], t);
+        } else {
+            ScheduleItem* due = nullptr;
+            for (ScheduleItem& item : m_schedule) {
+                if (busIndex(item.traffic.bus) != b) continue;
+                if (item.nextDueUs <= t && (!due || item.nextDueUs < due->nextDueUs)) due = &item;
+                nextDueUs = std::min(nextDueUs, item.nextDueUs);
+            }
+            if (due) {
+                Message msg = scheduledMessage(due->traffic);
+                duration = transmit(msg, t);
+                // An overloaded bus skips the periods it cannot keep up with instead of bursting later.
+                due->nextDueUs += due->periodUs;
+                if (due->nextDueUs + due->periodUs < t) due->nextDueUs = t;
+            } else if (fill > 0 && m_busyUs[b] * 100 < fill * (t - m_startUs)) {
+                Message msg = fillMessage(b == 0 ? 'A' : 'B');
+                duration = transmit(msg, t);
+            }
+        }
+        if (duration > 0) {
+            m_cursorUs[b] = t + duration;
+            m_busyUs[b] += duration;
+            continue;
+        }
+        uint64_t next = std::min(targetUs, nextDueUs);
+        if (m_bcRunning) next = std::min(next, m_bcNextFrameUs);
+        if (fill > 0) next = std::min(next, m_startUs + (m_busyUs[b] * 100 + fill - 1) / fill);
+        m_cursorUs[b] = std::max(next, t + 1);
+    }
+}
+
+/**
+ * @brief Starts the next minor frame of the BC program: its transfers join the pending transfers of their bus.
+ */
+void SimulatedBus::queueMinorFrame() {
+    if (m_majorFrame.empty()) { m_bcRunning = false; return; }
+    for (int b = 0; b < 2; ++b) {
+        m_bcPending[b].erase(m_bcPending[b].begin(), m_bcPending[b].begin() + static_cast<std::ptrdiff_t>(m_bcPendingIndex[b]));
+        m_bcPendingIndex[b] = 0;
+    }
+    if (m_acyclicAtFrameEnd) { queueAcyclicFrame(); m_acyclicAtFrameEnd = false; }
+    const auto frame = m_minorFrames.find(m_majorFrame[m_bcMinorIndex]);
+    if (frame != m_minorFrames.end()) {
+        for (AiUInt16 xid : frame->second) {
+            const auto xfer = m_transfers.find(xid);
+            if (xfer == m_transfers.end()) continue;
+            Message msg = bcMessage(xfer->second);
+            m_bcPending[busIndex(msg.bus)].push_back(msg);
+        }
+    }
+    m_bcMinorIndex = (m_bcMinorIndex + 1) % m_majorFrame.size();
+    m_bcNextFrameUs += m_bcFrameUs;
+    if (m_bcFramesLeft > 0 && --m_bcFramesLeft == 0) m_bcRunning = false;
+}
+
+/**
+ * @brief Puts the transfers of the prepared acyclic frame in front of the pending transfers of their bus,
+ *        so they go out next without dropping or delaying the rest of the minor frame beyond their own bus time.
+ */
+void SimulatedBus::queueAcyclicFrame() {
+    std::array<std::vector<Message>, 2> inserts;
+    for (AiUInt16 xid : m_acyclicFrame) {
+        const auto xfer = m_transfers.find(xid);
+        if (xfer == m_transfers.end()) continue;
+        Message msg = bcMessage(xfer->second);
+        inserts[busIndex(msg.bus)].push_back(msg);
+    }
+    for (int b = 0; b < 2; ++b) {
+        std::vector<Message>& pending = m_bcPending[b];
+        pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(m_bcPendingIndex[b]));
+        m_bcPendingIndex[b] = 0;
+        pending.insert(pending.begin(), inserts[b].begin(), inserts[b].end());
+    }
+}
+
+/**
+ * @brief Sets the data word count of a message from a word count field (0 = 32) or, for SA 0 and 31, a mode code.
+ */
+void SimulatedBus::setWordCount(Message& msg, int wordCount) {
+    const int sa = msg.type == API_BC_TYPE_RTRT ? msg.sa2 : msg.sa;
+    if (isModeCodeSa(sa)) {
+        msg.modeCode = wordCount & 0x1F;
+        msg.wordCount = msg.modeCode >= 16 ? 1 : 0;
+    } else {
+        msg.modeCode = -1;
+        msg.wordCount = (wordCount & 0x1F) == 0 ? 32 : (wordCount & 0x1F);
+    }
+}
+
+/**
+ * @brief Builds a message from a BC transfer descriptor, with the data of its BC buffer.
+ */
+SimulatedBus::Message SimulatedBus::bcMessage(const TY_API_BC_XFER& xfer) {
+    Message msg;
+    msg.xid = xfer.xid;
+    msg.bus = xfer.chn == API_BC_XFER_BUS_SECONDARY ? 'B' : 'A';
+    msg.type = xfer.type & API_BC_TYPE_MASK_TRANSFER;
+    if (msg.type == API_BC_TYPE_BCRT) { msg.rt = xfer.rcv_rt; msg.sa = xfer.rcv_sa; }
+    else { msg.rt = xfer.xmt_rt; msg.sa = xfer.xmt_sa; msg.rt2 = xfer.rcv_rt; msg.sa2 = xfer.rcv_sa; }
+    setWordCount(msg, xfer.wcnt);
+    const auto header = m_bcHeaders.find(xfer.hid);
+    const AiUInt16 bid = header != m_bcHeaders.end() ? header->second : 0;
+    if (msg.type == API_BC_TYPE_BCRT) {
+        const std::vector<AiUInt16>& data = buffer(API_BUF_BC_MSG, bid);
+        std::copy(data.begin(), data.begin() + msg.wordCount, msg.data.begin());
+    } else {
+        msg.bcBufferId = bid;
+    }
+    return msg;
+}
+
+/**
+ * @brief Builds the next message of a schedule item; BC to RT data words change on every message.
+ */
+SimulatedBus::Message SimulatedBus::scheduledMessage(const SimulatedTraffic& traffic) {
+    Message msg;
+    msg.bus = traffic.bus;
+    msg.type = traffic.rt2 >= 0 ? API_BC_TYPE_RTRT : (traffic.transmit ? API_BC_TYPE_RTBC : API_BC_TYPE_BCRT);
+    msg.rt = traffic.rt & 0x1F;
+    msg.sa = traffic.sa & 0x1F;
+    if (traffic.rt2 >= 0) { msg.rt2 = traffic.rt2 & 0x1F; msg.sa2 = traffic.sa2 & 0x1F; }
+    setWordCount(msg, traffic.wordCount);
+    if (msg.type == API_BC_TYPE_BCRT) for (int i = 0; i < msg.wordCount; ++i) msg.data[i] = static_cast<AiUInt16>(m_rng());
+    msg.noResponse = traffic.errorPerMille > 0 && static_cast<int>(m_rng() % 1000) < traffic.errorPerMille;
+    return msg;
+}
+
+/**
+ * @brief Builds a random background message: BC to RT, RT to BC or (one in ten) RT to RT, to RTs 1-30.
+ */
+SimulatedBus::Message SimulatedBus::fillMessage(char bus) {
+    Message msg;
+    msg.bus = bus;
+    const unsigned kind = m_rng() % 20;
+    msg.type = kind < 9 ? API_BC_TYPE_BCRT : (kind < 18 ? API_BC_TYPE_RTBC : API_BC_TYPE_RTRT);
+    msg.rt = 1 + static_cast<int>(m_rng() % 30);
+    msg.sa = 1 + static_cast<int>(m_rng() % 30);
+    if (msg.type == API_BC_TYPE_RTRT) { msg.rt2 = 1 + (msg.rt % 30); msg.sa2 = msg.sa; }
+    const int maxWords = std::max(1, std::min(32, m_config.fillMaxWordCount));
+    setWordCount(msg, 1 + static_cast<int>(m_rng() % static_cast<unsigned>(maxWords)));
+    if (msg.type == API_BC_TYPE_BCRT) for (int i = 0; i < msg.wordCount; ++i) msg.data[i] = static_cast<AiUInt16>(m_rng());
+    msg.noResponse = m_config.fillErrorPerMille > 0 && static_cast<int>(m_rng() % 1000) < m_config.fillErrorPerMille;
+    return msg;
+}
+
+/**
+ * @brief Sends a message: updates the simulated RTs and the BC buffer it touches, and stores its
+ *        monitor words if the monitor captures it.
+ * @param msg The message; the data of transmitting RTs is filled in.
+ * @param startUs Bus time of the command word.
+ * @return The time the message occupies the bus, including the intermessage gap.
+ */
+uint64_t SimulatedBus::transmit(Message& msg, uint64_t startUs) {
+    using namespace MonitorWords;
+    ++m_messages;
+    const int wcField = msg.modeCode >= 0 ? msg.modeCode : (msg.wordCount & 0x1F);
+    const bool fromRt = msg.type != API_BC_TYPE_BCRT;
+    if (fromRt && !msg.noResponse) dataFromRt(msg.rt, msg.sa, msg);
+
+    AiUInt16 command = commandWord(msg.rt, fromRt ? 1 : 0, msg.sa, wcField);
+    const AiUInt16 status = statusWordOf(msg.rt);
+    AiUInt16 receiveCommand = 0, receiveStatus = 0;
+    if (msg.type == API_BC_TYPE_RTRT) {
+        receiveCommand = commandWord(msg.rt2, 0, msg.sa2, wcField);
+        receiveStatus = statusWordOf(msg.rt2);
+    }
+    uint64_t words = 1 + (msg.type == API_BC_TYPE_RTRT ? 1 : 0);
+    uint64_t responses = 0;
+
+    const bool store = m_monitoring && m_queueEnabled &&
+                       (!m_captureFilter || (msg.type == API_BC_TYPE_RTRT ? captured(msg.rt2, false, msg.sa2, msg.modeCode) || captured(msg.rt, true, msg.sa, msg.modeCode)
+                                                                          : captured(msg.rt, fromRt, msg.sa, msg.modeCode)));
+    if (store) {
+        m_words.clear();
+        const uint64_t timetag = fullTimetag(startUs);
+        const AiUInt32 high = timetagHighWord(timetag);
+        if (high != m_lastTimetagHigh) m_words.push_back(high);
+        m_words.push_back(timetagLowWord(timetag));
+    }
+    auto put = [&](AiUInt32 kind, AiUInt16 word) { if (store) m_words.push_back(busWord(msg.bus, kind, word)); };
+    auto putData = [&]() { for (int i = 0; i < msg.wordCount; ++i) put(DATA, msg.data[i]); words += msg.wordCount; };
+
+    switch (msg.type) {
+        case API_BC_TYPE_BCRT:
+            put(COMMAND, command);
+            putData();
+            if (!msg.noResponse) { put(STATUS, status); ++words; ++responses; receiveAtRt(msg.rt, msg.sa, msg, command, status, startUs); }
+            break;
+        case API_BC_TYPE_RTBC:
+            put(COMMAND, command);
+            if (!msg.noResponse) {
+                put(STATUS, status); ++words; ++responses;
+                putData();
+                if (RtSa* sa = simulatedSa(msg.rt, true, msg.sa, msg.modeCode)) {
+                    sa->status.trw = API_BUF_FULL << 5; sa->status.lcw = command; sa->status.lsw = status;
+                    sa->status.ttag = static_cast<AiUInt32>(fullTimetag(startUs) & 0x03FFFFFF);
+                }
+                storeBcData(msg);
+            }
+            break;
+        default: // RT to RT: receive command, transmit command, transmitter status, data, receiver status.
+            put(COMMAND, receiveCommand);
+            put(COMMAND2, commandWord(msg.rt, 1, msg.sa, wcField));
+            if (!msg.noResponse) {
+                put(STATUS, status); ++words; ++responses;
+                putData();
+                put(STATUS, receiveStatus); ++words; ++responses;
+                receiveAtRt(msg.rt2, msg.sa2, msg, receiveCommand, receiveStatus, startUs);
+                storeBcData(msg);
+            }
+            break;
+    }
+    if (store) {
+        if (msg.noResponse) m_words.push_back(errorWord(ERROR_NO_RESPONSE));
+        storeWords();
+    }
+    if (msg.xid != 0) {
+        if (msg.type == API_BC_TYPE_RTRT) reportTransfer(msg, receiveCommand, status, commandWord(msg.rt, 1, msg.sa, wcField), receiveStatus, startUs);
+        else reportTransfer(msg, command, status, 0, 0, startUs);
+    }
+    return words * WORD_US + (msg.noResponse ? NO_RESPONSE_US : responses * RESPONSE_US) + GAP_US;
+}
+
+/**
+ * @brief Copies the data of a BC program's RT to BC or RT to RT transfer into its BC buffer.
+ */
+void SimulatedBus::storeBcData(const Message& msg) {
+    if (msg.bcBufferId == 0) return;
+    std::vector<AiUInt16>& data = buffer(API_BUF_BC_MSG, static_cast<AiUInt16>(msg.bcBufferId));
+    std::copy(msg.data.begin(), msg.data.begin() + msg.wordCount, data.begin());
+}
+
+/**
+ * @brief Updates the status of a BC program transfer after it was sent, as ApiCmdBCXferRead reports it:
+ *        message and error counts, command and status words, and the buffer report word.
+ */
+void SimulatedBus::reportTransfer(const Message& msg, AiUInt16 command, AiUInt16 status, AiUInt16 command2, AiUInt16 status2, uint64_t startUs) {
+    TY_API_BC_XFER_DSP& report = m_transferStatus[msg.xid];
+    report.cw1 = command;
+    report.cw2 = command2;
+    report.st1 = msg.noResponse ? 0 : status;
+    report.st2 = msg.noResponse ? 0 : status2;
+    report.bid = static_cast<AiUInt16>(msg.bcBufferId);
+    report.brw = static_cast<AiUInt16>((msg.noResponse ? API_BUF_EMPTY : API_BUF_FULL) << 12) | (msg.bus == 'A' ? API_BRW_RBUS_MASK : 0);
+    report.ttag = static_cast<AiUInt32>(MonitorWords::fullTimetag(startUs) & 0x03FFFFFF);
+    ++report.msg_cnt;
+    if (msg.noResponse) ++report.err_cnt;
+}
+
+/**
+ * @brief Returns the SA of a simulated, running RT that handles a message, or nullptr.
+ */
+SimulatedBus::RtSa* SimulatedBus::simulatedSa(int rt, bool transmit, int sa, int modeCode) {
+    if (!m_rtRunning || !m_rts[rt].enabled) return nullptr;
+    const int type = modeCode >= 0 ? (transmit ? API_RT_TYPE_TRANSMIT_MODECODE : API_RT_TYPE_RECEIVE_MODECODE)
+                                   : (transmit ? API_RT_TYPE_TRANSMIT_SA : API_RT_TYPE_RECEIVE_SA);
+    RtSa& entry = m_rts[rt].sa[type][modeCode >= 0 ? modeCode : sa];
+    return entry.enabled ? &entry : nullptr;
+}
+
+/**
+ * @brief Delivers received data to an RT: remembered for wrap-around and, for a simulated RT, written
+ *        to the buffer of the SA.
+ */
+void SimulatedBus::receiveAtRt(int rt, int sa, const Message& msg, AiUInt16 command, AiUInt16 status, uint64_t startUs) {
+    if (msg.modeCode < 0) std::copy(msg.data.begin(), msg.data.begin() + msg.wordCount, m_saMemory[{rt, sa}].begin());
+    RtSa* entry = simulatedSa(rt, false, sa, msg.modeCode);
+    if (!entry) return;
+    const auto header = m_rtHeaders.find(entry->hid);
+    entry->status.bid = header != m_rtHeaders.end() ? header->second : 0;
+    std::vector<AiUInt16>& data = buffer(API_BUF_RT_MSG, entry->status.bid);
+    std::copy(msg.data.begin(), msg.data.begin() + msg.wordCount, data.begin());
+    entry->status.trw = API_BUF_FULL << 5;
+    entry->status.lcw = command;
+    entry->status.lsw = status;
+    entry->status.ttag = static_cast<AiUInt32>(MonitorWords::fullTimetag(startUs) & 0x03FFFFFF);
+}
+
+/**
+ * @brief Fills in the data an RT transmits: the buffer of a simulated RT's transmit SA, else the data
+ *        the SA last received, else a fixed pattern.
+ */
+void SimulatedBus::dataFromRt(int rt, int sa, Message& msg) {
+    if (RtSa* entry = simulatedSa(rt, true, sa, msg.modeCode)) {
+        const auto header = m_rtHeaders.find(entry->hid);
+        entry->status.bid = header != m_rtHeaders.end() ? header->second : 0;
+        const std::vector<AiUInt16>& data = buffer(API_BUF_RT_MSG, entry->status.bid);
+        std::copy(data.begin(), data.begin() + msg.wordCount, msg.data.begin());
+        return;
+    }
+    const auto memory = m_saMemory.find({rt, sa});
+    if (memory != m_saMemory.end() && msg.modeCode < 0) { msg.data = memory->second; return; }
+    for (int i = 0; i < msg.wordCount; ++i) msg.data[i] = static_cast<AiUInt16>((rt << 11) | (sa << 5) | i);
+}
+
+/**
+ * @brief Returns the status word an RT answers with: the one set with defineRt() for a simulated RT.
+ */
+AiUInt16 SimulatedBus::statusWordOf(int rt) const {
+    const AiUInt16 address = static_cast<AiUInt16>(rt << 11);
+    return m_rts[rt].enabled ? static_cast<AiUInt16>(address | (m_rts[rt].statusWord & 0x07FF)) : address;
+}
+
+/**
+ * @brief Applies the card filter (API_BM_CAPMODE_FILTER) to one command.
+ */
+bool SimulatedBus::captured(int rt, bool transmit, int sa, int modeCode) const {
+    const std::array<AiUInt32, 4>& masks = m_monitorFilter[rt];
+    if (!((masks[transmit ? 1 : 0] >> sa) & 1)) return false;
+    return modeCode < 0 || ((masks[transmit ? 3 : 2] >> modeCode) & 1);
+}
+
+/**
+ * @brief Appends the words of the current message to the data queue. A message that does not fit is
+ *        dropped whole and raises the overflow status, as on the card; the next stored message repeats
+ *        the high timetag word so the stream stays decodable.
+ */
+void SimulatedBus::storeWords() {
+    const size_t capacity = m_queue.size();
+    if (m_queueCount + m_words.size() > capacity) {
+        m_lostBytes += m_words.size() * 4;
+        m_queueStatus |= API_DATA_QUEUE_STATUS_LOC_OVERFLOW;
+        m_lastTimetagHigh = 0xFFFFFFFF;
+        return;
+    }
+    if ((m_words.front() >> 28) == 0x3) m_lastTimetagHigh = m_words.front();
+    size_t tail = (m_queueHead + m_queueCount) % capacity;
+    for (AiUInt32 word : m_words) {
+        m_queue[tail] = word;
+        if (++tail == capacity) tail = 0;
+    }
+    m_queueCount += m_words.size();
+}
+
+void SimulatedBus::setMonitoring(bool running) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    m_monitoring = running;
+}
+
+void SimulatedBus::setCaptureFilter(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_captureFilter = enabled;
+}
+
+void SimulatedBus::setMonitorFilter(int rt, AiUInt32 rxSa, AiUInt32 txSa, AiUInt32 rxMc, AiUInt32 txMc) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_monitorFilter[rt & 0x1F] = {rxSa, txSa, rxMc, txMc};
+}
+
+/**
+ * @brief Starts or stops the data queue; stopping discards what it holds.
+ */
+void SimulatedBus::setQueueEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    m_queueEnabled = enabled;
+    if (!enabled) { m_queueHead = 0; m_queueCount = 0; m_lastTimetagHigh = 0xFFFFFFFF; }
+}
+
+/**
+ * @brief Reads monitor words from the data queue, like ApiCmdDataQueueRead. In free-running mode the
+ *        bus first runs (at most a second of bus time) until the request can be filled.
+ * @param buffer Destination of the words.
+ * @param bytes Bytes wanted; whole words are read.
+ * @param status Filled like the driver's queue status; total_bytes_transfered also counts bytes lost to overflows.
+ * @return The bytes read.
+ */
+AiUInt32 SimulatedBus::readQueue(void* buffer, AiUInt32 bytes, TY_API_DATA_QUEUE_STATUS& status) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_config.realTime) {
+        advanceTo(nowUs());
+    } else if (m_monitoring && m_queueEnabled) {
+        for (int step = 0; step < 1000 && m_queueCount * 4 < bytes; ++step) advanceTo(std::max(m_cursorUs[0], m_cursorUs[1]) + 1000);
+    }
+    const size_t capacity = m_queue.size();
+    const size_t count = std::min<size_t>(bytes / 4, m_queueCount);
+    AiUInt32* out = static_cast<AiUInt32*>(buffer);
+    const size_t first = std::min(count, capacity - m_queueHead);
+    std::copy(m_queue.begin() + static_cast<std::ptrdiff_t>(m_queueHead), m_queue.begin() + static_cast<std::ptrdiff_t>(m_queueHead + first), out);
+    std::copy(m_queue.begin(), m_queue.begin() + static_cast<std::ptrdiff_t>(count - first), out + first);
+    m_queueHead = (m_queueHead + count) % capacity;
+    m_queueCount -= count;
+    m_deliveredBytes += count * 4;
+
+    status.status = (m_queueEnabled ? API_DATA_QUEUE_STATUS_ENABLED : 0) | m_queueStatus;
+    status.bytes_transfered = static_cast<AiUInt32>(count * 4);
+    status.bytes_in_queue = static_cast<AiUInt32>(m_queueCount * 4);
+    status.total_bytes_transfered = m_deliveredBytes + m_lostBytes;
+    m_queueStatus = 0;
+    return status.bytes_transfered;
+}
+
+AiUInt32 SimulatedBus::queuedBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_config.realTime) advanceTo(nowUs());
+    return static_cast<AiUInt32>(m_queueCount * 4);
+}
+
+void SimulatedBus::defineBcHeader(AiUInt16 hid, AiUInt16 bid) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bcHeaders[hid] = bid;
+}
+
+void SimulatedBus::defineTransfer(const TY_API_BC_XFER& xfer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_transfers[xfer.xid] = xfer;
+    m_transferStatus.erase(xfer.xid);
+}
+
+/**
+ * @brief Defines a minor frame; only transfer instructions are simulated.
+ */
+void SimulatedBus::defineMinorFrame(const TY_API_BC_FRAME& frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<AiUInt16>& xids = m_minorFrames[frame.id];
+    xids.clear();
+    for (int i = 0; i < frame.cnt && i < MAX_API_BC_XFRAME; ++i) {
+        if (frame.instr[i] == API_BC_INSTR_TRANSFER) xids.push_back(frame.xid[i]);
+    }
+}
+
+void SimulatedBus::defineMajorFrame(const TY_API_BC_MFRAME_EX& majorFrame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_majorFrame.assign(majorFrame.fid, majorFrame.fid + std::min<int>(majorFrame.cnt, MAX_API_BC_MFRAME_EX));
+}
+
+/**
+ * @brief Starts the BC program at the current bus time.
+ * @param majorFrames Major frames to run; 0 runs until halted.
+ * @param minorFrameMs Minor frame time.
+ */
+void SimulatedBus::startBc(AiUInt32 majorFrames, double minorFrameMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    m_bcRunning = !m_majorFrame.empty();
+    m_bcFramesLeft = majorFrames * static_cast<AiUInt32>(m_majorFrame.size());
+    m_bcMinorIndex = 0;
+    m_bcFrameUs = std::max<uint64_t>(1, static_cast<uint64_t>(minorFrameMs * 1000));
+    m_bcNextFrameUs = std::min(m_cursorUs[0], m_cursorUs[1]);
+}
+
+/**
+ * @brief Stops the BC program; transfers not sent yet are dropped.
+ */
+void SimulatedBus::haltBc() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    m_bcRunning = false;
+    m_acyclicAtFrameEnd = false;
+    for (int b = 0; b < 2; ++b) { m_bcPending[b].clear(); m_bcPendingIndex[b] = 0; }
+}
+
+/**
+ * @brief Defines the acyclic frame; only transfer instructions are simulated.
+ */
+void SimulatedBus::prepareAcyclic(const TY_API_BC_ACYC& acyc) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_acyclicFrame.clear();
+    for (int i = 0; i < acyc.cnt && i < MAX_API_BC_XACYC; ++i) {
+        if (acyc.instr[i] == API_BC_INSTR_TRANSFER) m_acyclicFrame.push_back(acyc.xid[i]);
+    }
+}
+
+/**
+ * @brief Inserts the acyclic frame into the BC program without stopping it. The transfers read their BC
+ *        buffers when they are queued, like the card does when it reaches them.
+ * @param atEndOfFrame If true and the BC program runs, the frame goes out when the current minor frame ends;
+ *                     otherwise it goes out at once, ahead of the rest of the current minor frame.
+ */
+void SimulatedBus::sendAcyclic(bool atEndOfFrame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    if (atEndOfFrame && m_bcRunning) m_acyclicAtFrameEnd = true;
+    else queueAcyclicFrame();
+}
+
+/**
+ * @brief Returns a message buffer, created zeroed on first use.
+ */
+std::vector<AiUInt16>& SimulatedBus::buffer(AiUInt8 bufferType, AiUInt16 bid) {
+    std::vector<AiUInt16>& data = m_buffers[{bufferType, bid}];
+    if (data.empty()) data.resize(32, 0);
+    return data;
+}
+
+/**
+ * @brief Returns the buffer bid, or with bid 0 the buffer of header hid.
+ */
+std::vector<AiUInt16>& SimulatedBus::buffer(AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid) {
+    if (bid == 0) {
+        const std::map<AiUInt16, AiUInt16>& headers = bufferType == API_BUF_BC_MSG ? m_bcHeaders : m_rtHeaders;
+        const auto header = headers.find(hid);
+        if (header != headers.end()) bid = header->second;
+    }
+    return buffer(bufferType, bid);
+}
+
+void SimulatedBus::writeBuffer(AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, const AiUInt16* data, int count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    std::vector<AiUInt16>& target = buffer(bufferType, hid, bid);
+    std::copy(data, data + std::max(0, std::min(count, 32)), target.begin());
+}
+
+void SimulatedBus::readBuffer(AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt16* data, int count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    const std::vector<AiUInt16>& source = buffer(bufferType, hid, bid);
+    std::copy(source.begin(), source.begin() + std::max(0, std::min(count, 32)), data);
+}
+
+void SimulatedBus::defineRt(int rt, bool enabled, AiUInt16 statusWord) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rts[rt & 0x1F].enabled = enabled;
+    m_rts[rt & 0x1F].statusWord = statusWord;
+}
+
+void SimulatedBus::defineRtHeader(AiUInt16 hid, AiUInt16 bid) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rtHeaders[hid] = bid;
+}
+
+void SimulatedBus::defineRtSa(int rt, int sa, AiUInt8 saType, AiUInt16 hid, bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RtSa& entry = m_rts[rt & 0x1F].sa[saType & 0x3][sa & 0x1F];
+    entry.enabled = enabled;
+    entry.hid = hid;
+    entry.status = TY_API_RT_SA_MSG_DSP{};
+    const auto header = m_rtHeaders.find(hid);
+    entry.status.bid = header != m_rtHeaders.end() ? header->second : 0;
+}
+
+void SimulatedBus::setRtRunning(bool running) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    m_rtRunning = running;
+}
+
+/**
+ * @brief Reads the status of a BC transfer, like ApiCmdBCXferRead.
+ * @param clear API_RESET_STATUS_BITS and up reset the message and error counts after reading.
+ * @return False if the transfer is not defined.
+ */
+bool SimulatedBus::readTransfer(AiUInt16 xid, AiUInt16 clear, TY_API_BC_XFER_DSP& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    if (m_transfers.find(xid) == m_transfers.end()) return false;
+    TY_API_BC_XFER_DSP& report = m_transferStatus[xid];
+    out = report;
+    if (clear != API_DONT_MODIFY_STATUS_BITS) { report.msg_cnt = 0; report.err_cnt = 0; }
+    return true;
+}
+
+/**
+ * @brief Reads the status of an RT SA, like ApiCmdRTSAMsgRead.
+ * @param clear Resets the buffer status to empty after reading.
+ * @return False if the SA is not defined.
+ */
+bool SimulatedBus::readRtSa(int rt, int sa, AiUInt8 saType, bool clear, TY_API_RT_SA_MSG_DSP& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advanceTo(nowUs());
+    RtSa& entry = m_rts[rt & 0x1F].sa[saType & 0x3][sa & 0x1F];
+    if (!entry.enabled) return false;
+    out = entry.status;
+    if (clear) entry.status.trw = API_BUF_EMPTY << 5;
+    return true;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Api1553.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+/**
+ * @brief One periodic message of the simulated traffic schedule.
+ */
+struct SimulatedTraffic {
+    char bus = 'A';
+    int rt = 1;
+    int sa = 1;             // 0 or 31 send the mode code given by wordCount.
+    bool transmit = false;  // RT to BC if true, BC to RT otherwise.
+    int rt2 = -1;           // If set, an RT to RT transfer from rt/sa to rt2/sa2.
+    int sa2 = 1;
+    int wordCount = 1;      // 1-32 data words.
+    double rateHz = 50;
+    int errorPerMille = 0;  // Messages the RT does not answer, per mille.
+};
+
+/**
+ * @brief The traffic and data queue of a simulated board (see SimulatedBus).
+ */
+struct SimulatorConfig {
+    std::vector<SimulatedTraffic> schedule;
+    int fillPercent = 0;          // Random background traffic up to this utilization of each bus (0-100).
+    int fillErrorPerMille = 0;
+    int fillMaxWordCount = 32;
+    bool realTime = true;         // If false, bus time only advances as far as data queue reads need (benchmarks, tests).
+    unsigned seed = 1553;
+    AiUInt32 dataQueueBytes = 4 * 1024 * 1024;
+};
+
+/**
+ * @brief Models the dual-redundant MIL-STD-1553 bus of a simulated AIM board: the scheduled and background
+ *        traffic, the transfers of a BC program, the SA buffers of the RTs and the BM data queue.
+ *        Bus time follows the host clock (or the reader, see SimulatorConfig::realTime); the traffic up to
+ *        the current time is generated lazily, whenever a device call needs it, so an idle process costs nothing.
+ *        Bus A and bus B run concurrently; their messages reach the monitor in start-time order. Every RT
+ *        address answers unless an error is injected. All streams of one board share the bus, as if cabled together.
+ *        All methods are thread safe.
+ */
+class SimulatedBus {
+public:
+    explicit SimulatedBus(const SimulatorConfig& config);
+
+    /**
+     * @brief Returns the bus of a simulated board, shared by every device of the process opened on that module.
+     *        The configuration of the first device to open the board is used.
+     */
+    static std::shared_ptr<SimulatedBus> forModule(AiUInt32 module, const SimulatorConfig& config);
+
+    // Bus monitor and its data queue.
+    void setMonitoring(bool running);
+    void setCaptureFilter(bool enabled);
+    void setMonitorFilter(int rt, AiUInt32 rxSa, AiUInt32 txSa, AiUInt32 rxMc, AiUInt32 txMc);
+    void setQueueEnabled(bool enabled);
+    AiUInt32 queueBytes() const { return m_config.dataQueueBytes; }
+    AiUInt32 readQueue(void* buffer, AiUInt32 bytes, TY_API_DATA_QUEUE_STATUS& status);
+    AiUInt32 queuedBytes();
+
+    // Bus controller program.
+    void defineBcHeader(AiUInt16 hid, AiUInt16 bid);
+    void defineTransfer(const TY_API_BC_XFER& xfer);
+    void defineMinorFrame(const TY_API_BC_FRAME& frame);
+    void defineMajorFrame(const TY_API_BC_MFRAME_EX& majorFrame);
+    void startBc(AiUInt32 majorFrames, double minorFrameMs);
+    void haltBc();
+    void prepareAcyclic(const TY_API_BC_ACYC& acyc);
+    void sendAcyclic(bool atEndOfFrame);
+    bool readTransfer(AiUInt16 xid, AiUInt16 clear, TY_API_BC_XFER_DSP& out);
+
+    // BC and RT message buffers; bid 0 selects the buffer of the header hid.
+    void writeBuffer(AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, const AiUInt16* data, int count);
+    void readBuffer(AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt16* data, int count);
+
+    // Remote terminals.
+    void defineRt(int rt, bool enabled, AiUInt16 statusWord);
+    void defineRtHeader(AiUInt16 hid, AiUInt16 bid);
+    void defineRtSa(int rt, int sa, AiUInt8 saType, AiUInt16 hid, bool enabled);
+    void setRtRunning(bool running);
+    bool readRtSa(int rt, int sa, AiUInt8 saType, bool clear, TY_API_RT_SA_MSG_DSP& out);
+
+    /**
+     * @brief Generates the traffic up to the current bus time. Device calls do this themselves.
+     */
+    void advance();
+
+    /**
+     * @brief Runs the bus for a stretch of bus time; for free-running mode, where nothing else moves it
+     *        except data queue reads.
+     */
+    void runFor(uint64_t us);
+    uint64_t messages();
+
+private:
+    /**
+     * @brief One message ready to go on the bus.
+     */
+    struct Message {
+        char bus = 'A';
+        int type = API_BC_TYPE_BCRT;
+        int rt = 0, sa = 0, rt2 = 0, sa2 = 0;
+        int wordCount = 0;       // Data words on the bus.
+        int modeCode = -1;       // Mode code number, if sa is 0 or 31.
+        bool noResponse = false;
+        std::array<AiUInt16, 32> data{};
+        int bcBufferId = 0;      // BC buffer receiving the data of an RT to BC or RT to RT transfer; 0 for none.
+        AiUInt16 xid = 0;        // BC program transfer the message belongs to; 0 for none.
+    };
+
+    struct ScheduleItem {
+        SimulatedTraffic traffic;
+        uint64_t periodUs = 0;
+        uint64_t nextDueUs = 0;
+    };
+
+    struct RtSa {
+        bool enabled = false;
+        AiUInt16 hid = 0;
+        TY_API_RT_SA_MSG_DSP status{};
+    };
+
+    struct Rt {
+        bool enabled = false;
+        AiUInt16 statusWord = 0;
+        std::array<std::array<RtSa, 32>, 4> sa{}; // Per SA type (API_RT_TYPE_*), by SA or mode code.
+    };
+
+    uint64_t nowUs() const;
+    void advanceTo(uint64_t targetUs);
+    void queueMinorFrame();
+    void queueAcyclicFrame();
+    Message bcMessage(const TY_API_BC_XFER& xfer);
+    Message scheduledMessage(const SimulatedTraffic& traffic);
+    Message fillMessage(char bus);
+    uint64_t transmit(Message& msg, uint64_t startUs);
+    void setWordCount(Message& msg, int wordCount);
+    RtSa* simulatedSa(int rt, bool transmit, int sa, int modeCode);
+    void receiveAtRt(int rt, int sa, const Message& msg, AiUInt16 command, AiUInt16 status, uint64_t startUs);
+    void dataFromRt(int rt, int sa, Message& msg);
+    void storeBcData(const Message& msg);
+    void reportTransfer(const Message& msg, AiUInt16 command, AiUInt16 status, AiUInt16 command2, AiUInt16 status2, uint64_t startUs);
+    AiUInt16 statusWordOf(int rt) const;
+    bool captured(int rt, bool transmit, int sa, int modeCode) const;
+    void storeWords();
+    std::vector<AiUInt16>& buffer(AiUInt8 bufferType, AiUInt16 bid);
+    std::vector<AiUInt16>& buffer(AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid);
+
+    static constexpr uint64_t FREE_RUNNING_START_US = 1000000;
+
+    const SimulatorConfig m_config;
+    std::mutex m_mutex;
+    std::mt19937 m_rng;
+    std::chrono::steady_clock::time_point m_epoch;
+    uint64_t m_startUs;
+    std::array<uint64_t, 2> m_cursorUs{};     // When each bus is free for its next message.
+    std::array<uint64_t, 2> m_busyUs{};
+    std::vector<ScheduleItem> m_schedule;
+    uint64_t m_messages = 0;
+
+    // BM data queue: a ring of monitor words, like the card's BM buffer.
+    bool m_monitoring = false;
+    bool m_queueEnabled = false;
+    bool m_captureFilter = false;
+    std::array<std::array<AiUInt32, 4>, 32> m_monitorFilter{}; // rxSa, txSa, rxMc, txMc bit masks per RT.
+    std::vector<AiUInt32> m_queue;
+    size_t m_queueHead = 0, m_queueCount = 0;
+    std::vector<AiUInt32> m_words;            // The message being stored.
+    AiUInt32 m_lastTimetagHigh = 0xFFFFFFFF;
+    AiUInt32 m_queueStatus = 0;
+    uint64_t m_deliveredBytes = 0, m_lostBytes = 0;
+
+    // BC program.
+    std::map<AiUInt16, AiUInt16> m_bcHeaders;
+    std::map<AiUInt16, TY_API_BC_XFER> m_transfers;
+    std::map<AiUInt16, TY_API_BC_XFER_DSP> m_transferStatus;
+    std::map<AiUInt16, std::vector<AiUInt16>> m_minorFrames;
+    std::vector<AiUInt16> m_majorFrame;
+    bool m_bcRunning = false;
+    AiUInt32 m_bcFramesLeft = 0;              // Minor frames left to run; 0 runs forever.
+    size_t m_bcMinorIndex = 0;
+    uint64_t m_bcFrameUs = 0, m_bcNextFrameUs = 0;
+    std::array<std::vector<Message>, 2> m_bcPending; // Transfers of the current minor frame, per bus.
+    std::array<size_t, 2> m_bcPendingIndex{};
+    std::vector<AiUInt16> m_acyclicFrame;     // Transfers of the prepared acyclic frame.
+    bool m_acyclicAtFrameEnd = false;         // The acyclic frame goes out before the next minor frame.
+
+    // RTs and buffers.
+    bool m_rtRunning = false;
+    std::array<Rt, 32> m_rts{};
+    std::map<AiUInt16, AiUInt16> m_rtHeaders;
+    std::map<std::pair<AiUInt8, AiUInt16>, std::vector<AiUInt16>> m_buffers;
+    // The last data each RT SA received, sent back when the SA is asked to transmit (wrap-around).
+    std::map<std::pair<int, int>, std::array<AiUInt16, 32>> m_saMemory;
+};
@@ -0,0 +1,314 @@
+#include "simulatedDevice.hpp"
+#include <chrono>
+#include <cstring>
+
+/**
+ * @brief Attaches to the simulated board of a module; every stream of the board shares its bus.
+ * @param module The board number.
+ * @param stream The stream (BIU); reported back to interrupt handlers.
+ * @return API_OK.
+ */
+AiReturn SimulatedDevice::open(AiUInt32 module, AiUInt32 stream) {
+    close();
+    m_bus = SimulatedBus::forModule(module, m_config);
+    m_module = module;
+    m_biu = static_cast<AiUInt8>(stream);
+    return API_OK;
+}
+
+/**
+ * @brief Stops the emulated interrupts and detaches from the board.
+ */
+void SimulatedDevice::close() {
+    stopInterrupts();
+    m_handler = nullptr;
+    m_interruptMode = false;
+    m_bus.reset();
+}
+
+/**
+ * @brief Accepted for compatibility; the bus keeps its traffic and the setup of the other streams.
+ */
+AiReturn SimulatedDevice::reset(AiUInt8, AiUInt8, TY_API_RESET_INFO* info) {
+    if (info) memset(info, 0, sizeof(*info));
+    return opened();
+}
+
+/**
+ * @brief Describes the simulated board: two streams, serial number 0.
+ */
+AiReturn SimulatedDevice::getBoardInfo(TY_API_BOARD_INFO* info) {
+    if (!info) return API_ERR_PARAM1_IS_NULL;
+    memset(info, 0, sizeof(*info));
+    info->ul_NumberOfChannels = 2;
+    info->ul_NumberOfBiu = 2;
+    return opened();
+}
+
+AiReturn SimulatedDevice::bmIni(AiUInt8) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setMonitoring(false);
+    m_bus->setCaptureFilter(false);
+    return API_OK;
+}
+
+/**
+ * @brief Selects recording of all messages or, with API_BM_CAPMODE_FILTER, of those passing bmFilterIni().
+ */
+AiReturn SimulatedDevice::bmCapMode(AiUInt8, TY_API_BM_CAP_SETUP* setup) {
+    if (!setup) return API_ERR_PARAM3_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setCaptureFilter(setup->cap_mode == API_BM_CAPMODE_FILTER);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bmFilterIni(AiUInt8, AiUInt8 rt, AiUInt32 rxSa, AiUInt32 txSa, AiUInt32 rxMc, AiUInt32 txMc) {
+    if (rt > 31) return API_ERR_PARAM3_NOT_IN_RANGE;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setMonitorFilter(rt, rxSa, txSa, rxMc, txMc);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bmStart(AiUInt8) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setMonitoring(true);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bmHalt(AiUInt8) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setMonitoring(false);
+    return API_OK;
+}
+
+/**
+ * @brief Enables the emulated half-full interrupt (API_BM_MODE_HFI_INT); only available in real-time mode.
+ */
+AiReturn SimulatedDevice::bmIntrMode(AiUInt8, AiUInt8 intMode, AiUInt8, AiUInt8) {
+    if (!m_bus) return API_ERR_NAK;
+    if (intMode != API_BM_MODE_NO_INT && intMode != API_BM_MODE_HFI_INT) return API_ERR_PARAM3_NOT_IN_RANGE;
+    if (intMode == API_BM_MODE_HFI_INT && !m_config.realTime) return API_ERR_NAK;
+    m_interruptMode = intMode == API_BM_MODE_HFI_INT;
+    if (m_interruptMode && m_handler) startInterrupts(); else stopInterrupts();
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::installInterruptHandler(AiUInt8, AiUInt8 type, InterruptHandler handler) {
+    if (type != API_INT_BM) return API_ERR_PARAM3_NOT_IN_RANGE;
+    if (!m_bus) return API_ERR_NAK;
+    stopInterrupts();
+    m_handler = handler;
+    if (m_interruptMode && m_handler) startInterrupts();
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::deleteInterruptHandler(AiUInt8, AiUInt8 type) {
+    if (type != API_INT_BM) return API_ERR_PARAM3_NOT_IN_RANGE;
+    stopInterrupts();
+    m_handler = nullptr;
+    return opened();
+}
+
+/**
+ * @brief Opens the BM data queue of the board; all BM queue IDs read the one simulated queue.
+ */
+AiReturn SimulatedDevice::dataQueueOpen(AiUInt32 id, AiUInt32* size) {
+    if (id > API_DATA_QUEUE_ID_BM_REC_BIU8) return API_ERR_PARAM2_NOT_IN_RANGE;
+    if (!m_bus) return API_ERR_NAK;
+    if (size) *size = m_bus->queueBytes();
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::dataQueueControl(AiUInt32, AiUInt32 mode) {
+    if (!m_bus) return API_ERR_NAK;
+    if (mode == API_DATA_QUEUE_CTRL_MODE_START || mode == API_DATA_QUEUE_CTRL_MODE_RESUME) m_bus->setQueueEnabled(true);
+    else if (mode == API_DATA_QUEUE_CTRL_MODE_STOP) m_bus->setQueueEnabled(false);
+    else if (mode == API_DATA_QUEUE_CTRL_MODE_FLUSH) { m_bus->setQueueEnabled(false); m_bus->setQueueEnabled(true); }
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::dataQueueClose(AiUInt32) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setQueueEnabled(false);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::dataQueueRead(TY_API_DATA_QUEUE_READ* read, TY_API_DATA_QUEUE_STATUS* status) {
+    if (!read || !read->buffer) return API_ERR_PARAM2_IS_NULL;
+    if (!status) return API_ERR_PARAM3_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->readQueue(read->buffer, read->bytes_to_read, *status);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bcBHDef(AiUInt8, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8, AiUInt8,
+                                  AiUInt8, AiUInt8, AiUInt8, AiUInt8, TY_API_BC_BH_INFO* info) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->defineBcHeader(hid, bid);
+    if (info) { memset(info, 0, sizeof(*info)); info->bid = bid; info->sid = sid; info->eid = eid; info->nbufs = 1; }
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bcXferDef(AiUInt8, TY_API_BC_XFER* xfer, AiUInt32* descAddr) {
+    if (!xfer) return API_ERR_PARAM3_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->defineTransfer(*xfer);
+    if (descAddr) *descAddr = 0;
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bcFrameDef(AiUInt8, TY_API_BC_FRAME* frame) {
+    if (!frame) return API_ERR_PARAM3_IS_NULL;
+    if (frame->id == 0 || frame->id > MAX_API_BC_MFRAME_ID) return API_ERR_PARAM3_NOT_IN_RANGE;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->defineMinorFrame(*frame);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bcMFrameDefEx(AiUInt8, TY_API_BC_MFRAME_EX* majorFrame) {
+    if (!majorFrame) return API_ERR_PARAM3_IS_NULL;
+    if (majorFrame->cnt > MAX_API_BC_MFRAME_EX) return API_ERR_PARAM3_NOT_IN_RANGE;
+    for (AiUInt32 i = 0; i < majorFrame->cnt; ++i) {
+        if (majorFrame->fid[i] == 0 || majorFrame->fid[i] > MAX_API_BC_MFRAME_ID) return API_ERR_PARAM3_NOT_IN_RANGE;
+    }
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->defineMajorFrame(*majorFrame);
+    return API_OK;
+}
+
+/**
+ * @brief Starts the BC program at once, whatever the start mode; count is in major frames, 0 runs until halted.
+ */
+AiReturn SimulatedDevice::bcStart(AiUInt8, AiUInt8, AiUInt32 count, AiFloat frameTimeMs, AiUInt32,
+                                  AiUInt32* majorAddr, AiUInt32* minorAddr) {
+    if (!m_bus) return API_ERR_NAK;
+    if (frameTimeMs <= 0) return API_ERR_PARAM5_NOT_IN_RANGE;
+    m_bus->startBc(count, frameTimeMs);
+    if (majorAddr) *majorAddr = 0;
+    if (minorAddr) *minorAddr = 0;
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bcHalt(AiUInt8) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->haltBc();
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bcXferRead(AiUInt8, AiUInt16 xid, AiUInt16 clr, TY_API_BC_XFER_DSP* status) {
+    if (!status) return API_ERR_PARAM5_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    if (!m_bus->readTransfer(xid, clr, *status)) return API_ERR_NAK;
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bcAcycPrep(AiUInt8, TY_API_BC_ACYC* acyc) {
+    if (!acyc) return API_ERR_PARAM3_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->prepareAcyclic(*acyc);
+    return API_OK;
+}
+
+/**
+ * @brief Sends the prepared acyclic frame. Timetag mode is not simulated and sends at once.
+ */
+AiReturn SimulatedDevice::bcAcycSend(AiUInt8, AiUInt8 mode, AiUInt32, AiUInt32) {
+    if (!m_bus) return API_ERR_NAK;
+    if (mode > API_BC_ACYC_SEND_AT_END_OF_FRAME) return API_ERR_PARAM3_NOT_IN_RANGE;
+    m_bus->sendAcyclic(mode == API_BC_ACYC_SEND_AT_END_OF_FRAME);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bufDef(AiUInt8, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                                 AiUInt16* rid, AiUInt32* raddr) {
+    if (!data) return API_ERR_PARAM7_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->writeBuffer(bufferType, hid, bid, data, length == 0 ? 32 : length);
+    if (rid) *rid = bid;
+    if (raddr) *raddr = 0;
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::bufRead(AiUInt8, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                                  AiUInt16* rid, AiUInt32* raddr) {
+    if (!data) return API_ERR_PARAM7_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->readBuffer(bufferType, hid, bid, data, length == 0 ? 32 : length);
+    if (rid) *rid = bid;
+    if (raddr) *raddr = 0;
+    return API_OK;
+}
+
+/**
+ * @brief Defines an RT; simulated RTs (API_RT_ENABLE_SIMULATION) answer with nxw and serve their SA buffers.
+ */
+AiReturn SimulatedDevice::rtIni(AiUInt8, AiUInt8 rt, AiUInt8 con, AiUInt8, AiFloat, AiUInt16 nxw) {
+    if (rt > 31) return API_ERR_PARAM3_NOT_IN_RANGE;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->defineRt(rt, con == API_RT_ENABLE_SIMULATION, nxw);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::rtBHDef(AiUInt8, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8, AiUInt8,
+                                  AiUInt8, AiUInt8, AiUInt8, AiUInt8, TY_API_RT_BH_INFO* info) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->defineRtHeader(hid, bid);
+    if (info) { memset(info, 0, sizeof(*info)); info->bid = bid; info->sid = sid; info->eid = eid; info->nbufs = 1; }
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::rtSACon(AiUInt8, AiUInt8 rt, AiUInt8 sa, AiUInt16 hid, AiUInt8 saType, AiUInt8 con, AiUInt8,
+                                  AiUInt8, AiUInt16) {
+    if (rt > 31) return API_ERR_PARAM3_NOT_IN_RANGE;
+    if (sa > 31) return API_ERR_PARAM4_NOT_IN_RANGE;
+    if (saType > API_RT_TYPE_TRANSMIT_MODECODE) return API_ERR_PARAM6_NOT_IN_RANGE;
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->defineRtSa(rt, sa, saType, hid, con != API_RT_DISABLE_SA);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::rtStart(AiUInt8) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setRtRunning(true);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::rtHalt(AiUInt8) {
+    if (!m_bus) return API_ERR_NAK;
+    m_bus->setRtRunning(false);
+    return API_OK;
+}
+
+AiReturn SimulatedDevice::rtSAMsgRead(AiUInt8, AiUInt8 rt, AiUInt8 sa, AiUInt8 saType, AiUInt8 clr, TY_API_RT_SA_MSG_DSP* msg) {
+    if (!msg) return API_ERR_PARAM7_IS_NULL;
+    if (!m_bus) return API_ERR_NAK;
+    if (!m_bus->readRtSa(rt, sa, saType, clr != 0, *msg)) return API_ERR_NAK;
+    return API_OK;
+}
+
+/**
+ * @brief Starts the thread that emulates the BM half-full interrupt.
+ */
+void SimulatedDevice::startInterrupts() {
+    if (m_interruptThread.joinable()) return;
+    m_interruptStop = false;
+    m_interruptThread = std::thread(&SimulatedDevice::interruptThreadFunc, this);
+}
+
+void SimulatedDevice::stopInterrupts() {
+    if (!m_interruptThread.joinable()) return;
+    { std::lock_guard<std::mutex> lock(m_interruptMutex); m_interruptStop = true; }
+    m_interruptCv.notify_one();
+    m_interruptThread.join();
+}
+
+/**
+ * @brief Every millisecond, runs the bus to the current time and calls the handler while at least
+ *        INTERRUPT_BYTES wait in the data queue.
+ */
+void SimulatedDevice::interruptThreadFunc() {
+    std::unique_lock<std::mutex> lock(m_interruptMutex);
+    while (!m_interruptCv.wait_for(lock, std::chrono::milliseconds(1), [this] { return m_interruptStop; })) {
+        if (m_bus->queuedBytes() >= INTERRUPT_BYTES) m_handler(m_module, m_biu, API_INT_BM, nullptr);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "aimDevice.hpp"
+#include "simulatedBus.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+/**
+ * @brief A stream of a simulated AIM board (see SimulatedBus), for running the applications, tests and
+ *        benchmarks without hardware. The calls take effect on the simulated bus; setup calls the
+ *        simulation does not model (coupling, BC retry and interrupt modes, ...) are accepted and ignored.
+ *        In real-time mode the BM half-full interrupt is emulated by a thread that polls the data queue.
+ */
+class SimulatedDevice : public AimDevice {
+public:
+    explicit SimulatedDevice(const SimulatorConfig& config) : m_config(config) {}
+    ~SimulatedDevice() override { close(); }
+
+    SimulatedDevice(const SimulatedDevice&) = delete;
+    SimulatedDevice& operator=(const SimulatedDevice&) = delete;
+
+    const char* backendName() const override { return SIMULATOR; }
+    SimulatedBus* bus() const { return m_bus.get(); }
+
+    AiReturn open(AiUInt32 module, AiUInt32 stream) override;
+    void close() override;
+    bool isOpen() const override { return m_bus != nullptr; }
+    AiReturn reset(AiUInt8 biu, AiUInt8 resetMode, TY_API_RESET_INFO* info) override;
+    AiReturn getBoardInfo(TY_API_BOARD_INFO* info) override;
+    AiReturn calCplCon(AiUInt8, AiUInt8, AiUInt8) override { return opened(); }
+
+    AiReturn bmIni(AiUInt8) override;
+    AiReturn bmCapMode(AiUInt8 biu, TY_API_BM_CAP_SETUP* setup) override;
+    AiReturn bmFilterIni(AiUInt8 biu, AiUInt8 rt, AiUInt32 rxSa, AiUInt32 txSa, AiUInt32 rxMc, AiUInt32 txMc) override;
+    AiReturn bmStart(AiUInt8) override;
+    AiReturn bmHalt(AiUInt8) override;
+    AiReturn bmIntrMode(AiUInt8 biu, AiUInt8 intMode, AiUInt8 strobeMode, AiUInt8 res) override;
+    AiReturn installInterruptHandler(AiUInt8 biu, AiUInt8 type, InterruptHandler handler) override;
+    AiReturn deleteInterruptHandler(AiUInt8 biu, AiUInt8 type) override;
+
+    AiReturn dataQueueOpen(AiUInt32 id, AiUInt32* size) override;
+    AiReturn dataQueueControl(AiUInt32 id, AiUInt32 mode) override;
+    AiReturn dataQueueClose(AiUInt32 id) override;
+    AiReturn dataQueueRead(TY_API_DATA_QUEUE_READ* read, TY_API_DATA_QUEUE_STATUS* status) override;
+
+    AiReturn bcIni(AiUInt8, AiUInt8, AiUInt8, AiUInt8, AiUInt8) override { return opened(); }
+    AiReturn bcBHDef(AiUInt8 biu, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8 qsize, AiUInt8 bqm,
+                     AiUInt8 bsm, AiUInt8 sqm, AiUInt8 eqm, AiUInt8 res, TY_API_BC_BH_INFO* info) override;
+    AiReturn bcXferDef(AiUInt8 biu, TY_API_BC_XFER* xfer, AiUInt32* descAddr) override;
+    AiReturn bcFrameDef(AiUInt8 biu, TY_API_BC_FRAME* frame) override;
+    AiReturn bcMFrameDefEx(AiUInt8 biu, TY_API_BC_MFRAME_EX* majorFrame) override;
+    AiReturn bcStart(AiUInt8 biu, AiUInt8 mode, AiUInt32 count, AiFloat frameTimeMs, AiUInt32 startAddr,
+                     AiUInt32* majorAddr, AiUInt32* minorAddr) override;
+    AiReturn bcHalt(AiUInt8 biu) override;
+    AiReturn bcXferRead(AiUInt8 biu, AiUInt16 xid, AiUInt16 clr, TY_API_BC_XFER_DSP* status) override;
+    AiReturn bcAcycPrep(AiUInt8 biu, TY_API_BC_ACYC* acyc) override;
+    AiReturn bcAcycSend(AiUInt8 biu, AiUInt8 mode, AiUInt32 timetagHigh, AiUInt32 timetagLow) override;
+
+    AiReturn bufDef(AiUInt8 biu, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                    AiUInt16* rid, AiUInt32* raddr) override;
+    AiReturn bufRead(AiUInt8 biu, AiUInt8 bufferType, AiUInt16 hid, AiUInt16 bid, AiUInt8 length, AiUInt16* data,
+                     AiUInt16* rid, AiUInt32* raddr) override;
+
+    AiReturn rtIni(AiUInt8 biu, AiUInt8 rt, AiUInt8 con, AiUInt8 bus, AiFloat respTime, AiUInt16 nxw) override;
+    AiReturn rtBHDef(AiUInt8 biu, AiUInt16 hid, AiUInt16 bid, AiUInt16 sid, AiUInt16 eid, AiUInt8 qsize, AiUInt8 bqm,
+                     AiUInt8 bsm, AiUInt8 sqm, AiUInt8 eqm, AiUInt8 res, TY_API_RT_BH_INFO* info) override;
+    AiReturn rtSACon(AiUInt8 biu, AiUInt8 rt, AiUInt8 sa, AiUInt16 hid, AiUInt8 saType, AiUInt8 con, AiUInt8 rmod,
+                     AiUInt8 smod, AiUInt16 swm) override;
+    AiReturn rtStart(AiUInt8 biu) override;
+    AiReturn rtHalt(AiUInt8 biu) override;
+    AiReturn rtSAMsgRead(AiUInt8 biu, AiUInt8 rt, AiUInt8 sa, AiUInt8 saType, AiUInt8 clr, TY_API_RT_SA_MSG_DSP* msg) override;
+
+private:
+    AiReturn opened() const { return m_bus ? API_OK : API_ERR_NAK; }
+    void startInterrupts();
+    void stopInterrupts();
+    void interruptThreadFunc();
+
+    static constexpr AiUInt32 INTERRUPT_BYTES = 16 * 1024;  // Queued data that raises the emulated half-full interrupt.
+
+    const SimulatorConfig m_config;
+    std::shared_ptr<SimulatedBus> m_bus;
+    AiUInt32 m_module = 0;
+    AiUInt8 m_biu = 0;
+    InterruptHandler m_handler = nullptr;
+    bool m_interruptMode = false;
+    std::thread m_interruptThread;
+    std::mutex m_interruptMutex;
+    std::condition_variable m_interruptCv;
+    bool m_interruptStop = false;
+};
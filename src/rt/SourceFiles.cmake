@@ -1,3 +1,8 @@
 set(SOURCEFILES
     ${CMAKE_CURRENT_LIST_DIR}/rt.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/aimDevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/hardwareDevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/simulatedBus.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../device/simulatedDevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../logger.cpp
 )
\ No newline at end of file
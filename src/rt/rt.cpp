@@ -1,4 +1,10 @@
 #include "Api1553.h"
+#include "aimDevice.hpp"
+#include "common.hpp"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <memory>
+#include <string>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -23,41 +29,46 @@ void check_api_status(AiReturn status_code, const char* operation_name) {
     }
 }
 
+// config.json'daki RT_Emulator bölümünden cihaz arka ucunu oku ("aim" veya "simulator")
+std::string load_device_backend() {
+    std::ifstream ifs(Common::getConfigPath());
+    if (!ifs.is_open()) return AimDevice::HARDWARE;
+    try {
+        nlohmann::json config_json;
+        ifs >> config_json;
+        if (config_json.contains("RT_Emulator")) return config_json["RT_Emulator"].value("Device_Backend", std::string(AimDevice::HARDWARE));
+    } catch (const nlohmann::json::exception& e) {
+        fprintf(stderr, "RT HATA: config.json okunamadi: %s\n", e.what());
+    }
+    return AimDevice::HARDWARE;
+}
+
 int main() {
     AiReturn api_status;
-    AiUInt32 rt_module_handle = 0;
     AiUInt8 rt_biu_selection = API_BIU_1; // ApiOpenEx sonrası genellikle önemsiz
     const AiUInt8 RT_ADDRESS = 5;
     const AiUInt8 SUBADDRESS_RECEIVE = 1;
 
     printf("MIL-STD-1553 RT Uygulamasi Baslatiliyor...\n");
 
-    // 1. API Kütüphanesini Başlat
-    api_status = ApiInit();
-    if (api_status <= 0) {
-        fprintf(stderr, "RT HATA: ApiInit basarisiz oldu veya kart bulunamadi. Donus Kodu: %d\n", api_status);
-         if (api_status < 0) check_api_status(api_status, "ApiInit (Hata Durumu)");
+    // 1-2. Cihazı oluştur (AIM kartı veya simülatör) ve RT Stream'ini aç
+    std::unique_ptr<AimDevice> device = AimDevice::create(load_device_backend(), Common::getConfigPath());
+    printf("RT: Cihaz arka ucu: %s\n", device->backendName());
+    api_status = device->open(0,  // Aynı kart
+                              2); // RT için Stream 2
+    if (api_status == API_ERR_NAK) {
+        fprintf(stderr, "RT HATA: Kart bulunamadi.\n");
         return 1;
     }
-    printf("RT BASARILI: ApiInit - %d kart bulundu.\n", api_status);
-
-    // 2. RT Stream'ini Aç
-    TY_API_OPEN rt_open_params;
-    memset(&rt_open_params, 0, sizeof(TY_API_OPEN));
-    rt_open_params.ul_Module = 0;       // Aynı kart
-    rt_open_params.ul_Stream = 2;       // RT için Stream 2
-    strcpy(rt_open_params.ac_SrvName, "local");
-
-    api_status = ApiOpenEx(&rt_open_params, &rt_module_handle);
     check_api_status(api_status, "ApiOpenEx (RT Stream)");
 
     // 3. RT BIU'sunu Sıfırla
     TY_API_RESET_INFO rt_reset_info;
-    api_status = ApiCmdReset(rt_module_handle, rt_biu_selection, API_RESET_ALL, &rt_reset_info);
+    api_status = device->reset(rt_biu_selection, API_RESET_ALL, &rt_reset_info);
     check_api_status(api_status, "ApiCmdReset (RT BIU)");
 
     // 4. RT'yi Başlat (RT 5)
-    api_status = ApiCmdRTIni(rt_module_handle, rt_biu_selection,
+    api_status = device->rtIni(rt_biu_selection,
                              RT_ADDRESS,
                              API_RT_ENABLE_SIMULATION,
                              API_RT_RSP_BOTH_BUSSES, // Her iki veriyolundan da yanıt ver
@@ -72,14 +83,14 @@ int main() {
     const AiUInt16 RT_RECEIVE_HID = 101; // BC'deki hid'den farklı olabilir, RT kendi başlıklarını yönetir
     const AiUInt16 RT_RECEIVE_BID = 101; // RT'nin veriyi saklayacağı arabellek ID'si
 
-    api_status = ApiCmdRTBHDef(rt_module_handle, rt_biu_selection,
+    api_status = device->rtBHDef(rt_biu_selection,
                                RT_RECEIVE_HID, RT_RECEIVE_BID,
                                0, 0, API_QUEUE_SIZE_1, API_BQM_CYCLIC, 0, 0, 0, 0,
                                &rt_bh_info_sa1);
     check_api_status(api_status, "ApiCmdRTBHDef (RT5, SA1 Alim Basligi)");
 
     // 6. RT Subaddress'ini (SA 1) Alıcı Olarak Yapılandır
-    api_status = ApiCmdRTSACon(rt_module_handle, rt_biu_selection,
+    api_status = device->rtSACon(rt_biu_selection,
                                RT_ADDRESS,
                                SUBADDRESS_RECEIVE,
                                RT_RECEIVE_HID, // Yukarıda tanımlanan RT arabellek başlığı
@@ -92,7 +103,7 @@ int main() {
     check_api_status(api_status, "ApiCmdRTSACon (RT5, SA1 Receive)");
 
     // 7. RT Operasyonunu Başlat
-    api_status = ApiCmdRTStart(rt_module_handle, rt_biu_selection);
+    api_status = device->rtStart(rt_biu_selection);
     check_api_status(api_status, "ApiCmdRTStart");
 
     printf("RT %d, SA %d alim icin dinlemede...\n", RT_ADDRESS, SUBADDRESS_RECEIVE);
@@ -105,8 +116,8 @@ int main() {
         sleep(1); // 1 saniye bekle
 
         // SA 1 için mesaj durumunu oku
-        // ApiCmdRTSAMsgRead prototipi: (ul_ModuleHandle, biu, rt_addr, sa, sa_type, clr, *psa_dsp)
-        api_status = ApiCmdRTSAMsgRead(rt_module_handle, rt_biu_selection,
+        // rtSAMsgRead (ApiCmdRTSAMsgRead) prototipi: (biu, rt_addr, sa, sa_type, clr, *psa_dsp)
+        api_status = device->rtSAMsgRead(rt_biu_selection,
                                        RT_ADDRESS, SUBADDRESS_RECEIVE, API_RT_TYPE_RECEIVE_SA,
                                        1, // clr: Durum bitlerini oku ve temizle (1)
                                        &rt_sa_msg_status);
@@ -117,7 +128,7 @@ int main() {
                 printf("RT: SA %d'den veri alindi. Buffer ID: %d\n", SUBADDRESS_RECEIVE, rt_sa_msg_status.bid);
 
                 // Arabellekten veriyi oku
-                api_status = ApiCmdBufRead(rt_module_handle, rt_biu_selection,
+                api_status = device->bufRead(rt_biu_selection,
                                            API_BUF_RT_MSG,       // bt: RT mesaj arabelleği
                                            RT_RECEIVE_HID,       // hid: Arabellek Başlık ID'si
                                            rt_sa_msg_status.bid, // bid: Okunacak arabellek ID'si
@@ -134,12 +145,12 @@ int main() {
     }
 
     // 8. RT Operasyonunu Durdur
-    api_status = ApiCmdRTHalt(rt_module_handle, rt_biu_selection);
+    api_status = device->rtHalt(rt_biu_selection);
     check_api_status(api_status, "ApiCmdRTHalt");
 
     // 9. RT Stream'ini Kapat
-    api_status = ApiClose(rt_module_handle);
-    check_api_status(api_status, "ApiClose (RT Stream)");
+    device->close();
+    printf("RT BASARILI: ApiClose (RT Stream)\n");
 
     printf("MIL-STD-1553 RT Uygulamasi Tamamlandi.\n");
     return 0;
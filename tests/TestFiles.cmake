@@ -1,5 +1,34 @@
 set(TESTFILES
-    ${CMAKE_SOURCE_DIR}/tests/sampleTest.cpp)
+    ${CMAKE_CURRENT_LIST_DIR}/streamDecoderTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/commandWordTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/messageFilterTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/latencyHistogramTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/captureWriterTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/captureIndexTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/parallelCaptureDecoderTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/replayClockTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/simulatedDeviceTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/busStatisticsTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/dataWordTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/spscRingTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/recordRingTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/displayQueueTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/busControllerTest.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/streamDecoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/messageBatch.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/commandWord.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/messageFilter.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/captureWriter.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/captureIndex.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/captureReader.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/parallelCaptureDecoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bc/bc.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/device/simulatedBus.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/../src/device/simulatedDevice.cpp)
 
 set(INCLUDEDIRS
-    ${CMAKE_SOURCE_DIR}/src/)
+    ${CMAKE_CURRENT_LIST_DIR}/../src/
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bm/
+    ${CMAKE_CURRENT_LIST_DIR}/../src/bc/
+    ${CMAKE_CURRENT_LIST_DIR}/../src/device/
+    ${CMAKE_CURRENT_LIST_DIR}/../deps/aim-driver/include/aim_mil_24.22)
@@ -0,0 +1,146 @@
+#include "bc.hpp"
+#include "simulatedDevice.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace {
+constexpr uint64_t FRAME_US = BC_FRAME_TIME_MS * 1000;
+
+SimulatorConfig freeRunning() {
+  SimulatorConfig config;
+  config.realTime = false;
+  return config;
+}
+
+FrameConfig frameConfig(BcMode mode, int rt, int sa, int wc) {
+  FrameConfig config{};
+  config.label = "RT" + std::to_string(rt) + " SA" + std::to_string(sa);
+  config.bus = 'A';
+  config.rt = rt;
+  config.sa = sa;
+  config.wc = wc;
+  config.mode = mode;
+  return config;
+}
+
+// A BusController on a free-running simulated board; the test moves bus time with bus()->runFor().
+struct SimulatedBc {
+  explicit SimulatedBc(int module) {
+    auto owned = std::make_unique<SimulatedDevice>(freeRunning());
+    device = owned.get();
+    EXPECT_EQ(API_OK, bc.initialize(std::move(owned), module));
+  }
+
+  BusController::ScheduledFrame define(const FrameConfig &config) {
+    BusController::ScheduledFrame frame{config, {}};
+    EXPECT_EQ(API_OK, bc.defineFrameResources(config, frame.ids));
+    return frame;
+  }
+
+  AiUInt32 sent(const BusController::ScheduledFrame &frame) {
+    TY_API_BC_XFER_DSP status{};
+    EXPECT_EQ(API_OK, device->bcXferRead(0, frame.ids.transferId, API_DONT_MODIFY_STATUS_BITS, &status));
+    return status.msg_cnt;
+  }
+
+  BusController bc;
+  SimulatedDevice *device = nullptr;
+};
+
+// 200 full-length transfers: more than the MAX_API_BC_XFRAME one minor frame holds.
+std::vector<BusController::ScheduledFrame> defineLongSchedule(SimulatedBc &sim) {
+  std::vector<BusController::ScheduledFrame> frames;
+  for (int i = 0; i < 200; ++i) frames.push_back(sim.define(frameConfig(BcMode::BC_TO_RT, 1 + i % 30, 1 + i / 30, 0)));
+  return frames;
+}
+} // namespace
+
+TEST(BusControllerTest, schedulePacksFramesIntoMinorFramesOfTheFrameTime) {
+  SimulatedBc sim(20);
+  const std::vector<BusController::ScheduledFrame> frames = defineLongSchedule(sim);
+  ASSERT_EQ(API_OK, sim.bc.startCyclicSchedule(frames, true));
+  ASSERT_EQ(2, sim.bc.scheduleMinorFrames());
+
+  // The first minor frame sends the first MAX_API_BC_XFRAME frames within its BC_FRAME_TIME_MS; the rest wait for the second.
+  sim.device->bus()->runFor(FRAME_US - 1);
+  for (size_t i = 0; i < frames.size(); ++i) EXPECT_EQ(i < MAX_API_BC_XFRAME ? 1u : 0u, sim.sent(frames[i])) << i;
+  sim.device->bus()->runFor(FRAME_US);
+  for (size_t i = 0; i < frames.size(); ++i) EXPECT_EQ(i < 2 * MAX_API_BC_XFRAME ? 1u : 0u, sim.sent(frames[i])) << i;
+  EXPECT_EQ(API_OK, sim.bc.stopCyclicSchedule());
+}
+
+TEST(BusControllerTest, singleRunSendsOneMajorFrame) {
+  SimulatedBc sim(21);
+  const std::vector<BusController::ScheduledFrame> frames = defineLongSchedule(sim);
+  ASSERT_EQ(API_OK, sim.bc.startCyclicSchedule(frames, false));
+
+  sim.device->bus()->runFor(10 * FRAME_US);
+  for (size_t i = 0; i < frames.size(); ++i) EXPECT_EQ(1u, sim.sent(frames[i])) << i;
+}
+
+TEST(BusControllerTest, insertCompletesWithoutHaltingTheSchedule) {
+  SimulatedBc sim(22);
+  const BusController::ScheduledFrame cyclic = sim.define(frameConfig(BcMode::BC_TO_RT, 5, 1, 2));
+  const BusController::ScheduledFrame once = sim.define(frameConfig(BcMode::RT_TO_BC, 6, 3, 4));
+  ASSERT_EQ(API_OK, sim.bc.startCyclicSchedule({cyclic}, true));
+  sim.device->bus()->runFor(FRAME_US / 4);
+  ASSERT_EQ(1u, sim.sent(cyclic));
+
+  // The insert goes out at the end of the minor frame.
+  BusController::PendingSend pending;
+  ASSERT_EQ(API_OK, sim.bc.sendAcyclicFrame(once, pending));
+  EXPECT_TRUE(pending.inserted);
+  sim.device->bus()->runFor(FRAME_US);
+  std::array<AiUInt16, BC_MAX_DATA_WORDS> received{};
+  BusController::SendReport report;
+  ASSERT_EQ(API_OK, sim.bc.finishAcyclicFrame(pending, received, &report));
+
+  EXPECT_FALSE(report.error);
+  EXPECT_TRUE(sim.bc.isScheduleRunning());
+  // The insert has a transfer of its own; the frame's scheduled transfer is not counted.
+  EXPECT_EQ(0u, sim.sent(once));
+  const AiUInt32 cyclicSent = sim.sent(cyclic);
+  EXPECT_EQ(2u, cyclicSent);
+  sim.device->bus()->runFor(3 * FRAME_US);
+  EXPECT_EQ(cyclicSent + 3, sim.sent(cyclic));
+}
+
+TEST(BusControllerTest, sendOnceReturnsBeforeTheTransferIsDone) {
+  SimulatedBc sim(23);
+  const BusController::ScheduledFrame frame = sim.define(frameConfig(BcMode::RT_TO_BC, 7, 2, 3));
+
+  BusController::PendingSend pending;
+  ASSERT_EQ(API_OK, sim.bc.sendAcyclicFrame(frame, pending));
+  EXPECT_FALSE(pending.inserted);
+  EXPECT_EQ(0u, sim.sent(frame));
+  // One send is pending at a time.
+  BusController::PendingSend second;
+  EXPECT_EQ(API_ERR, sim.bc.sendAcyclicFrame(frame, second));
+
+  sim.device->bus()->runFor(1000);
+  std::array<AiUInt16, BC_MAX_DATA_WORDS> received{};
+  BusController::SendReport report;
+  ASSERT_EQ(API_OK, sim.bc.finishAcyclicFrame(pending, received, &report));
+  EXPECT_FALSE(report.error);
+  EXPECT_EQ(1u, sim.sent(frame));
+  EXPECT_EQ(API_OK, sim.bc.sendAcyclicFrame(frame, pending));
+  sim.device->bus()->runFor(1000);
+  EXPECT_EQ(API_OK, sim.bc.finishAcyclicFrame(pending, received, &report));
+}
+
+TEST(BusControllerTest, sendOnceWorksForTransferIdsBeyondTheMinorFrameIds) {
+  SimulatedBc sim(24);
+  const std::vector<BusController::ScheduledFrame> frames = defineLongSchedule(sim);
+  const BusController::ScheduledFrame &frame = frames.back();
+  ASSERT_GT(frame.ids.transferId, MAX_API_BC_MFRAME_ID);
+
+  BusController::PendingSend pending;
+  ASSERT_EQ(API_OK, sim.bc.sendAcyclicFrame(frame, pending));
+  EXPECT_FALSE(pending.inserted);
+  sim.device->bus()->runFor(1000);
+  std::array<AiUInt16, BC_MAX_DATA_WORDS> received{};
+  BusController::SendReport report;
+  ASSERT_EQ(API_OK, sim.bc.finishAcyclicFrame(pending, received, &report));
+  EXPECT_FALSE(report.error);
+  EXPECT_EQ(1u, sim.sent(frame));
+}
@@ -0,0 +1,121 @@
+#include "busStatistics.hpp"
+#include "monitorWords.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+MessageTransaction message(AiUInt16 cmd, int dataCount, bool responded, bool busB = false) {
+  MessageTransaction trans;
+  trans.clear();
+  trans.header.full_timetag = 1234;
+  trans.header.cmd1 = cmd;
+  trans.header.flags = MSG_CMD1_VALID | (busB ? MSG_CMD1_BUS_B : 0) | (responded ? MSG_STAT1_VALID : 0);
+  trans.header.data_count = static_cast<AiUInt8>(dataCount);
+  return trans;
+}
+
+const BusStatistics::Row *find(const std::vector<BusStatistics::Row> &rows, int busIdx, int rt, int sa, bool transmit) {
+  for (const auto &row : rows) {
+    if (row.index == BusStatistics::entryIndex(busIdx, rt, sa, transmit)) return &row;
+  }
+  return nullptr;
+}
+} // namespace
+
+TEST(BusStatisticsTest, countsMessagesResponsesAndWordCounts) {
+  BusStatistics stats;
+  stats.record(message(0x0823, 3, true));                    // RT 1 SA 1 receive, WC 3
+  stats.record(message(0x0823, 2, true));                    // one data word short
+  stats.record(message(0x0C23, 0, false));                   // RT 1 SA 1 transmit, no response: not a mismatch
+  stats.record(message(0x0823, 3, true, true));              // bus B
+  stats.record(MessageTransaction::makeGap(5, 100, GAP_LOCAL_OVERFLOW));
+
+  std::vector<BusStatistics::Row> rows;
+  stats.snapshot(rows);
+  ASSERT_EQ(3u, rows.size());
+  const auto *receive = find(rows, 0, 1, 1, false);
+  ASSERT_NE(nullptr, receive);
+  EXPECT_EQ(2u, receive->counters.messages);
+  EXPECT_EQ(1u, receive->counters.wordCountMismatches);
+  EXPECT_EQ(0u, receive->counters.noResponses);
+  EXPECT_EQ(1234u, receive->counters.lastTimetag);
+  const auto *transmit = find(rows, 0, 1, 1, true);
+  ASSERT_NE(nullptr, transmit);
+  EXPECT_EQ(1u, transmit->counters.noResponses);
+  EXPECT_EQ(0u, transmit->counters.wordCountMismatches);
+  const auto *busB = find(rows, 1, 1, 1, false);
+  ASSERT_NE(nullptr, busB);
+  EXPECT_EQ(1u, busB->counters.messages);
+
+  stats.reset();
+  stats.snapshot(rows);
+  EXPECT_TRUE(rows.empty());
+}
+
+TEST(BusStatisticsTest, errorWordsCountForTheMessageTheyFollow) {
+  using namespace MonitorWords;
+  // The card's word order: a message, then its error word, then the next message's timetag.
+  const uint64_t timetag = fullTimetag(1000000);
+  const std::vector<AiUInt32> words = {
+      timetagHighWord(timetag), timetagLowWord(timetag), busWord('B', COMMAND, 0x0823), errorWord(0x0040),
+      timetagLowWord(timetag + 100), busWord('A', COMMAND, 0x0823), busWord('A', DATA, 1), busWord('A', DATA, 2),
+      busWord('A', DATA, 3), busWord('A', STATUS, 0x0800)};
+  BusStatistics stats;
+  Bm1553StreamDecoder decoder;
+  decoder.feed(words.data(), words.size(), [&stats](const MessageTransaction &trans) { stats.record(trans); });
+  ASSERT_TRUE(decoder.flush());
+  stats.record(decoder.completed());
+
+  std::vector<BusStatistics::Row> rows;
+  stats.snapshot(rows);
+  ASSERT_EQ(2u, rows.size());
+  const auto *failed = find(rows, 1, 1, 1, false);
+  ASSERT_NE(nullptr, failed);
+  EXPECT_EQ(1u, failed->counters.messages);
+  EXPECT_EQ(1u, failed->counters.noResponses);
+  EXPECT_EQ(1u, failed->counters.errorWords);
+  const auto *good = find(rows, 0, 1, 1, false);
+  ASSERT_NE(nullptr, good);
+  EXPECT_EQ(0u, good->counters.errorWords);
+  EXPECT_EQ(0u, good->counters.noResponses);
+}
+
+TEST(BusStatisticsTest, rtToRtCountsBothTerminals) {
+  BusStatistics stats;
+  MessageTransaction trans = message(0x1043, 2, true); // RT 2 SA 2 receives two words...
+  trans.header.cmd2 = 0x1C42;                           // ...from RT 3 SA 2
+  trans.header.flags |= MSG_CMD2_VALID;                  // The receiver did not answer (no stat2).
+  stats.record(trans);
+
+  std::vector<BusStatistics::Row> rows;
+  stats.snapshot(rows);
+  ASSERT_EQ(2u, rows.size());
+  EXPECT_EQ(1u, find(rows, 0, 2, 2, false)->counters.noResponses);
+  EXPECT_EQ(0u, find(rows, 0, 3, 2, true)->counters.noResponses);
+}
+
+TEST(BusStatisticsTest, snapshotsAreConsistentWhileCounting) {
+  BusStatistics stats;
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    // Every message has no response and a short word count, so each entry must keep its counters equal.
+    for (int i = 0; i < 200000; ++i) stats.record(message(static_cast<AiUInt16>(0x0821 + ((i & 3) << 5)), 0, false));
+    done.store(true);
+  });
+  std::vector<BusStatistics::Row> rows;
+  uint64_t last = 0;
+  while (!done.load()) {
+    stats.snapshot(rows);
+    for (const auto &row : rows) {
+      ASSERT_EQ(row.counters.messages, row.counters.noResponses);
+      ASSERT_EQ(row.counters.messages, row.counters.wordCountMismatches);
+    }
+    if (!rows.empty()) { ASSERT_GE(rows[0].counters.messages, last); last = rows[0].counters.messages; }
+  }
+  writer.join();
+  stats.snapshot(rows);
+  ASSERT_EQ(4u, rows.size());
+  for (const auto &row : rows) EXPECT_EQ(50000u, row.counters.messages);
+}
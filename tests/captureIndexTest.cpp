@@ -0,0 +1,104 @@
+#include "captureIndex.hpp"
+#include "captureWriter.hpp"
+#include "monitorStreams.hpp"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+using MonitorStreams::expectSameMessages;
+
+std::vector<MessageTransaction> decodeAll(const std::vector<AiUInt32> &words, const CaptureIndex::Query &query) {
+  std::vector<MessageTransaction> result;
+  Bm1553StreamDecoder decoder;
+  auto collect = [&](const MessageTransaction &trans) { if (query.matches(trans)) result.push_back(trans); };
+  decoder.feed(words.data(), words.size(), collect);
+  if (decoder.flush()) collect(decoder.completed());
+  return result;
+}
+
+std::vector<MessageTransaction> findAll(const std::string &path, const CaptureIndex &index, const CaptureIndex::Query &query) {
+  CaptureReader reader;
+  std::string error;
+  EXPECT_TRUE(reader.open(path, error)) << error;
+  std::vector<MessageTransaction> result;
+  index.find(reader, query, [&](const MessageTransaction &trans) { result.push_back(trans); });
+  return result;
+}
+} // namespace
+
+TEST(CaptureIndexTest, queriesMatchALinearDecode) {
+  const std::string path = ::testing::TempDir() + "captureIndexTest.bmc";
+  std::vector<AiUInt32> words = MonitorStreams::make(40000, 50);
+  CaptureWriter writer;
+  CaptureFormat::FileHeader header{};
+  header.startHostTimeNs = 42;
+  std::string error;
+  ASSERT_TRUE(writer.open(path, header, error)) << error;
+  // Irregular block sizes, so messages straddle blocks and index entries.
+  for (size_t pos = 0, n = 0; pos < words.size(); pos += n) {
+    n = std::min(words.size() - pos, static_cast<size_t>(7 + (pos * 31) % 997));
+    ASSERT_TRUE(writer.append(&words[pos], static_cast<uint32_t>(n * 4), pos, 0, 0));
+  }
+  writer.close();
+  EXPECT_TRUE(writer.indexError().empty());
+
+  CaptureIndex index;
+  ASSERT_TRUE(index.load(path, error)) << error;
+  ASSERT_GT(index.entries().size(), 2u);
+
+  CaptureIndex::Query query;
+  query.rt = 12;
+  query.sa = 3;
+  query.fromUs = 300000;
+  query.toUs = 900000;
+  std::vector<MessageTransaction> expected = decodeAll(words, query);
+  ASSERT_FALSE(expected.empty());
+  expectSameMessages(expected, findAll(path, index, query));
+  EXPECT_LT(index.candidates(query).size(), index.entries().size());
+
+  // Rebuilt offline with small entries, nearly every message straddles an entry boundary.
+  ASSERT_TRUE(CaptureIndexBuilder::rebuild(path, error, 512)) << error;
+  CaptureIndex fine;
+  ASSERT_TRUE(fine.load(path, error)) << error;
+  EXPECT_GT(fine.entries().size(), 10 * index.entries().size());
+  expectSameMessages(expected, findAll(path, fine, query));
+
+  CaptureIndex::Query busB;
+  busB.bus = 'B';
+  busB.rt = 5;
+  expectSameMessages(decodeAll(words, busB), findAll(path, fine, busB));
+
+  std::remove(path.c_str());
+  std::remove(CaptureIndex::pathFor(path).c_str());
+}
+
+TEST(CaptureIndexTest, missingOrStaleIndexIsRebuilt) {
+  const std::string path = ::testing::TempDir() + "captureIndexStale.bmc";
+  std::vector<AiUInt32> words = MonitorStreams::make(100, 50);
+  CaptureWriter writer;
+  std::string error;
+  ASSERT_TRUE(writer.open(path, CaptureFormat::FileHeader{}, error)) << error;
+  ASSERT_TRUE(writer.append(words.data(), static_cast<uint32_t>(words.size() * 4), 1, 0, 0));
+  writer.close();
+  std::remove(CaptureIndex::pathFor(path).c_str());
+
+  CaptureIndex index;
+  ASSERT_TRUE(index.load(path, error)) << error;
+  ASSERT_EQ(index.entries().size(), 1u);
+  EXPECT_EQ(index.entries()[0].messageCount, 100u);
+  EXPECT_EQ(index.entries()[0].firstTimeUs, 50u);
+  EXPECT_EQ(index.entries()[0].lastTimeUs, 100u * 50);
+
+  // A capture cut short while recording: the last block is truncated and the index no longer matches.
+  std::FILE *file = std::fopen(path.c_str(), "ab");
+  // Magic, a 400 byte payload that is never written, host time, no loss, no gap, no flags, reserved.
+  const CaptureFormat::BlockHeader partial{CaptureFormat::BLOCK_MAGIC, 400, 2, 0, 0, 0, {0, 0}};
+  std::fwrite(&partial, sizeof(partial), 1, file);
+  std::fclose(file);
+  ASSERT_TRUE(index.load(path, error)) << error;
+  EXPECT_EQ(index.entries().size(), 1u);
+
+  std::remove(path.c_str());
+  std::remove(CaptureIndex::pathFor(path).c_str());
+}
@@ -0,0 +1,113 @@
+#include "captureWriter.hpp"
+#include "streamDecoder.hpp"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+std::vector<unsigned char> readFile(const std::string &path) {
+  std::vector<unsigned char> bytes;
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file) return bytes;
+  unsigned char buffer[4096];
+  size_t n;
+  while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + n);
+  std::fclose(file);
+  return bytes;
+}
+} // namespace
+
+TEST(CaptureWriterTest, blocksRoundTripInOrder) {
+  const std::string path = ::testing::TempDir() + "captureWriterTest.bmc";
+  CaptureWriter writer;
+  CaptureFormat::FileHeader header{};
+  header.device = 2;
+  header.stream = 1;
+  std::strcpy(header.filterExpression, "rt=5");
+  std::string error;
+  ASSERT_TRUE(writer.open(path, header, error)) << error;
+
+  const AiUInt32 first[] = {0x20000001, 0x10000421};
+  const AiUInt32 second[] = {0x30000003};
+  EXPECT_TRUE(writer.append(first, sizeof(first), 111, 0, 0));
+  EXPECT_TRUE(writer.append(second, sizeof(second), 222, 64, GAP_LOCAL_OVERFLOW));
+  writer.close();
+  EXPECT_FALSE(writer.isOpen());
+  EXPECT_FALSE(writer.append(first, sizeof(first), 333, 0, 0));
+
+  std::vector<unsigned char> bytes = readFile(path);
+  const size_t blockBytes = sizeof(CaptureFormat::BlockHeader);
+  ASSERT_EQ(bytes.size(), sizeof(CaptureFormat::FileHeader) + 2 * blockBytes + sizeof(first) + sizeof(second));
+  EXPECT_EQ(writer.bytesWritten(), bytes.size());
+  EXPECT_EQ(writer.blocksCaptured(), 2u);
+
+  CaptureFormat::FileHeader readHeader;
+  std::memcpy(&readHeader, bytes.data(), sizeof(readHeader));
+  EXPECT_EQ(std::memcmp(readHeader.magic, CaptureFormat::FILE_MAGIC, sizeof(readHeader.magic)), 0);
+  EXPECT_EQ(readHeader.version, CaptureFormat::VERSION);
+  EXPECT_EQ(readHeader.headerBytes, sizeof(CaptureFormat::FileHeader));
+  EXPECT_EQ(readHeader.device, 2u);
+  EXPECT_STREQ(readHeader.filterExpression, "rt=5");
+
+  size_t offset = sizeof(CaptureFormat::FileHeader);
+  CaptureFormat::BlockHeader block;
+  std::memcpy(&block, bytes.data() + offset, blockBytes);
+  EXPECT_EQ(block.magic, CaptureFormat::BLOCK_MAGIC);
+  EXPECT_EQ(block.payloadBytes, sizeof(first));
+  EXPECT_EQ(block.hostTimeNs, 111u);
+  EXPECT_EQ(std::memcmp(bytes.data() + offset + blockBytes, first, sizeof(first)), 0);
+
+  offset += blockBytes + sizeof(first);
+  std::memcpy(&block, bytes.data() + offset, blockBytes);
+  EXPECT_EQ(block.payloadBytes, sizeof(second));
+  EXPECT_EQ(block.lostBytesBefore, 64u);
+  EXPECT_EQ(block.gapReason, GAP_LOCAL_OVERFLOW);
+  std::remove(path.c_str());
+}
+
+TEST(CaptureWriterTest, fullBuffersAreWrittenWhileCapturing) {
+  const std::string path = ::testing::TempDir() + "captureWriterLarge.bmc";
+  CaptureWriter writer;
+  std::string error;
+  ASSERT_TRUE(writer.open(path, CaptureFormat::FileHeader{}, error)) << error;
+  std::vector<AiUInt32> chunk(64 * 1024 / 4, 0x12345678);
+  const size_t blocks = 3 * CaptureWriter::BUFFER_BYTES / (chunk.size() * 4);
+  size_t captured = 0;
+  for (size_t i = 0; i < blocks; ++i) {
+    captured += writer.append(chunk.data(), static_cast<uint32_t>(chunk.size() * 4), i, 0, 0) ? 1 : 0;
+  }
+  writer.close();
+  EXPECT_EQ(captured + writer.droppedBlocks(), blocks);
+  EXPECT_EQ(writer.writeErrors(), 0u);
+  EXPECT_EQ(readFile(path).size(), sizeof(CaptureFormat::FileHeader) + captured * (sizeof(CaptureFormat::BlockHeader) + chunk.size() * 4));
+  std::remove(path.c_str());
+}
+
+TEST(CaptureWriterTest, cardFilterFlagIsSetWhenTheFilterTurnsOnDuringTheCapture) {
+  const std::string path = ::testing::TempDir() + "captureWriterCardFilterTest.bmc";
+  CaptureWriter writer;
+  CaptureFormat::FileHeader header{};
+  std::string error;
+  ASSERT_TRUE(writer.open(path, header, error)) << error;
+  const AiUInt32 words[] = {0x20000001, 0x10000421};
+  EXPECT_TRUE(writer.append(words, sizeof(words), 1, 0, 0));
+  EXPECT_TRUE(writer.append(words, sizeof(words), 2, 0, 0, CaptureFormat::BLOCK_FLAG_CARD_FILTER));
+  writer.close();
+
+  std::vector<unsigned char> bytes = readFile(path);
+  const size_t blockBytes = sizeof(CaptureFormat::BlockHeader);
+  ASSERT_EQ(bytes.size(), sizeof(CaptureFormat::FileHeader) + 2 * (blockBytes + sizeof(words)));
+  CaptureFormat::FileHeader readHeader;
+  std::memcpy(&readHeader, bytes.data(), sizeof(readHeader));
+  EXPECT_EQ(std::memcmp(readHeader.magic, CaptureFormat::FILE_MAGIC, sizeof(readHeader.magic)), 0);
+  EXPECT_TRUE(readHeader.flags & CaptureFormat::FLAG_CARD_FILTER);
+
+  CaptureFormat::BlockHeader block;
+  size_t offset = sizeof(CaptureFormat::FileHeader);
+  std::memcpy(&block, bytes.data() + offset, blockBytes);
+  EXPECT_EQ(block.flags, 0u);
+  std::memcpy(&block, bytes.data() + offset + blockBytes + sizeof(words), blockBytes);
+  EXPECT_EQ(block.flags, CaptureFormat::BLOCK_FLAG_CARD_FILTER);
+  std::remove(path.c_str());
+}
@@ -0,0 +1,29 @@
+#include "commandWord.hpp"
+#include "gtest/gtest.h"
+
+TEST(CommandWordTest, tableMatchesFieldDecoding) {
+  // RT 5, receive, SA 3, WC 0 (= 32 words)
+  const auto &receive = describeCommandWord(0x2860);
+  EXPECT_EQ(receive.rt(), 5);
+  EXPECT_EQ(receive.sa(), 3);
+  EXPECT_EQ(receive.kind(), CommandKind::RECEIVE);
+  EXPECT_EQ(receive.dataWords, 32);
+
+  // RT 1, transmit, SA 2, WC 4
+  const auto &transmit = describeCommandWord(0x0C44);
+  EXPECT_EQ(transmit.kind(), CommandKind::TRANSMIT);
+  EXPECT_TRUE(transmit.isTransmit());
+  EXPECT_EQ(transmit.dataWords, 4);
+
+  // RT 2, transmit, mode code 2 (transmit status word): no data
+  const auto &mc = describeCommandWord(0x1402);
+  EXPECT_EQ(mc.kind(), CommandKind::MODE_CODE);
+  EXPECT_EQ(mc.modeCode(), 2);
+  EXPECT_EQ(mc.dataWords, 0);
+
+  // RT 2, transmit, SA 31, mode code 16 (transmit vector word): one data word
+  const auto &mcData = describeCommandWord(0x17F0);
+  EXPECT_EQ(mcData.kind(), CommandKind::MODE_CODE_DATA);
+  EXPECT_EQ(mcData.sa(), 31);
+  EXPECT_EQ(mcData.dataWords, 1);
+}
@@ -0,0 +1,33 @@
+#include "common.hpp"
+#include "gtest/gtest.h"
+
+TEST(DataWordTest, parsesOneToFourHexDigits) {
+  uint16_t word = 0;
+  EXPECT_TRUE(Common::parseDataWord("BEEF", word));
+  EXPECT_EQ(0xBEEF, word);
+  EXPECT_TRUE(Common::parseDataWord("1a", word));
+  EXPECT_EQ(0x001A, word);
+  EXPECT_TRUE(Common::parseDataWord("0x1553", word));
+  EXPECT_EQ(0x1553, word);
+  EXPECT_TRUE(Common::parseDataWord("0", word));
+  EXPECT_EQ(0, word);
+}
+
+TEST(DataWordTest, rejectsInvalidTextAndKeepsTheWord) {
+  uint16_t word = 0x1234;
+  EXPECT_FALSE(Common::parseDataWord("", word));
+  EXPECT_FALSE(Common::parseDataWord("0x", word));
+  EXPECT_FALSE(Common::parseDataWord("12345", word));
+  EXPECT_FALSE(Common::parseDataWord("12G4", word));
+  EXPECT_FALSE(Common::parseDataWord("-1", word));
+  EXPECT_FALSE(Common::parseDataWord(" 12", word));
+  EXPECT_EQ(0x1234, word);
+}
+
+TEST(DataWordTest, formatsFourUpperCaseDigits) {
+  EXPECT_EQ("00AF", Common::formatDataWord(0x00AF));
+  EXPECT_EQ("FFFF", Common::formatDataWord(0xFFFF));
+  uint16_t word = 0;
+  ASSERT_TRUE(Common::parseDataWord(Common::formatDataWord(0xC0DE), word));
+  EXPECT_EQ(0xC0DE, word);
+}
@@ -0,0 +1,44 @@
+#include "displayQueue.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace {
+MessageTransaction message(uint64_t timetag) {
+  MessageTransaction trans;
+  trans.clear();
+  trans.header.full_timetag = timetag;
+  trans.header.flags = MSG_CMD1_VALID;
+  return trans;
+}
+
+MessageBatch batchOf(const std::shared_ptr<MessageBatchPool> &pool, const std::vector<MessageTransaction> &records) {
+  MessageBatch batch = pool->acquire();
+  for (const auto &trans : records) EXPECT_TRUE(batch.push(trans));
+  return batch;
+}
+} // namespace
+
+TEST(DisplayQueueTest, droppedBatchLeavesItsGapsAndADropMarker) {
+  auto pool = MessageBatchPool::create(8, 8);
+  DisplayQueue queue(2);
+  EXPECT_TRUE(queue.push(batchOf(pool, {message(1), MessageTransaction::makeGap(2, 64, GAP_LOCAL_OVERFLOW), message(3)})));
+  EXPECT_TRUE(queue.push(batchOf(pool, {message(4)})));
+  EXPECT_FALSE(queue.push(batchOf(pool, {message(5)})));
+  // Dropping the marker batch as well folds its count into the next marker.
+  EXPECT_FALSE(queue.push(batchOf(pool, {message(6)})));
+  EXPECT_EQ(queue.droppedBatches(), 2u);
+  EXPECT_EQ(queue.droppedMessages(), 3u);
+
+  std::vector<MessageBatch> batches;
+  ASSERT_EQ(queue.drain(batches), 2u);
+  ASSERT_EQ(batches[0].size(), 3u);
+  EXPECT_TRUE(batches[0][0].isGap());
+  EXPECT_FALSE(batches[0][0].isDisplayDrop());
+  EXPECT_EQ(batches[0][0].gapLostBytes(), 64u);
+  EXPECT_TRUE(batches[0][1].isDisplayDrop());
+  EXPECT_EQ(batches[0][1].droppedMessages(), 3u);
+  EXPECT_EQ(batches[0][1].header.full_timetag, 4u);
+  EXPECT_EQ(batches[0][2].header.full_timetag, 5u);
+  ASSERT_EQ(batches[1].size(), 1u);
+  EXPECT_EQ(batches[1][0].header.full_timetag, 6u);
+}
@@ -0,0 +1,40 @@
+#include "latencyHistogram.hpp"
+#include "streamDecoder.hpp"
+#include "gtest/gtest.h"
+
+TEST(LatencyHistogramTest, percentilesWithinBucketResolution) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(50), 0u);
+  for (uint64_t us = 1; us <= 1000; ++us) histogram.record(us);
+  EXPECT_EQ(histogram.count(), 1000u);
+  EXPECT_NEAR(static_cast<double>(histogram.percentile(50)), 500.0, 500.0 * 0.125);
+  EXPECT_NEAR(static_cast<double>(histogram.percentile(99)), 990.0, 990.0 * 0.125);
+  EXPECT_LE(histogram.percentile(50), histogram.percentile(99));
+
+  for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+    EXPECT_EQ(LatencyHistogram::bucketOf(LatencyHistogram::bucketLowerBound(i)), i);
+  }
+}
+
+TEST(LatencyHistogramTest, timetagFieldsConvertToMicroseconds) {
+  // Day 2, 03:04:05.000006
+  uint64_t high = (2u << 11) | (3u << 6) | 4u;
+  uint64_t low = (5u << 20) | 6u;
+  EXPECT_EQ(timetagMicroseconds((high << 26) | low), 6u + 1000000ull * (5 + 60 * (4 + 60 * (3 + 24 * 2))));
+}
+
+TEST(LatencyHistogramTest, offsetBaseFollowsClockDrift) {
+  OffsetWindowMin base;
+  EXPECT_EQ(base.update(0, 500), 500);
+  EXPECT_EQ(base.update(100, 700), 500);
+  // The card clock runs slow, so the host-minus-card offset grows by 50 us/s; a run-long minimum
+  // would report all of it as latency, the window only what is older than the window.
+  int64_t latency = 0;
+  for (int64_t second = 1; second <= 3600; ++second) {
+    int64_t offset = 500 + 50 * second;
+    latency = offset - base.update(second * 1000000, offset);
+  }
+  EXPECT_LT(latency, 50 * OffsetWindowMin::WINDOW_SECONDS);
+  base.reset();
+  EXPECT_EQ(base.update(3601000000, 100000), 100000);
+}
@@ -0,0 +1,87 @@
+#include "messageFilter.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+MessageTransaction makeMessage(char bus, int rt, int tr, int sa, int wc, std::initializer_list<AiUInt16> data = {}) {
+  MessageTransaction trans;
+  trans.clear();
+  trans.header.cmd1 = static_cast<AiUInt16>((rt << 11) | (tr << 10) | (sa << 5) | (wc & 0x1F));
+  trans.header.flags = MSG_CMD1_VALID | (bus == 'B' ? MSG_CMD1_BUS_B : 0);
+  trans.header.stat1 = static_cast<AiUInt16>(rt << 11);
+  trans.header.flags |= MSG_STAT1_VALID;
+  for (AiUInt16 word : data) trans.data_words[trans.header.data_count++] = word;
+  return trans;
+}
+
+MessageFilter compileOrFail(const std::string &expression) {
+  MessageFilter filter;
+  std::string error;
+  EXPECT_TRUE(MessageFilter::compile(expression, filter, error)) << error;
+  return filter;
+}
+} // namespace
+
+TEST(MessageFilterTest, keyTermsCompileToBitmap) {
+  MessageFilter filter = compileOrFail("bus=A rt=1-4,7 sa=2 dir=R || bus=B rt=10");
+  EXPECT_EQ(filter.residualClauseCount(), 0u);
+  EXPECT_TRUE(filter.accepts(makeMessage('A', 3, 0, 2, 4)));
+  EXPECT_TRUE(filter.accepts(makeMessage('A', 7, 0, 2, 4)));
+  EXPECT_FALSE(filter.accepts(makeMessage('A', 5, 0, 2, 4)));
+  EXPECT_FALSE(filter.accepts(makeMessage('A', 3, 1, 2, 4)));
+  EXPECT_FALSE(filter.accepts(makeMessage('B', 3, 0, 2, 4)));
+  EXPECT_TRUE(filter.accepts(makeMessage('B', 10, 1, 31, 2)));
+}
+
+TEST(MessageFilterTest, residualPredicates) {
+  MessageFilter filter = compileOrFail("rt=5 mc=2 || data[1]&0xFF00=0x1200 || rt=6 error");
+  EXPECT_EQ(filter.residualClauseCount(), 3u);
+  EXPECT_TRUE(filter.accepts(makeMessage('A', 5, 1, 0, 2)));
+  EXPECT_FALSE(filter.accepts(makeMessage('A', 5, 1, 0, 4)));
+  EXPECT_FALSE(filter.accepts(makeMessage('A', 5, 1, 2, 2)));
+  EXPECT_TRUE(filter.accepts(makeMessage('B', 9, 0, 3, 2, {0x0000, 0x12AB})));
+  EXPECT_FALSE(filter.accepts(makeMessage('B', 9, 0, 3, 1, {0x0000})));
+
+  MessageTransaction withError = makeMessage('A', 6, 0, 1, 1, {0});
+  EXPECT_FALSE(filter.accepts(withError));
+  withError.header.flags |= MSG_ERROR_VALID;
+  EXPECT_TRUE(filter.accepts(withError));
+}
+
+TEST(MessageFilterTest, negationAndSyntaxErrors) {
+  MessageFilter filter = compileOrFail("!rt=0-9 && !noresp");
+  EXPECT_TRUE(filter.accepts(makeMessage('A', 12, 0, 1, 1)));
+  EXPECT_FALSE(filter.accepts(makeMessage('A', 2, 0, 1, 1)));
+  MessageTransaction noResponse = makeMessage('A', 12, 0, 1, 1);
+  noResponse.header.flags &= static_cast<AiUInt16>(~MSG_STAT1_VALID);
+  EXPECT_FALSE(filter.accepts(noResponse));
+
+  EXPECT_TRUE(compileOrFail("").accepts(makeMessage('B', 1, 1, 1, 1)));
+  EXPECT_FALSE(MessageFilter().isEnabled());
+
+  MessageFilter unchanged;
+  std::string error;
+  EXPECT_FALSE(MessageFilter::compile("rt=32", unchanged, error));
+  EXPECT_FALSE(MessageFilter::compile("bus=A ||", unchanged, error));
+  EXPECT_FALSE(MessageFilter::compile("foo=1", unchanged, error));
+  EXPECT_NE(error.find("foo"), std::string::npos);
+  EXPECT_FALSE(unchanged.isEnabled());
+}
+
+TEST(MessageFilterTest, treeCriteriaMatchPreviousSemantics) {
+  EXPECT_EQ(MessageFilter::criteriaExpression('a', 5, -1, 2), "bus=A rt=5 mc=2");
+  MessageFilter saFilter = compileOrFail(MessageFilter::criteriaExpression('A', 5, 0, -1));
+  // SA 0 is a mode code subaddress, which an SA selection never matches.
+  EXPECT_FALSE(saFilter.accepts(makeMessage('A', 5, 1, 0, 2)));
+}
+
+TEST(MessageFilterTest, cardFilterCoversAcceptedKeys) {
+  MessageFilter::CardFilter card;
+  EXPECT_FALSE(MessageFilter().cardFilter(card));
+  EXPECT_FALSE(compileOrFail("error").cardFilter(card));
+
+  ASSERT_TRUE(compileOrFail("bus=A rt=5 sa=3 dir=R || rt=7 mc=2").cardFilter(card));
+  EXPECT_EQ(card[5].rxSa, 1u << 3);
+  EXPECT_EQ(card[5].txSa, 0u);
+  EXPECT_EQ(card[7].txMc, 0xFFFFFFFFu);
+  EXPECT_EQ(card[6].rxSa | card[6].txSa | card[6].rxMc | card[6].txMc, 0u);
+}
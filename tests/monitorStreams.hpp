@@ -0,0 +1,48 @@
+#pragma once
+
+#include "monitorWords.hpp"
+#include "streamDecoder.hpp"
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Deterministic BM recordings shared by the capture tests, and how to compare their decodes.
+ */
+namespace MonitorStreams {
+
+/**
+ * @brief BC to RT messages on alternating buses: message i goes to RT i % 31, SA i % 7 + 1 with
+ *        i % 9 + 1 data words (each holding i) at (i + 1) * spacingUs microseconds. The high timetag
+ *        word is written first and again whenever it changes, i.e. every minute of bus time.
+ */
+inline std::vector<AiUInt32> make(int messages, uint64_t spacingUs) {
+  std::vector<AiUInt32> words;
+  for (int i = 0; i < messages; ++i) {
+    const char bus = i % 2 == 1 ? 'B' : 'A';
+    const int rt = i % 31, sa = i % 7 + 1, wc = i % 9 + 1;
+    const uint64_t timetag = MonitorWords::fullTimetag((i + 1) * spacingUs);
+    const AiUInt32 high = MonitorWords::timetagHighWord(timetag);
+    if (i == 0 || high != MonitorWords::timetagHighWord(MonitorWords::fullTimetag(i * spacingUs))) words.push_back(high);
+    words.push_back(MonitorWords::timetagLowWord(timetag));
+    words.push_back(MonitorWords::busWord(bus, MonitorWords::COMMAND, MonitorWords::commandWord(rt, 0, sa, wc)));
+    for (int d = 0; d < wc; ++d) words.push_back(MonitorWords::busWord(bus, MonitorWords::DATA, static_cast<AiUInt16>(i)));
+    words.push_back(MonitorWords::busWord(bus, MonitorWords::STATUS, static_cast<AiUInt16>(rt << 11)));
+  }
+  return words;
+}
+
+/**
+ * @brief Expects two decodes of a stream to yield the same messages in the same order.
+ */
+inline void expectSameMessages(const std::vector<MessageTransaction> &expected, const std::vector<MessageTransaction> &actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i].header.flags, actual[i].header.flags) << "message " << i;
+    ASSERT_EQ(expected[i].header.cmd1, actual[i].header.cmd1) << "message " << i;
+    ASSERT_EQ(expected[i].header.full_timetag, actual[i].header.full_timetag) << "message " << i;
+    ASSERT_EQ(expected[i].header.data_count, actual[i].header.data_count) << "message " << i;
+  }
+}
+
+} // namespace MonitorStreams
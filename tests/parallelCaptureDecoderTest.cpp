@@ -0,0 +1,119 @@
+#include "captureWriter.hpp"
+#include "monitorStreams.hpp"
+#include "parallelCaptureDecoder.hpp"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+using MonitorStreams::expectSameMessages;
+
+// One message every 60 ms, so the high timetag word changes every 1000 messages.
+constexpr uint64_t kSpacingUs = 60000;
+
+// Writes the words in irregular blocks; the block starting at gapAt (if any) follows lost data.
+void writeCapture(const std::string &path, const std::vector<AiUInt32> &words, size_t gapAt = SIZE_MAX) {
+  CaptureWriter writer;
+  std::string error;
+  ASSERT_TRUE(writer.open(path, CaptureFormat::FileHeader{}, error)) << error;
+  for (size_t pos = 0, n = 0; pos < words.size(); pos += n) {
+    n = std::min(words.size() - pos, static_cast<size_t>(5 + (pos * 13) % 701));
+    bool gap = pos <= gapAt && gapAt < pos + n;
+    ASSERT_TRUE(writer.append(&words[pos], static_cast<uint32_t>(n * 4), pos, gap ? 128 : 0, gap ? GAP_LOCAL_OVERFLOW : 0));
+  }
+  writer.close();
+}
+
+std::vector<MessageTransaction> decodeParallel(const CaptureReader &reader, unsigned threads, uint64_t partBytes) {
+  std::vector<MessageTransaction> result;
+  ParallelCaptureDecoder::Options options;
+  options.threads = threads;
+  options.partBytes = partBytes;
+  ParallelCaptureDecoder::decode(reader, options, [](const MessageTransaction &) { return true; },
+                                 [&](const MessageTransaction &trans) { result.push_back(trans); });
+  return result;
+}
+} // namespace
+
+TEST(ParallelCaptureDecoderTest, matchesASequentialDecode) {
+  const std::string path = ::testing::TempDir() + "parallelDecoderTest.bmc";
+  std::vector<AiUInt32> words = MonitorStreams::make(20000, kSpacingUs);
+  writeCapture(path, words);
+
+  std::vector<MessageTransaction> expected;
+  Bm1553StreamDecoder decoder;
+  decoder.feed(words.data(), words.size(), [&](const MessageTransaction &trans) { expected.push_back(trans); });
+  if (decoder.flush()) expected.push_back(decoder.completed());
+
+  CaptureReader reader;
+  std::string error;
+  ASSERT_TRUE(reader.open(path, error)) << error;
+  auto parts = ParallelCaptureDecoder::plan(ParallelCaptureDecoder::collectSpans(reader), 4096);
+  EXPECT_GT(parts.size(), 50u);
+  expectSameMessages(expected, decodeParallel(reader, 4, 4096));
+  expectSameMessages(expected, decodeParallel(reader, 1, UINT64_MAX));
+  std::remove(path.c_str());
+  std::remove(CaptureIndex::pathFor(path).c_str());
+}
+
+// The high timetag word is written once (50 us apart) or every 10000 messages (6 ms apart, once a minute): most parts
+// contain none and take it, and the timetag of their first messages, from parts far before them.
+TEST(ParallelCaptureDecoderTest, rareHighTimetagWordsMatchASequentialDecode) {
+  for (uint64_t spacingUs : {50u, 6000u}) {
+    SCOPED_TRACE(spacingUs);
+    const std::string path = ::testing::TempDir() + "parallelDecoderRareHigh.bmc";
+    std::vector<AiUInt32> words = MonitorStreams::make(20000, spacingUs);
+    size_t highWords = 0;
+    for (AiUInt32 word : words) highWords += (word >> 28) == 0x3 ? 1 : 0;
+    EXPECT_LE(highWords, 3u);
+
+    std::vector<MessageTransaction> expected;
+    Bm1553StreamDecoder decoder;
+    decoder.feed(words.data(), words.size(), [&](const MessageTransaction &trans) { expected.push_back(trans); });
+    if (decoder.flush()) expected.push_back(decoder.completed());
+
+    writeCapture(path, words);
+    CaptureReader reader;
+    std::string error;
+    ASSERT_TRUE(reader.open(path, error)) << error;
+    EXPECT_GT(ParallelCaptureDecoder::plan(ParallelCaptureDecoder::collectSpans(reader), 4096).size(), 50u);
+    expectSameMessages(expected, decodeParallel(reader, 4, 4096));
+    reader.close();
+
+    // With lost data in the middle, gap markers take their timetag from the message before them.
+    writeCapture(path, words, words.size() / 2 + 3);
+    ASSERT_TRUE(reader.open(path, error)) << error;
+    expectSameMessages(decodeParallel(reader, 1, UINT64_MAX), decodeParallel(reader, 4, 4096));
+    reader.close();
+    std::remove(path.c_str());
+    std::remove(CaptureIndex::pathFor(path).c_str());
+  }
+}
+
+TEST(ParallelCaptureDecoderTest, gapsAndFilteringArePreserved) {
+  const std::string path = ::testing::TempDir() + "parallelDecoderGap.bmc";
+  std::vector<AiUInt32> words = MonitorStreams::make(5000, kSpacingUs);
+  writeCapture(path, words, words.size() / 2);
+
+  CaptureReader reader;
+  std::string error;
+  ASSERT_TRUE(reader.open(path, error)) << error;
+  std::vector<MessageTransaction> sequential = decodeParallel(reader, 1, UINT64_MAX);
+  expectSameMessages(sequential, decodeParallel(reader, 3, 2048));
+  size_t gaps = 0;
+  for (const auto &trans : sequential) gaps += trans.isGap() ? 1 : 0;
+  EXPECT_EQ(gaps, 1u);
+
+  ParallelCaptureDecoder::Options options;
+  options.threads = 3;
+  options.partBytes = 2048;
+  size_t rt7 = 0, gapMarkers = 0;
+  auto result = ParallelCaptureDecoder::decode(reader, options, [](const MessageTransaction &trans) { return (trans.header.cmd1 >> 11) == 7; },
+                                               [&](const MessageTransaction &trans) { trans.isGap() ? ++gapMarkers : ++rt7; });
+  EXPECT_EQ(rt7, 5000u / 31 + 1);
+  EXPECT_EQ(gapMarkers, 1u);
+  EXPECT_EQ(result.messages, rt7 + gapMarkers);
+  EXPECT_EQ(result.bytes, words.size() * 4);
+  std::remove(path.c_str());
+  std::remove(CaptureIndex::pathFor(path).c_str());
+}
@@ -0,0 +1,36 @@
+#include "recordRing.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+MessageTransaction message(uint64_t timetag) {
+  MessageTransaction trans;
+  trans.clear();
+  trans.header.full_timetag = timetag;
+  return trans;
+}
+} // namespace
+
+TEST(RecordRingTest, wrapsAcrossChunksOldestFirst) {
+  const size_t capacity = RecordRing::CHUNK_ENTRIES + 100;
+  RecordRing ring(capacity);
+  for (uint64_t i = 0; i < capacity; ++i) ring.push(message(i));
+  ASSERT_EQ(ring.size(), capacity);
+  EXPECT_EQ(ring.at(0).header.full_timetag, 0u);
+  EXPECT_EQ(ring.at(RecordRing::CHUNK_ENTRIES).header.full_timetag, RecordRing::CHUNK_ENTRIES);
+  const MessageTransaction *first = &ring.at(0);
+
+  // Overwriting reuses the same storage: nothing is moved once allocated.
+  const uint64_t pushed = 2 * capacity + 7;
+  for (uint64_t i = capacity; i < pushed; ++i) ring.push(message(i));
+  EXPECT_EQ(ring.size(), capacity);
+  EXPECT_EQ(ring.totalPushed(), pushed);
+  for (size_t i = 0; i < capacity; i += 997) EXPECT_EQ(ring.at(i).header.full_timetag, pushed - capacity + i);
+  EXPECT_EQ(ring.at(capacity - 1).header.full_timetag, pushed - 1);
+  EXPECT_EQ(&ring.at(capacity - 7), first);
+
+  ring.clear();
+  EXPECT_EQ(ring.size(), 0u);
+  ring.push(message(42));
+  EXPECT_EQ(ring.at(0).header.full_timetag, 42u);
+  EXPECT_EQ(&ring.at(0), first);
+}
@@ -0,0 +1,29 @@
+#include "replayClock.hpp"
+#include "gtest/gtest.h"
+
+using namespace std::chrono;
+
+TEST(ReplayClockTest, scalesCaptureTimeBySpeed) {
+  ReplayClock clock;
+  const auto t0 = ReplayClock::Clock::now();
+  clock.rebase(1000000000ull, t0);
+  EXPECT_EQ(clock.delayUntil(1000000000ull + 500000000ull, t0), duration_cast<ReplayClock::Clock::duration>(milliseconds(500)));
+  EXPECT_EQ(clock.delayUntil(1000000000ull + 500000000ull, t0 + milliseconds(200)), duration_cast<ReplayClock::Clock::duration>(milliseconds(300)));
+  EXPECT_EQ(clock.delayUntil(1000000000ull + 500000000ull, t0 + seconds(1)), ReplayClock::Clock::duration::zero());
+
+  clock.setSpeed(10);
+  clock.rebase(2000000000ull, t0);
+  EXPECT_EQ(clock.delayUntil(3000000000ull, t0), duration_cast<ReplayClock::Clock::duration>(milliseconds(100)));
+}
+
+TEST(ReplayClockTest, unpacedAndEarlierTimesAreDueAtOnce) {
+  ReplayClock clock;
+  const auto t0 = ReplayClock::Clock::now();
+  clock.rebase(5000000000ull, t0);
+  // A block stamped before the base (host clock step while recording) does not stall playback.
+  EXPECT_EQ(clock.delayUntil(4000000000ull, t0), ReplayClock::Clock::duration::zero());
+
+  clock.setSpeed(0);
+  EXPECT_TRUE(clock.unpaced());
+  EXPECT_EQ(clock.delayUntil(9000000000ull, t0), ReplayClock::Clock::duration::zero());
+}
@@ -1,7 +0,0 @@
-#include "dummy.hpp"
-#include "gtest/gtest.h"
-
-TEST(SampleTest, sampleTest) {
-  EXPECT_TRUE(true);
-  EXPECT_EQ(return1(), 1);
-}
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "simulatedDevice.hpp"
+#include "streamDecoder.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace {
+// Free-running bus time starts at 1 s; reads keep generating traffic, so tests count messages up to a time.
+constexpr uint64_t START_US = 1000000;
+
+SimulatorConfig freeRunning() {
+  SimulatorConfig config;
+  config.realTime = false;
+  return config;
+}
+
+SimulatedTraffic traffic(char bus, int rt, int sa, bool transmit, int wordCount, double rateHz) {
+  SimulatedTraffic t;
+  t.bus = bus; t.rt = rt; t.sa = sa; t.transmit = transmit; t.wordCount = wordCount; t.rateHz = rateHz;
+  return t;
+}
+
+void startMonitor(SimulatedDevice &device) {
+  AiUInt32 size = 0;
+  ASSERT_EQ(API_OK, device.bmIni(1));
+  ASSERT_EQ(API_OK, device.dataQueueOpen(API_DATA_QUEUE_ID_BM_REC_BIU1, &size));
+  ASSERT_GT(size, 0u);
+  ASSERT_EQ(API_OK, device.dataQueueControl(API_DATA_QUEUE_ID_BM_REC_BIU1, API_DATA_QUEUE_CTRL_MODE_START));
+  ASSERT_EQ(API_OK, device.bmStart(1));
+}
+
+// Reads the data queue until it has nothing more to give (at most `reads` times) and decodes it.
+std::vector<MessageTransaction> readMessages(SimulatedDevice &device, int reads, TY_API_DATA_QUEUE_STATUS *lastStatus = nullptr) {
+  std::vector<AiUInt32> words(16 * 1024);
+  std::vector<MessageTransaction> messages;
+  Bm1553StreamDecoder decoder;
+  for (int i = 0; i < reads; ++i) {
+    TY_API_DATA_QUEUE_READ read{API_DATA_QUEUE_ID_BM_REC_BIU1, words.data(), static_cast<AiUInt32>(words.size() * 4)};
+    TY_API_DATA_QUEUE_STATUS status{};
+    EXPECT_EQ(API_OK, device.dataQueueRead(&read, &status));
+    if (lastStatus) *lastStatus = status;
+    if (status.bytes_transfered == 0) break;
+    decoder.feed(words.data(), status.bytes_transfered / 4, [&](const MessageTransaction &trans) { messages.push_back(trans); });
+  }
+  if (decoder.flush()) messages.push_back(decoder.completed());
+  return messages;
+}
+} // namespace
+
+TEST(SimulatedDeviceTest, monitorStreamFollowsTheSchedule) {
+  SimulatorConfig config = freeRunning();
+  config.schedule.push_back(traffic('A', 5, 1, false, 2, 1000));
+  config.schedule.push_back(traffic('B', 6, 2, true, 4, 500));
+  SimulatedDevice device(config);
+  ASSERT_EQ(API_OK, device.open(11, 1));
+  startMonitor(device);
+  device.bus()->runFor(1000000);
+  std::vector<MessageTransaction> messages = readMessages(device, 100);
+
+  int bcToRt = 0, rtToBc = 0;
+  uint64_t lastUs = 0;
+  for (const MessageTransaction &trans : messages) {
+    ASSERT_TRUE(trans.cmd1Valid());
+    ASSERT_TRUE(trans.stat1Valid());
+    const uint64_t us = timetagMicroseconds(trans.header.full_timetag);
+    ASSERT_GE(us, lastUs);
+    lastUs = us;
+    if (us >= START_US + 1000000) continue;
+    if (trans.header.cmd1 == ((5 << 11) | (1 << 5) | 2)) { ++bcToRt; EXPECT_EQ(2, trans.header.data_count); EXPECT_FALSE(trans.has(MSG_CMD1_BUS_B)); }
+    if (trans.header.cmd1 == ((6 << 11) | (1 << 10) | (2 << 5) | 4)) { ++rtToBc; EXPECT_EQ(4, trans.header.data_count); EXPECT_TRUE(trans.has(MSG_CMD1_BUS_B)); }
+  }
+  EXPECT_GT(lastUs, START_US + 1000000);
+  EXPECT_NEAR(1000, bcToRt, 1);
+  EXPECT_NEAR(500, rtToBc, 1);
+}
+
+TEST(SimulatedDeviceTest, bcTransfersReachTheRtBuffers) {
+  SimulatedDevice rt(freeRunning()), bc(freeRunning());
+  ASSERT_EQ(API_OK, rt.open(12, 2));
+  ASSERT_EQ(API_OK, bc.open(12, 1));
+
+  // RT 5 receives on SA 1 and transmits from SA 2.
+  AiUInt16 transmitData[4] = {0x1111, 0x2222, 0x3333, 0x4444};
+  ASSERT_EQ(API_OK, rt.rtIni(0, 5, API_RT_ENABLE_SIMULATION, API_RT_RSP_BOTH_BUSSES, 8.0f, 5 << 11));
+  ASSERT_EQ(API_OK, rt.rtBHDef(0, 101, 101, 0, 0, API_QUEUE_SIZE_1, API_BQM_CYCLIC, 0, 0, 0, 0, nullptr));
+  ASSERT_EQ(API_OK, rt.rtBHDef(0, 102, 102, 0, 0, API_QUEUE_SIZE_1, API_BQM_CYCLIC, 0, 0, 0, 0, nullptr));
+  ASSERT_EQ(API_OK, rt.rtSACon(0, 5, 1, 101, API_RT_TYPE_RECEIVE_SA, API_RT_ENABLE_SA, 0, API_RT_SWM_OR, 0));
+  ASSERT_EQ(API_OK, rt.rtSACon(0, 5, 2, 102, API_RT_TYPE_TRANSMIT_SA, API_RT_ENABLE_SA, 0, API_RT_SWM_OR, 0));
+  ASSERT_EQ(API_OK, rt.bufDef(0, API_BUF_RT_MSG, 102, 0, 4, transmitData, nullptr, nullptr));
+  ASSERT_EQ(API_OK, rt.rtStart(0));
+
+  // The BC sends two words to RT 5 SA 1, then asks SA 2 for four.
+  AiUInt16 sendData[2] = {0xBEEF, 0x1553};
+  TY_API_BC_XFER send{}, receive{};
+  send.xid = 1; send.hid = 1; send.type = API_BC_TYPE_BCRT; send.rcv_rt = 5; send.rcv_sa = 1; send.wcnt = 2;
+  receive.xid = 2; receive.hid = 2; receive.type = API_BC_TYPE_RTBC; receive.xmt_rt = 5; receive.xmt_sa = 2; receive.wcnt = 4;
+  ASSERT_EQ(API_OK, bc.bcBHDef(0, 1, 1, 0, 0, API_QUEUE_SIZE_1, API_BQM_CYCLIC, 0, 0, 0, 0, nullptr));
+  ASSERT_EQ(API_OK, bc.bcBHDef(0, 2, 2, 0, 0, API_QUEUE_SIZE_1, API_BQM_CYCLIC, 0, 0, 0, 0, nullptr));
+  ASSERT_EQ(API_OK, bc.bcXferDef(0, &send, nullptr));
+  ASSERT_EQ(API_OK, bc.bcXferDef(0, &receive, nullptr));
+  ASSERT_EQ(API_OK, bc.bufDef(0, API_BUF_BC_MSG, 1, 1, 2, sendData, nullptr, nullptr));
+  TY_API_BC_FRAME minor{};
+  minor.id = 1; minor.cnt = 2;
+  minor.instr[0] = minor.instr[1] = API_BC_INSTR_TRANSFER;
+  minor.xid[0] = 1; minor.xid[1] = 2;
+  TY_API_BC_MFRAME_EX major{};
+  major.cnt = 1; major.fid[0] = 1;
+  ASSERT_EQ(API_OK, bc.bcFrameDef(0, &minor));
+  ASSERT_EQ(API_OK, bc.bcMFrameDefEx(0, &major));
+  ASSERT_EQ(API_OK, bc.bcStart(0, API_BC_START_IMMEDIATELY, 1, 10.0f, 0, nullptr, nullptr));
+  bc.bus()->runFor(10000);
+
+  TY_API_RT_SA_MSG_DSP status{};
+  ASSERT_EQ(API_OK, rt.rtSAMsgRead(0, 5, 1, API_RT_TYPE_RECEIVE_SA, 1, &status));
+  EXPECT_EQ(API_BUF_FULL, (status.trw & 0x00E0) >> 5);
+  EXPECT_EQ(101, status.bid);
+  EXPECT_EQ((5 << 11) | (1 << 5) | 2, status.lcw);
+  AiUInt16 received[2] = {};
+  ASSERT_EQ(API_OK, rt.bufRead(0, API_BUF_RT_MSG, 101, status.bid, 2, received, nullptr, nullptr));
+  EXPECT_EQ(0xBEEF, received[0]);
+  EXPECT_EQ(0x1553, received[1]);
+  ASSERT_EQ(API_OK, rt.rtSAMsgRead(0, 5, 1, API_RT_TYPE_RECEIVE_SA, 1, &status));
+  EXPECT_EQ(API_BUF_EMPTY, (status.trw & 0x00E0) >> 5);
+
+  AiUInt16 readBack[4] = {};
+  ASSERT_EQ(API_OK, bc.bufRead(0, API_BUF_BC_MSG, 2, 2, 4, readBack, nullptr, nullptr));
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(transmitData[i], readBack[i]);
+
+  // One major frame: each transfer ran once and reports the RT's answer.
+  TY_API_BC_XFER_DSP transfer{};
+  ASSERT_EQ(API_OK, bc.bcXferRead(0, 2, API_DONT_MODIFY_STATUS_BITS, &transfer));
+  EXPECT_EQ(1u, transfer.msg_cnt);
+  EXPECT_EQ(0u, transfer.err_cnt);
+  EXPECT_EQ((5 << 11) | (1 << 10) | (2 << 5) | 4, transfer.cw1);
+  EXPECT_EQ(5 << 11, transfer.st1);
+  EXPECT_EQ(API_BUF_FULL, (transfer.brw & API_BRW_BUFSTAT_MASK) >> 12);
+  EXPECT_EQ(API_ERR_NAK, bc.bcXferRead(0, 3, API_DONT_MODIFY_STATUS_BITS, &transfer));
+}
+
+TEST(SimulatedDeviceTest, acyclicInsertWaitsForTheMinorFrameEndWithoutStoppingTheSchedule) {
+  SimulatedDevice device(freeRunning());
+  ASSERT_EQ(API_OK, device.open(15, 1));
+  startMonitor(device);
+
+  // A cyclic transfer to RT 5 SA 1 every 10 ms minor frame; RT 6 SA 3 only gets the acyclic insert.
+  TY_API_BC_XFER cyclic{}, inserted{};
+  cyclic.xid = 1; cyclic.hid = 1; cyclic.type = API_BC_TYPE_BCRT; cyclic.rcv_rt = 5; cyclic.rcv_sa = 1; cyclic.wcnt = 2;
+  inserted.xid = 2; inserted.hid = 2; inserted.type = API_BC_TYPE_BCRT; inserted.rcv_rt = 6; inserted.rcv_sa = 3; inserted.wcnt = 1;
+  ASSERT_EQ(API_OK, device.bcXferDef(0, &cyclic, nullptr));
+  ASSERT_EQ(API_OK, device.bcXferDef(0, &inserted, nullptr));
+  TY_API_BC_FRAME minor{};
+  minor.id = 1; minor.cnt = 1; minor.instr[0] = API_BC_INSTR_TRANSFER; minor.xid[0] = 1;
+  TY_API_BC_MFRAME_EX major{};
+  major.cnt = 1; major.fid[0] = 1;
+  ASSERT_EQ(API_OK, device.bcFrameDef(0, &minor));
+  ASSERT_EQ(API_OK, device.bcMFrameDefEx(0, &major));
+  ASSERT_EQ(API_OK, device.bcStart(0, API_BC_START_IMMEDIATELY, 0, 10.0f, 0, nullptr, nullptr));
+  device.bus()->runFor(25000);
+
+  TY_API_BC_ACYC acyclic{};
+  acyclic.cnt = 1; acyclic.instr[0] = API_BC_INSTR_TRANSFER; acyclic.xid[0] = 2;
+  ASSERT_EQ(API_OK, device.bcAcycPrep(0, &acyclic));
+  ASSERT_EQ(API_OK, device.bcAcycSend(0, API_BC_ACYC_SEND_AT_END_OF_FRAME, 0, 0));
+  device.bus()->runFor(30000);
+
+  std::vector<uint64_t> cyclicUs, insertedUs;
+  for (const MessageTransaction &trans : readMessages(device, 10)) {
+    const uint64_t us = timetagMicroseconds(trans.header.full_timetag);
+    if (trans.header.cmd1 == ((5 << 11) | (1 << 5) | 2)) cyclicUs.push_back(us);
+    if (trans.header.cmd1 == ((6 << 11) | (3 << 5) | 1)) insertedUs.push_back(us);
+  }
+  ASSERT_EQ(1u, insertedUs.size());
+  ASSERT_GE(cyclicUs.size(), 5u);
+  // The insert leads the minor frame after the send (at 30 ms); the schedule keeps its 10 ms period.
+  EXPECT_EQ(cyclicUs[0] + 30000, insertedUs[0]);
+  EXPECT_GT(cyclicUs[3], insertedUs[0]);
+  EXPECT_LT(cyclicUs[3], insertedUs[0] + 100);
+  EXPECT_EQ(cyclicUs[0] + 40000, cyclicUs[4]);
+}
+
+TEST(SimulatedDeviceTest, fullBusOverflowsTheQueueWithoutBreakingMessages) {
+  SimulatorConfig config = freeRunning();
+  config.fillPercent = 100;
+  config.fillErrorPerMille = 50;
+  config.dataQueueBytes = 64 * 1024;
+  SimulatedDevice device(config);
+  ASSERT_EQ(API_OK, device.open(13, 1));
+  startMonitor(device);
+  device.bus()->runFor(100000);
+
+  TY_API_DATA_QUEUE_STATUS status{};
+  std::vector<MessageTransaction> messages = readMessages(device, 1, &status);
+  EXPECT_TRUE(status.status & API_DATA_QUEUE_STATUS_LOC_OVERFLOW);
+  EXPECT_GT(status.total_bytes_transfered, uint64_t(status.bytes_transfered));
+  ASSERT_FALSE(messages.empty());
+  int noResponse = 0;
+  for (const MessageTransaction &trans : messages) {
+    if (trans.errorValid()) { ++noResponse; continue; }
+    ASSERT_TRUE(trans.cmd1Valid());
+    ASSERT_NE(0u, trans.header.full_timetag);
+  }
+  EXPECT_GT(noResponse, 0);
+}
+
+TEST(SimulatedDeviceTest, cardFilterCapturesOnlySelectedSubaddresses) {
+  SimulatorConfig config = freeRunning();
+  config.fillPercent = 50;
+  config.schedule.push_back(traffic('A', 7, 3, false, 1, 2000));
+  SimulatedDevice device(config);
+  ASSERT_EQ(API_OK, device.open(14, 1));
+  startMonitor(device);
+  TY_API_BM_CAP_SETUP setup{};
+  setup.cap_mode = API_BM_CAPMODE_FILTER;
+  ASSERT_EQ(API_OK, device.bmCapMode(1, &setup));
+  ASSERT_EQ(API_OK, device.bmFilterIni(1, 7, 1u << 3, 0, 0, 0));
+  device.bus()->runFor(100000);
+
+  // Background messages to RT 7 SA 3 pass the filter too; the scheduled ones have one data word.
+  std::vector<MessageTransaction> messages = readMessages(device, 10);
+  int scheduled = 0;
+  for (const MessageTransaction &trans : messages) {
+    ASSERT_EQ((7 << 11) | (3 << 5), trans.header.cmd1 & 0xFFE0);
+    if (trans.header.cmd1 == ((7 << 11) | (3 << 5) | 1) && timetagMicroseconds(trans.header.full_timetag) < START_US + 100000) ++scheduled;
+  }
+  EXPECT_GE(scheduled, 199);
+}
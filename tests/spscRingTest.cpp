@@ -0,0 +1,26 @@
+#include "spscRing.hpp"
+#include "gtest/gtest.h"
+
+TEST(SpscRingTest, fullRingCountsOnceUntilASlotIsFreed) {
+  SpscRing<int> ring(2);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(ring.beginWrite(), nullptr);
+    ring.commitWrite();
+  }
+  // A producer polling a full ring is one episode, not one per poll.
+  for (int poll = 0; poll < 5; ++poll) EXPECT_EQ(ring.beginWrite(), nullptr);
+  EXPECT_EQ(ring.fullEpisodes(), 1u);
+
+  ASSERT_NE(ring.beginRead(), nullptr);
+  ring.commitRead();
+  ASSERT_NE(ring.beginWrite(), nullptr);
+  ring.commitWrite();
+  EXPECT_EQ(ring.beginWrite(), nullptr);
+  EXPECT_EQ(ring.beginWrite(), nullptr);
+  EXPECT_EQ(ring.fullEpisodes(), 2u);
+  EXPECT_EQ(ring.highWaterMark(), 2u);
+
+  ring.reset();
+  EXPECT_EQ(ring.fullEpisodes(), 0u);
+  EXPECT_EQ(ring.size(), 0u);
+}
@@ -0,0 +1,95 @@
+#include "streamDecoder.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace {
+AiUInt32 timetagHigh(AiUInt32 value) { return (0x3u << 28) | (value & 0x000FFFFF); }
+AiUInt32 timetagLow(AiUInt32 value) { return (0x2u << 28) | (value & 0x03FFFFFF); }
+AiUInt32 busAWord(AiUInt32 kind, AiUInt16 word) { return ((0x8u | kind) << 28) | word; }
+
+std::vector<AiUInt32> bcToRtMessage(AiUInt32 tt, AiUInt16 cmd, int dataWords) {
+  std::vector<AiUInt32> words = {timetagLow(tt), busAWord(0x0, cmd)};
+  for (int i = 0; i < dataWords; ++i) words.push_back(busAWord(0x2, static_cast<AiUInt16>(0x1000 + i)));
+  words.push_back(busAWord(0x3, 0x0800));
+  return words;
+}
+} // namespace
+
+TEST(StreamDecoderTest, messageSplitAcrossChunksIsReassembled) {
+  std::vector<AiUInt32> stream = {timetagHigh(1)};
+  auto first = bcToRtMessage(100, 0x0823, 3); // RT 1, SA 1, WC 3
+  auto second = bcToRtMessage(200, 0x1043, 3); // RT 2, SA 2, WC 3
+  stream.insert(stream.end(), first.begin(), first.end());
+  stream.insert(stream.end(), second.begin(), second.end());
+
+  for (size_t split = 1; split < stream.size(); ++split) {
+    Bm1553StreamDecoder decoder;
+    std::vector<MessageTransaction> out;
+    auto collect = [&out](const MessageTransaction &t) { out.push_back(t); };
+    decoder.feed(stream.data(), split, collect);
+    decoder.feed(stream.data() + split, stream.size() - split, collect);
+    ASSERT_TRUE(decoder.flush());
+    out.push_back(decoder.completed());
+
+    ASSERT_EQ(out.size(), 2u) << "split at word " << split;
+    EXPECT_EQ(out[0].header.cmd1, 0x0823);
+    EXPECT_EQ(out[0].dataCount(), 3);
+    EXPECT_TRUE(out[0].stat1Valid());
+    EXPECT_EQ(out[0].header.full_timetag, (1ull << 26) | 100);
+    EXPECT_EQ(out[1].header.cmd1, 0x1043);
+    EXPECT_EQ(out[1].header.full_timetag, (1ull << 26) | 200);
+  }
+}
+
+TEST(StreamDecoderTest, decodersDoNotShareState) {
+  Bm1553StreamDecoder a;
+  Bm1553StreamDecoder b;
+  AiUInt32 high = timetagHigh(5);
+  a.feed(&high, 1, [](const MessageTransaction &) {});
+  auto msg = bcToRtMessage(7, 0x0821, 1);
+  a.feed(msg.data(), msg.size(), [](const MessageTransaction &) {});
+  b.feed(msg.data(), msg.size(), [](const MessageTransaction &) {});
+  ASSERT_TRUE(a.flush());
+  ASSERT_TRUE(b.flush());
+  EXPECT_EQ(a.completed().header.full_timetag, (5ull << 26) | 7);
+  EXPECT_EQ(b.completed().header.full_timetag, 0u);
+}
+
+TEST(StreamDecoderTest, excessDataWordsAreFlaggedNotStored) {
+  Bm1553StreamDecoder decoder;
+  auto msg = bcToRtMessage(1, 0x0820, 40);
+  decoder.feed(msg.data(), msg.size(), [](const MessageTransaction &) {});
+  ASSERT_TRUE(decoder.flush());
+  EXPECT_EQ(decoder.completed().dataCount(), BM_MAX_DATA_WORDS);
+  EXPECT_TRUE(decoder.completed().has(MSG_DATA_OVERFLOW));
+}
+
+TEST(StreamDecoderTest, errorWordBelongsToTheMessageBeforeIt) {
+  std::vector<AiUInt32> stream = {timetagHigh(1), timetagLow(10), busAWord(0x0, 0x0823), 0x10000040, 0x10000080};
+  auto next = bcToRtMessage(20, 0x0821, 1);
+  stream.insert(stream.end(), next.begin(), next.end());
+  Bm1553StreamDecoder decoder;
+  std::vector<MessageTransaction> out;
+  decoder.feed(stream.data(), stream.size(), [&out](const MessageTransaction &t) { out.push_back(t); });
+  ASSERT_TRUE(decoder.flush());
+  out.push_back(decoder.completed());
+
+  // A second error word cannot belong to the same message and stands alone.
+  ASSERT_EQ(out.size(), 3u);
+  EXPECT_EQ(out[0].header.cmd1, 0x0823);
+  EXPECT_TRUE(out[0].errorValid());
+  EXPECT_EQ(out[0].header.error_word, 0x40u);
+  EXPECT_FALSE(out[1].cmd1Valid());
+  EXPECT_EQ(out[1].header.error_word, 0x80u);
+  EXPECT_EQ(out[2].header.cmd1, 0x0821);
+  EXPECT_FALSE(out[2].errorValid());
+}
+
+TEST(StreamDecoderTest, gapRecordCarriesLossAndIsNotAMessage) {
+  MessageTransaction gap = MessageTransaction::makeGap(1234, 70000, GAP_LOCAL_OVERFLOW | GAP_BYTE_COUNT);
+  EXPECT_TRUE(gap.isGap());
+  EXPECT_FALSE(gap.cmd1Valid());
+  EXPECT_EQ(gap.gapLostBytes(), 70000u);
+  EXPECT_EQ(gap.header.gap_reason, GAP_LOCAL_OVERFLOW | GAP_BYTE_COUNT);
+  EXPECT_EQ(gap.header.full_timetag, 1234u);
+}